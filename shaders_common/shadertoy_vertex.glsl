@@ -1,6 +1,8 @@
-layout(location = 0) in vec3 in_position;
-
-void main()
-{
-	gl_Position = vec4(in_position, 1);
+// fullscreen triangle generated from gl_VertexID - no vertex buffer, draw with glDrawArrays(GL_TRIANGLES, 0, 3)
+// vertices are (-1,-1), (3,-1), (-1,3), so the triangle covers the whole viewport without a diagonal seam
+
+void main()
+{
+	vec2 pos = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+	gl_Position = vec4(pos*2.0 - 1.0, 0, 1);
 }
\ No newline at end of file
@@ -1,2321 +1,7223 @@
-// ====================
-// shadertoy_player.cpp
-// ====================
-
-// ======================================================================================================================================
-// TODO --
-// + decouple buffers from pass outputs - allow for say pass 0 to render to an MRT and pass 1 to render to just one layer of the same MRT
-// + allow MRTs with different formats
-// - framebuffer blending (do we really need this? since we can bind the output as an input ..)
-// - cubemap and volume textures
-// + buffers can be texture arrays (different from MRT as you can bind the whole array for sampling)
-// + integer formats (need isampler, usampler etc.)
-// - automatic mipmap generation
-// - subpasses (each pass renders N times, N controllable in pass metadata, and a shader uniform int 'iPass' is available)
-// - mouse passive motion and wheel support
-// + imageLoadStore
-// - allow hookup between bool SLIDER_VAR and keyboard toggles
-// + extended keyboard input texture: store uint16 instead of toggle, ...
-// - would be nice to have a running graph interface - e.g. number of visible lightmap texels over time
-//    need image to store array of float data
-//    every frame, the image writes to itself one row down and one row over
-// + remove indices from inputs and images (still need them for outputs i guess)
-// + allow for passes to be references from COMMON.glsl
-// - improve shader compiling - allow for recompiling, allow for #defines to be referenced from working directory, etc.
-
-#define SUPPORT_IMAGES (1)
-
-// ======================================================================================================================================
-
-#include "common/common.h"
-
-#include "GraphicsTools/util/camera.h"
-#include "GraphicsTools/util/crc.h"
-#include "GraphicsTools/util/fileutil.h"
-#include "GraphicsTools/util/font.h"
-#include "GraphicsTools/util/framebuffer.h"
-#include "GraphicsTools/util/gui.h"
-#include "GraphicsTools/util/imagedxt.h"
-#include "GraphicsTools/util/imageutil.h"
-#include "GraphicsTools/util/keyboard.h"
-#include "GraphicsTools/util/memory.h"
-#include "GraphicsTools/util/mesh.h"
-#include "GraphicsTools/util/progressdisplay.h"
-#include "GraphicsTools/util/stringutil.h"
-
-#include "vmath/vmath_color.h"
-#include "vmath/vmath_float16.h"
-#include "vmath/vmath_matrix.h"
-#include "vmath/vmath_random.h"
-#include "vmath/vmath_sampling.h"
-#include "vmath/vmath_sphere.h"
-#include "vmath/vmath_test.h"
-#include "vmath/vmath_triangle.h"
-#include "vmath/vmath_vec4.h"
-
-#include <thread>
-#include <random>
-
-#include "shaders_common/shadertoy_common.h"
-
-static std::string GetOpenGLTextureTargetStr(GLenum target)
-{
-	switch (target) {
-	case GL_TEXTURE_1D:                   return "GL_TEXTURE_1D";
-	case GL_TEXTURE_1D_ARRAY:             return "GL_TEXTURE_1D_ARRAY";
-	case GL_TEXTURE_2D:                   return "GL_TEXTURE_2D";
-	case GL_TEXTURE_2D_ARRAY:             return "GL_TEXTURE_2D_ARRAY";
-	case GL_TEXTURE_2D_MULTISAMPLE:       return "GL_TEXTURE_2D_MULTISAMPLE";
-	case GL_TEXTURE_2D_MULTISAMPLE_ARRAY: return "GL_TEXTURE_2D_MULTISAMPLE_ARRAY";
-	case GL_TEXTURE_3D:                   return "GL_TEXTURE_3D";
-	case GL_TEXTURE_CUBE_MAP:             return "GL_TEXTURE_CUBE_MAP";
-	case GL_TEXTURE_CUBE_MAP_ARRAY:       return "GL_TEXTURE_CUBE_MAP_ARRAY";
-	case GL_TEXTURE_RECTANGLE:            return "GL_TEXTURE_RECTANGLE";
-	case GL_TEXTURE_BUFFER:               return "GL_TEXTURE_BUFFER";
-	case GL_NONE:                         return "GL_NONE";
-	}
-	return varString("UNKNOWN(%i)", target);
-}
-
-static GLenum GetOpenGLTextureTargetBinding(GLenum target)
-{
-	switch (target) {
-	case GL_TEXTURE_1D:                   return GL_TEXTURE_BINDING_1D;
-	case GL_TEXTURE_1D_ARRAY:             return GL_TEXTURE_BINDING_1D_ARRAY;
-	case GL_TEXTURE_2D:                   return GL_TEXTURE_BINDING_2D;
-	case GL_TEXTURE_2D_ARRAY:             return GL_TEXTURE_BINDING_2D_ARRAY;
-	case GL_TEXTURE_2D_MULTISAMPLE:       return GL_TEXTURE_BINDING_2D_MULTISAMPLE;
-	case GL_TEXTURE_2D_MULTISAMPLE_ARRAY: return GL_TEXTURE_BINDING_2D_MULTISAMPLE_ARRAY;
-	case GL_TEXTURE_3D:                   return GL_TEXTURE_BINDING_3D;
-	case GL_TEXTURE_CUBE_MAP:             return GL_TEXTURE_BINDING_CUBE_MAP;
-	case GL_TEXTURE_CUBE_MAP_ARRAY:       return GL_TEXTURE_BINDING_CUBE_MAP_ARRAY;
-	case GL_TEXTURE_RECTANGLE:            return GL_TEXTURE_BINDING_RECTANGLE;
-	case GL_TEXTURE_BUFFER:               return GL_TEXTURE_BINDING_BUFFER;
-	}
-	return GL_NONE;
-}
-
-static void glBindTextureDEBUG(GLenum target, GLuint textureID)
-{
-#if 0
-	GLuint textureID_prev = 0;
-	glGetIntegerv(GetOpenGLTextureTargetBinding(target), (GLint*)&textureID_prev);
-	printf("*** binding target %s to textureID %u (was bound to texture ID %u)\n", GetOpenGLTextureTargetStr(target).c_str(), textureID, textureID_prev);
-	const GLenum targets[] = {
-		GL_TEXTURE_1D,
-		GL_TEXTURE_1D_ARRAY,
-		GL_TEXTURE_2D,
-		GL_TEXTURE_2D_ARRAY,
-		GL_TEXTURE_2D_MULTISAMPLE,
-		GL_TEXTURE_2D_MULTISAMPLE_ARRAY,
-		GL_TEXTURE_3D,
-		GL_TEXTURE_CUBE_MAP,
-		GL_TEXTURE_CUBE_MAP_ARRAY,
-		GL_TEXTURE_RECTANGLE,
-		GL_TEXTURE_BUFFER,
-	};
-	for (int i = 0; i < icountof(targets); i++) {
-		glGetIntegerv(GetOpenGLTextureTargetBinding(targets[i]), (GLint*)&textureID_prev);
-		printf("***   texture ID %u was bound by target %s\n", textureID_prev, GetOpenGLTextureTargetStr(targets[i]).c_str());
-	}
-#endif
-	glBindTexture(target, textureID);
-}
-
-static uint32 g_ViewportWidth = 960;
-static uint32 g_ViewportHeight = 512;
-static std::string g_ShadersDir = "shaders";
-static bool g_GPUShader5 = false;
-static Keyboard g_Keyboard;
-static int g_MouseDragCurr[2] = {0,0};
-static int g_MouseDragStart[2] = {0,0};
-static bool g_MouseButtonState[3] = {false,false,false}; // left,right,middle
-static int g_MouseWheelState = 0; // instantaneous state
-
-#define SHADER_DEFINE_STRING "#define " // note: line must start literally with "#define ", not "<spaces or tabs> # <spaces or tabs> define" etc.
-#define SHADER_CODE_MAX_LINE_SIZE 4096
-
-#if USE_GUI
-static bool g_GUIEnabled = true;
-static GUIFrame* g_GUIFrame = nullptr;
-static bool g_GUISliderChanged = false;
-
-static void SetGUISliderChanged(GUISliderElement*, GUI::eGUIEvent)
-{
-	g_GUISliderChanged = true;
-}
-
-enum eGUISliderType
-{
-	GUI_SLIDER_TYPE_NONE = 0,
-	GUI_SLIDER_TYPE_FLOAT,
-	GUI_SLIDER_TYPE_INT,
-	GUI_SLIDER_TYPE_UINT,
-	GUI_SLIDER_TYPE_BOOL,
-};
-
-class GUISlider
-{
-private:
-	GUISlider(int passIndex, eGUISliderType type, uint32 components, const char* name, const char* init)
-		: m_passIndex(passIndex)
-		, m_type(type)
-		, m_components(components)
-		, m_name(name)
-		, m_data(nullptr)
-	{
-		switch (type) {
-		case GUI_SLIDER_TYPE_FLOAT: {
-			m_data = new float[components];
-			if (init) {
-				const float dataInit = (float)atof(init);
-				for (uint32 i = 0; i < components; i++)
-					((float*)m_data)[i] = dataInit;
-			} else
-				memset(m_data, 0, components*sizeof(float));
-			break;
-		} case GUI_SLIDER_TYPE_INT:
-			m_data = new int[components];
-			if (init) {
-				const int dataInit = atoi(init);
-				for (uint32 i = 0; i < components; i++)
-					((int*)m_data)[i] = dataInit;
-			} else
-				memset(m_data, 0, components*sizeof(int));
-			break;
-		case GUI_SLIDER_TYPE_UINT:
-			m_data = new uint32[components];
-			if (init) {
-				const uint32 dataInit = (uint32)atoi(init);
-				for (uint32 i = 0; i < components; i++)
-					((uint32*)m_data)[i] = dataInit;
-			} else
-				memset(m_data, 0, components*sizeof(int));
-			break;
-		case GUI_SLIDER_TYPE_BOOL:
-			m_data = new bool[components];
-			if (init) {
-				const bool dataInit = stricmp(init, "true") == 0;
-				for (uint32 i = 0; i < components; i++)
-					((bool*)m_data)[i] = dataInit;
-			} else
-				memset(m_data, 0, components*sizeof(bool));
-			break;
-		};
-	}
-
-public:
-	static void SetCurrentPassIndexForShaderLoad(int passIndex)
-	{
-		GetCurrentPassIndexForShaderLoad() = passIndex;
-	}
-
-	static bool AddSlider(const char* shaderPath, uint32 shaderLineIndex, const char* line)
-	{
-		// e.g. "SLIDER_VAR(vec3,myvec,1,-2,2);"
-		while (*line == ' ' || *line == '\t')
-			line++;
-		if (if_strskip(line, "SLIDER_VAR(")) {
-			char temp[SHADER_CODE_MAX_LINE_SIZE];
-			strcpy(temp, line);
-			char* end = strchr(temp, ')');
-			if (end) {
-				*end = '\0';
-				NameValuePairs params(temp);
-				if (params.size() >= 3) { // (type,name,init) are mandatory
-					const char* typeStr = params[0].m_value.c_str();
-					const char* nameStr = params[1].m_value.c_str();
-					const char* initStr = params[2].m_value.c_str();
-					eGUISliderType type = GUI_SLIDER_TYPE_NONE;
-					uint32 components = 0;
-					if      (strcmp(typeStr, "float") == 0) { type = GUI_SLIDER_TYPE_FLOAT; components = 1; }
-					else if (strcmp(typeStr, "vec2" ) == 0) { type = GUI_SLIDER_TYPE_FLOAT; components = 2; }
-					else if (strcmp(typeStr, "vec3" ) == 0) { type = GUI_SLIDER_TYPE_FLOAT; components = 3; }
-					else if (strcmp(typeStr, "vec4" ) == 0) { type = GUI_SLIDER_TYPE_FLOAT; components = 4; }
-					if      (strcmp(typeStr, "int"  ) == 0) { type = GUI_SLIDER_TYPE_INT;   components = 1; }
-					else if (strcmp(typeStr, "ivec2") == 0) { type = GUI_SLIDER_TYPE_INT;   components = 2; }
-					else if (strcmp(typeStr, "ivec3") == 0) { type = GUI_SLIDER_TYPE_INT;   components = 3; }
-					else if (strcmp(typeStr, "ivec4") == 0) { type = GUI_SLIDER_TYPE_INT;   components = 4; }
-					if      (strcmp(typeStr, "uint" ) == 0) { type = GUI_SLIDER_TYPE_UINT;  components = 1; }
-					else if (strcmp(typeStr, "uvec2") == 0) { type = GUI_SLIDER_TYPE_UINT;  components = 2; }
-					else if (strcmp(typeStr, "uvec3") == 0) { type = GUI_SLIDER_TYPE_UINT;  components = 3; }
-					else if (strcmp(typeStr, "uvec4") == 0) { type = GUI_SLIDER_TYPE_UINT;  components = 4; }
-					if      (strcmp(typeStr, "bool" ) == 0) { type = GUI_SLIDER_TYPE_BOOL;  components = 1; }
-					else if (strcmp(typeStr, "bvec2") == 0) { type = GUI_SLIDER_TYPE_BOOL;  components = 2; }
-					else if (strcmp(typeStr, "bvec3") == 0) { type = GUI_SLIDER_TYPE_BOOL;  components = 3; }
-					else if (strcmp(typeStr, "bvec4") == 0) { type = GUI_SLIDER_TYPE_BOOL;  components = 4; }
-					if (type != GUI_SLIDER_TYPE_NONE || (type != GUI_SLIDER_TYPE_BOOL && params.size() < 5)) {
-						const char* minStr = params.size() > 3 ? params[3].m_value.c_str() : nullptr;
-						const char* maxStr = params.size() > 4 ? params[4].m_value.c_str() : nullptr;
-						const int passIndex = GetCurrentPassIndexForShaderLoad();
-						GUISlider* slider = new GUISlider(passIndex, type, components, nameStr, initStr);
-						if (g_GUIFrame == nullptr) {
-							GUIWindow* window = new GUIWindow();
-							g_GUIFrame = &window->m_frame;
-							GUI::RegisterWindow(window);
-						}
-						for (uint32 i = 0; i < components; i++) {
-							char componentName[256] = "";
-							if (passIndex != -1)
-								sprintf(componentName, "pass %i - ", passIndex);
-							strcat(componentName, slider->m_name.c_str());
-							if (components > 1)
-								strcatf(componentName, ".%c", 'x' + i);
-							for (char* s = componentName; *s; s++)
-								if (*s == '_')
-									*s = ' ';
-							switch (type) {
-							case GUI_SLIDER_TYPE_FLOAT:
-								g_GUIFrame->AddElement(new GUISliderElement(componentName, ((float*)slider->m_data)[i], (float)atof(minStr), (float)atof(maxStr), SetGUISliderChanged));
-								break;
-							case GUI_SLIDER_TYPE_INT:
-								g_GUIFrame->AddElement(new GUIIntSliderElement(componentName, ((int*)slider->m_data)[i], atoi(minStr), atoi(maxStr), SetGUISliderChanged));
-								break;
-							case GUI_SLIDER_TYPE_UINT:
-								g_GUIFrame->AddElement(new GUIIntSliderElement(componentName, ((int*)slider->m_data)[i], atoi(minStr), atoi(maxStr), SetGUISliderChanged)); // TODO -- uint sliders
-								break;
-							case GUI_SLIDER_TYPE_BOOL:
-								g_GUIFrame->AddElement(new GUIBoolSliderElement(componentName, ((bool*)slider->m_data)[i], SetGUISliderChanged));
-								break;
-							}
-						}
-						GetSliders().push_back(slider);
-						g_GUIFrame->AlignSliders();
-						return true;
-					} else
-						fprintf(stderr, "shader error in %s (line %u): unknown type for SLIDER_VAR\n", shaderPath, shaderLineIndex);
-				} else
-					fprintf(stderr, "shader error in %s (line %u): incorrect number of params for SLIDER_VAR\n", shaderPath, shaderLineIndex);
-			} else
-				fprintf(stderr, "shader error in %s (line %u): no close parenthesis found for SLIDER_VAR\n", shaderPath, shaderLineIndex);
-		}
-		return false;
-	}
-
-	static void SetUniformsForPass(uint32 passIndex, GLuint programID)
-	{
-		const std::vector<GUISlider*>& sliders = GetSliders();
-		for (uint32 i = 0; i < sliders.size(); i++) {
-			const GUISlider* slider = sliders[i];
-			if (slider->m_passIndex == -1 || slider->m_passIndex == (int)passIndex) {
-				switch (slider->m_type) {
-				case GUI_SLIDER_TYPE_FLOAT: {
-					const float* data = (const float*)slider->m_data;
-					switch (slider->m_components) {
-					case 1: glUniform1f(glGetUniformLocation(programID, slider->m_name.c_str()), data[0]); break;
-					case 2: glUniform2f(glGetUniformLocation(programID, slider->m_name.c_str()), data[0], data[1]); break;
-					case 3: glUniform3f(glGetUniformLocation(programID, slider->m_name.c_str()), data[0], data[1], data[2]); break;
-					case 4: glUniform4f(glGetUniformLocation(programID, slider->m_name.c_str()), data[0], data[1], data[2], data[3]); break;
-					}
-					break;
-				}
-				case GUI_SLIDER_TYPE_INT: {
-					const int* data = (const int*)slider->m_data;
-					switch (slider->m_components) {
-					case 1: glUniform1i(glGetUniformLocation(programID, slider->m_name.c_str()), data[0]); break;
-					case 2: glUniform2i(glGetUniformLocation(programID, slider->m_name.c_str()), data[0], data[1]); break;
-					case 3: glUniform3i(glGetUniformLocation(programID, slider->m_name.c_str()), data[0], data[1], data[2]); break;
-					case 4: glUniform4i(glGetUniformLocation(programID, slider->m_name.c_str()), data[0], data[1], data[2], data[3]); break;
-					}
-					break;
-				}
-				case GUI_SLIDER_TYPE_UINT: {
-					const uint32* data = (const uint32*)slider->m_data;
-					switch (slider->m_components) {
-					case 1: glUniform1ui(glGetUniformLocation(programID, slider->m_name.c_str()), data[0]); break;
-					case 2: glUniform2ui(glGetUniformLocation(programID, slider->m_name.c_str()), data[0], data[1]); break;
-					case 3: glUniform3ui(glGetUniformLocation(programID, slider->m_name.c_str()), data[0], data[1], data[2]); break;
-					case 4: glUniform4ui(glGetUniformLocation(programID, slider->m_name.c_str()), data[0], data[1], data[2], data[3]); break;
-					}
-					break;
-				}
-				case GUI_SLIDER_TYPE_BOOL: {
-					const bool* data = (const bool*)slider->m_data;
-					switch (slider->m_components) {
-					case 1: glUniform1ui(glGetUniformLocation(programID, slider->m_name.c_str()), data[0]?1:0); break;
-					case 2: glUniform2ui(glGetUniformLocation(programID, slider->m_name.c_str()), data[0]?1:0, data[1]?1:0); break;
-					case 3: glUniform3ui(glGetUniformLocation(programID, slider->m_name.c_str()), data[0]?1:0, data[1]?1:0, data[2]?1:0); break;
-					case 4: glUniform4ui(glGetUniformLocation(programID, slider->m_name.c_str()), data[0]?1:0, data[1]?1:0, data[2]?1:0, data[3]?1:0); break;
-					}
-					break;
-				}
-				}
-			}
-		}
-		glUniform1ui(glGetUniformLocation(programID, "g_GUISliderChanged"), g_GUISliderChanged?1:0);
-	}
-
-private:
-	static std::vector<GUISlider*>& GetSliders()
-	{
-		static std::vector<GUISlider*> sliders;
-		return sliders;
-	}
-
-	static int& GetCurrentPassIndexForShaderLoad()
-	{
-		static int passIndex = -1;
-		return passIndex;
-	}
-
-	int m_passIndex; // -1=common
-	eGUISliderType m_type;
-	uint32 m_components; // [1..4]
-	std::string m_name;
-	void* m_data;
-};
-#endif // USE_GUI
-
-static uint32 g_NumShaderCompilerLinkErrors = 0;
-static const char* g_CurrentShaderBeingCompiled = nullptr;
-static std::map<GLenum,std::map<GLuint,std::string> > g_ShaderToProcessedPath; // target -> programID -> path
-
-static void LoadShaderCodeInternal(
-	std::string& code,
-	const char* path,
-	std::map<std::string,bool>& included,
-	const std::map<std::string,std::string>* defineOverrides)
-{
-	FILE* file = fopen(path, "r");
-	if (file) {
-		char line[SHADER_CODE_MAX_LINE_SIZE];
-		char temp[SHADER_CODE_MAX_LINE_SIZE];
-		uint32 lineIndex = 0;
-		while (fgets(line, sizeof(line), file)) {
-			lineIndex++;
-			char* end = strpbrk(line, "\r\n");
-			if (end)
-				*end = '\0';
-		#if USE_GUI
-			if (g_GUIEnabled)
-				GUISlider::AddSlider(path, lineIndex, line);
-		#endif // USE_GUI
-			char* s = line;
-			while (*s == ' ' || *s == '\t')
-				s++;
-			if (strstr(s, "#include") == s) {
-				strcpy(temp, s);
-				char* includePathBegin = strchr(temp, '\"');
-				if (includePathBegin) {
-					*includePathBegin++ = '\0';
-					char* includePathEnd = strchr(includePathBegin, '\"');
-					if (includePathEnd) {
-						*includePathEnd = '\0';
-						char includePath[512];
-						strcpy(includePath, path);
-						s = strrchr(includePath, '\\');
-						if (s)
-							s[1] = '\0';
-						strcat(includePath, includePathBegin);
-						if (included.find(includePath) == included.end()) {
-							included[includePath] = true;
-							code += varString("//<=== BEGIN %s ===>\n", line);
-							LoadShaderCodeInternal(code, includePath, included, defineOverrides);
-							code += varString("//<=== END %s ===>\n", line);
-						}
-						continue;
-					}
-				}
-			}
-			if (defineOverrides && strstr(s, SHADER_DEFINE_STRING) == s) {
-				strcpy(temp, s + strlen(SHADER_DEFINE_STRING));
-				const char* d = strtok(temp, " \t");
-				const auto it = defineOverrides->find(d);
-				if (it != defineOverrides->end() && !it->second.empty()) {
-					code += varString("%s%s %s\n", SHADER_DEFINE_STRING, d, it->second.c_str());
-					continue;
-				}
-			}
-			code += varString("%s\n", line);
-		}
-		fclose(file);
-	}
-}
-
-static bool LoadShader(
-	GLuint& shaderID,
-	const char* path,
-	const char* processedPathExt,
-	GLenum target,
-	const char* versionStr,
-	const std::map<std::string,std::string>* defineOverrides = nullptr,
-	const std::vector<std::string>* sourceHeader = nullptr,
-	const std::vector<std::string>* sourceFooter = nullptr)
-{
-	std::map<std::string,bool> included;
-	std::string code;
-	if (versionStr)
-		code += varString("%s\n", versionStr);
-	if (g_GPUShader5 && target == GL_FRAGMENT_SHADER) {
-		code += "#extension GL_NV_gpu_shader5 : enable\n";
-		code += "#extension GL_NV_bindless_texture : enable\n"; // just so i can pass samplers around as uint64_t's ..
-		code += "#extension GL_ARB_derivative_control : enable\n";
-		code += "#define _GPU_SHADER_5_\n";
-	}
-	code += std::string("#define _SHADERTOY_PLAYER_VERSION_ 1\n");
-	if (defineOverrides) {
-		code += std::string("//<=== BEGIN DEFINES ===>\n");
-		for (auto iter = defineOverrides->begin(); iter != defineOverrides->end(); ++iter)
-			if (iter->second.empty())
-				code += varString("%s%s\n", SHADER_DEFINE_STRING, iter->first.c_str());
-		code += std::string("//<=== END DEFINES ===>\n");
-	}
-	if (sourceHeader) {
-		for (uint32 i = 0; i < sourceHeader->size(); i++) {
-			code += sourceHeader->operator[](i);
-			code += "\n";
-		}
-	}
-	LoadShaderCodeInternal(code, path, included, defineOverrides);
-	if (sourceFooter) {
-		for (uint32 i = 0; i < sourceFooter->size(); i++) {
-			code += sourceFooter->operator[](i);
-			code += "\n";
-		}
-	}
-	if (shaderID == 0)
-		shaderID = glCreateShader(target);
-	char processedPath[512] = "";
-	if (processedPathExt)
-		ForceAssert(processedPathExt[0] == '_'); // should start with underscore
-	const char* ext = ".glsl";
-	switch (target) { // glslangValidator compatibility
-	case GL_VERTEX_SHADER         : ext = ".vert"; break;
-	case GL_TESS_CONTROL_SHADER   : ext = ".tesc"; break;
-	case GL_TESS_EVALUATION_SHADER: ext = ".tese"; break;
-	case GL_GEOMETRY_SHADER       : ext = ".geom"; break;
-	case GL_FRAGMENT_SHADER       : ext = ".frag"; break;
-	case GL_COMPUTE_SHADER        : ext = ".comp"; break;
-	}
-	PathInsertDirectory(processedPath, "_processed", PathExt(path, "_processed%s%s", processedPathExt ? processedPathExt : "", ext));
-	FILE* file = fopen(processedPath, "w");
-	if (file) {
-		fprintf(file, "%s", code.c_str());
-		fclose(file);
-	}
-	ForceAssert(g_ShaderToProcessedPath[target].find(shaderID) == g_ShaderToProcessedPath[target].end()); // make sure we don't collide
-	g_ShaderToProcessedPath[target][shaderID] = processedPath;
-	const char* codeStr = code.c_str();
-	g_CurrentShaderBeingCompiled = processedPath;
-	glShaderSource(shaderID, 1, (const GLcharARB**)&codeStr, nullptr);
-	glCompileShader(shaderID);
-	g_CurrentShaderBeingCompiled = nullptr;
-	GLint compileStatus = 0;
-	glGetShaderiv(shaderID, GL_COMPILE_STATUS, &compileStatus);
-	if (compileStatus == GL_TRUE)
-		return true;
-	else {
-		GLint maxLength = 0;
-		glGetShaderiv(shaderID, GL_INFO_LOG_LENGTH, &maxLength);
-		std::vector<GLchar> infoLog(maxLength);
-		glGetShaderInfoLog(shaderID, maxLength, &maxLength, infoLog.data());
-		fprintf(stderr, "compile (%s): %s\n", processedPath, infoLog.data());
-		if (1) { // insert compile error into processed shader text and open it ..
-			const char* s = strchr(infoLog.data(), '(');
-			if (s) {
-				const uint32 errorLineIndex = atoi(s + 1);
-				FILE* f1 = fopen(processedPath, "r");
-				if (f1) {
-					char processedPath2[512];
-					strcpy(processedPath2, PathExt(processedPath, "_error.txt"));
-					FILE* f2 = fopen(processedPath2, "w");
-					if (f2) {
-						uint32 lineIndex = 0;
-						char line[SHADER_CODE_MAX_LINE_SIZE];
-						bool lineFound = false;
-						while (fgets(line, sizeof(line), f1)) {
-							fprintf(f2, "%s", line);
-							if (++lineIndex == errorLineIndex) {
-								fprintf(f2, "%s\n", infoLog.data());
-								lineFound = true;
-								break; // TODO -- insert multiple errors?
-							}
-						}
-						if (!lineFound) {
-							fprintf(f2, "\n\nCOULD NOT FIND LINE %d TO INSERT ERROR!\n", errorLineIndex);
-							fprintf(f2, "%s\n", infoLog.data());
-						}
-						fclose(f2);
-						system(processedPath2); // open it
-					}
-					fclose(f1);
-				}
-			}
-		}
-		if (++g_NumShaderCompilerLinkErrors < 5)
-			system("pause");
-		return false;
-	}
-}
-
-static void AddCommentsToShaderASM(char*& text, bool flowControl = true)
-{
-	std::vector<std::string> lines;
-	char* buf = new char[strlen(text) + 1];
-	char* buf1 = buf;
-	strcpy(buf, text);
-	uint32 maxLen = 0;
-	while (true) {
-		char* line = strtok(buf1, "\r\n");
-		if (line) {
-			lines.push_back(line);
-			maxLen = Max((uint32)strlen(line), maxLen);
-			buf1 = nullptr;
-		} else
-			break;
-	}
-	maxLen += (uint32)varString("[line_%05u] ", 0).size();
-	delete[] text; // text has now been copied into lines	
-	class FlowControlStackElement
-	{
-	public:
-		FlowControlStackElement(int lineIf, bool isRep) : m_lineNum_IF(lineIf), m_lineNum_ELSE(-1), m_isRep(isRep) {}
-		int m_lineNum_IF;
-		int m_lineNum_ELSE;
-		bool m_isRep;
-	};
-	std::vector<FlowControlStackElement> flow;
-	for (uint32 i = 0; i < lines.size(); i++) {
-		const int lineNum = i + 1;
-		const char* line = lines[i].c_str();
-		std::string line2 = varString("[line_%05u] %s", lineNum, line);
-		while (line2.size() < maxLen)
-			line2 += " ";
-		line2 += " #";
-		if (flowControl) { // add relevant line numbers for program flow instructions (IF,ELSE,ENDIF,REP,ENDREP,BRK)
-			if (strstartswith(line, "IF ")) {
-				flow.push_back(FlowControlStackElement(lineNum, false));
-			} else if (strstartswith(line, "ELSE;")) {
-				ForceAssert(!flow.empty());
-				ForceAssert(!flow.back().m_isRep);
-				ForceAssert(flow.back().m_lineNum_ELSE == -1);
-				flow.back().m_lineNum_ELSE = lineNum;
-			} else if (strstartswith(line, "ENDIF;")) {
-				ForceAssert(!flow.empty());
-				ForceAssert(!flow.back().m_isRep);
-				line2 += varString(" IF:[line_%05u]", (uint32)flow.back().m_lineNum_IF);
-				lines[flow.back().m_lineNum_IF - 1] += varString(" IF:[line_%05u]", (uint32)flow.back().m_lineNum_IF); // self
-				if (flow.back().m_lineNum_ELSE != -1) {
-					line2 += varString(" ELSE:[line_%05u]", (uint32)flow.back().m_lineNum_ELSE);
-					lines[flow.back().m_lineNum_IF - 1] += varString(" ELSE:[line_%05u]", (uint32)flow.back().m_lineNum_ELSE);
-					lines[flow.back().m_lineNum_ELSE - 1] += varString(" IF:[line_%05u]", (uint32)flow.back().m_lineNum_IF);
-					lines[flow.back().m_lineNum_ELSE - 1] += varString(" ELSE:[line_%05u]", (uint32)flow.back().m_lineNum_ELSE); // self
-					lines[flow.back().m_lineNum_ELSE - 1] += varString(" ENDIF:[line_%05u]", lineNum);
-				}
-				lines[flow.back().m_lineNum_IF - 1] += varString(" ENDIF:[line_%05u]", lineNum);
-				line2 += varString(" ENDIF:[line_%05u]", lineNum); // self
-				flow.pop_back();
-			} else if (strstartswith(line, "REP.S ")) {
-				flow.push_back(FlowControlStackElement(lineNum, true));
-			} else if (strstartswith(line, "ENDREP;")) {
-				ForceAssert(!flow.empty());
-				ForceAssert(flow.back().m_isRep);
-				ForceAssert(flow.back().m_lineNum_ELSE == -1);
-				line2 += varString(" REP:[line_%05u]", (uint32)flow.back().m_lineNum_IF);
-				lines[flow.back().m_lineNum_IF - 1] += varString(" REP:[line_%05u]", (uint32)flow.back().m_lineNum_IF); // self
-				lines[flow.back().m_lineNum_IF - 1] += varString(" ENDREP:[line_%05u]", lineNum);
-				line2 += varString(" ENDREP:[line_%05u]", lineNum); // self
-				flow.pop_back();
-			} else if (strstartswith(line, "BRK ")) {
-				ForceAssert(!flow.empty());
-				int repIndex = -1;
-				for (int j = (int)flow.size() - 1; j >= 0; j--) {
-					if (flow[j].m_isRep) {
-						repIndex = j;
-						break;
-					}
-				}
-				ForceAssert(repIndex != -1);
-				line2 += varString(" REP:[line_%05u]", (uint32)flow[repIndex].m_lineNum_IF); // TODO -- show ENDREP line number, also BRK line numbers on REP/ENDREP lines
-			}
-		}
-		lines[i] = line2;
-	}
-	std::string text2 = "";
-	for (uint32 i = 0; i < lines.size(); i++)
-		text2 += varString("%s\n", lines[i].c_str());
-	text = new char[text2.size() + 1];
-	strcpy(text, text2.c_str());
-	delete[] buf;
-}
-
-static const char* GetShaderProcessedPath(GLuint programID)
-{
-	if (programID != 0) {
-		const auto f = g_ShaderToProcessedPath[GL_SHADER].find(programID);
-		if (f != g_ShaderToProcessedPath[GL_SHADER].end())
-			return f->second.c_str();
-		else
-			return "UNKNOWN";
-	} else
-		return "NONE";
-}
-
-static bool CreateShaderProgram(GLuint& programID, GLuint vertexShaderID, GLuint fragmentShaderID, bool dumpASM = true)
-{
-	if (programID == 0)
-		programID = glCreateProgram();
-	ForceAssert(vertexShaderID != 0);
-	ForceAssert(fragmentShaderID != 0);
-	glAttachShader(programID, vertexShaderID);
-	glAttachShader(programID, fragmentShaderID);
-	if (dumpASM)
-		glProgramParameteri(programID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
-	glLinkProgram(programID);
-	const char* vsPath = "?";
-	const char* fsPath = "?";
-	const auto vs = g_ShaderToProcessedPath[GL_VERTEX_SHADER].find(vertexShaderID);
-	if (vs != g_ShaderToProcessedPath[GL_VERTEX_SHADER].end()) {
-		vsPath = vs->second.c_str();
-		const char* slash = strrchr(vsPath, '\\');
-		if (slash)
-			vsPath = slash + 1;
-	}
-	const auto fs = g_ShaderToProcessedPath[GL_FRAGMENT_SHADER].find(fragmentShaderID);
-	if (fs != g_ShaderToProcessedPath[GL_FRAGMENT_SHADER].end()) {
-		fsPath = fs->second.c_str();
-		const char* slash = strrchr(fsPath, '\\');
-		if (slash)
-			fsPath = slash + 1;
-	}
-	GLint linkStatus = 0;
-	glGetProgramiv(programID, GL_LINK_STATUS, &linkStatus);
-	if (linkStatus == GL_TRUE) {
-		g_ShaderToProcessedPath[GL_SHADER][programID] = varString("(vs=%s, fs=%s)", vsPath, fsPath);
-		//fprintf(stderr, "link successful - (vs=%s, fs=%s)\n", vsPath, fsPath);
-		if (dumpASM) {
-			// http://www.renderguild.com/gpuguide.pdf
-			GLint len = 0;
-			glGetProgramiv(programID, GL_PROGRAM_BINARY_LENGTH, &len);
-			if (len > 0) {
-				char* bin = new char[len];
-				GLenum format = GL_NONE;
-				glGetProgramBinary(programID, len, nullptr, &format, bin);
-				FILE* f = fopen(PathExt(fs->second.c_str(), "_asm.txt"), "w");
-				if (f) {
-					const char* shaderTextStart = "!!NV"; // e.g. "!!NVfp5.0"
-					const char* shaderTextEnd = "END\n";
-					char* s1 = bin;
-					uint32 numShaders = 0;
-					while (s1 < bin + len) {
-						if (strncmp(s1, shaderTextStart, strlen(shaderTextStart)) == 0) {
-							char* s2 = s1 + strlen(shaderTextStart);
-							while (s2 < bin + len) {
-								if (strncmp(s2, shaderTextEnd, strlen(shaderTextEnd)) == 0) {
-									s2 += strlen(shaderTextEnd);
-									const size_t shaderTextLength = (ptrdiff_t)(s2 - s1);
-									char* temp = new char[shaderTextLength + 1];
-									memcpy(temp, s1, shaderTextLength);
-									temp[shaderTextLength] = '\0';
-									AddCommentsToShaderASM(temp);
-									fprintf(f, "%s\n", temp);
-									numShaders++;
-									s1 = s2;
-									delete[] temp;
-									break;
-								} else
-									s2++;
-							}
-							if (s1 != s2) {
-								fprintf(f, "no end found!\n");
-								break;
-							}
-						} else
-							s1++;
-					}
-					bool dumpBinary = true;//false;
-					if (numShaders == 0) {
-						fprintf(f, "no shaders found!\n");
-						fprintf(f, "dumping binary data ..\n\n");
-						dumpBinary = true;
-					}
-					if (dumpBinary) {
-						FILE* f2 = fopen(PathExt(fs->second.c_str(), "_asm.bin"), "wb");
-						if (f2) {
-							fwrite(bin, sizeof(char), len, f2);
-							fclose(f2);
-						}
-					}
-					fclose(f);
-				}
-				delete[] bin;
-			}
-		}
-		return true;
-	} else {
-		GLint maxLength = 0;
-		glGetProgramiv(programID, GL_INFO_LOG_LENGTH, &maxLength);
-		std::vector<GLchar> infoLog(maxLength);
-		glGetProgramInfoLog(programID, maxLength, &maxLength, &infoLog[0]);
-		fprintf(stderr, "link error (vs=%s, fs=%s): %s\n", vsPath, fsPath, infoLog.data());
-		if (++g_NumShaderCompilerLinkErrors < 5)
-			system("pause");
-		return false;
-	}
-}
-
-#define VERTEX_SHADER_VERSION_STR "#version 440"
-#define FRAGMENT_SHADER_VERSION_STR "#version 440"
-
-static GLuint LoadShaderProgram(const char* fragmentShaderPath, GLuint commonVertexShaderID,
-	const std::vector<std::string>* fragmentShaderSourceHeader = nullptr,
-	const std::vector<std::string>* fragmentShaderSourceFooter = nullptr)
-{
-	GLuint programID = 0;
-	if (FileExists(fragmentShaderPath)) {
-		GLuint vertexShaderID = 0;
-		char vertexShaderPath[512];
-		strcpy(vertexShaderPath, PathExt(fragmentShaderPath, "_vs.glsl"));
-		if (FileExists(vertexShaderPath))
-			LoadShader(vertexShaderID, vertexShaderPath, nullptr, GL_VERTEX_SHADER, VERTEX_SHADER_VERSION_STR);
-		else
-			vertexShaderID = commonVertexShaderID;
-		if (vertexShaderID != 0) {
-			GLuint fragmentShaderID = 0;
-			if (LoadShader(fragmentShaderID, fragmentShaderPath, nullptr, GL_FRAGMENT_SHADER, FRAGMENT_SHADER_VERSION_STR, nullptr, fragmentShaderSourceHeader, fragmentShaderSourceFooter))
-				CreateShaderProgram(programID, vertexShaderID, fragmentShaderID);
-		}
-	}
-	return programID;
-}
-
-class TextureFormatInfo
-{
-public:
-	enum eSamplerType
-	{
-		SAMPLER_TYPE_FLOAT,        // e.g. 'sampler2D'
-		SAMPLER_TYPE_UNSIGNED_INT, // e.g. 'usampler2D'
-		SAMPLER_TYPE_SIGNED_INT,   // e.g. 'isampler2D'
-	};
-
-	TextureFormatInfo(DDS_DXGI_FORMAT format)
-		: m_formatQualifier("unknown")
-		, m_formatType("unknown")
-		, m_internalFormat(GL_NONE)
-		, m_format(GL_NONE)
-		, m_type(GL_NONE)
-		, m_samplerType(SAMPLER_TYPE_FLOAT)
-		, m_components(0)
-		, m_compressed(false)
-	{
-		switch (format) {
-		case DDS_DXGI_FORMAT_R8_UNORM:            m_formatQualifier = "r8";             m_internalFormat = GL_R8;             m_format = GL_RED;          m_type = GL_UNSIGNED_BYTE;                m_components = 1; break;
-		case DDS_DXGI_FORMAT_R8_SNORM:            m_formatQualifier = "r8_snorm";       m_internalFormat = GL_R8_SNORM;       m_format = GL_RED;          m_type = GL_BYTE;                         m_components = 1; break;
-		case DDS_DXGI_FORMAT_R16_UNORM:           m_formatQualifier = "r16";            m_internalFormat = GL_R16;            m_format = GL_RED;          m_type = GL_UNSIGNED_SHORT;               m_components = 1; break;
-		case DDS_DXGI_FORMAT_R16_SNORM:           m_formatQualifier = "r16_snorm";      m_internalFormat = GL_R16_SNORM;      m_format = GL_RED;          m_type = GL_SHORT;                        m_components = 1; break;
-		case DDS_DXGI_FORMAT_R16_FLOAT:           m_formatQualifier = "r16f";           m_internalFormat = GL_R16F;           m_format = GL_RED;          m_type = GL_HALF_FLOAT;                   m_components = 1; break;
-		case DDS_DXGI_FORMAT_R32_FLOAT:           m_formatQualifier = "r32f";           m_internalFormat = GL_R32F;           m_format = GL_RED;          m_type = GL_FLOAT;                        m_components = 1; break;
-		case DDS_DXGI_FORMAT_R8G8_UNORM:          m_formatQualifier = "rg8";            m_internalFormat = GL_RG8;            m_format = GL_RG;           m_type = GL_UNSIGNED_BYTE;                m_components = 2; break;
-		case DDS_DXGI_FORMAT_R8G8_SNORM:          m_formatQualifier = "rg8_snorm";      m_internalFormat = GL_RG8_SNORM;      m_format = GL_RG;           m_type = GL_BYTE;                         m_components = 2; break;
-		case DDS_DXGI_FORMAT_R16G16_UNORM:        m_formatQualifier = "rg16";           m_internalFormat = GL_RG16;           m_format = GL_RG;           m_type = GL_UNSIGNED_SHORT;               m_components = 2; break;
-		case DDS_DXGI_FORMAT_R16G16_SNORM:        m_formatQualifier = "rg16_snorm";     m_internalFormat = GL_RG16_SNORM;     m_format = GL_RG;           m_type = GL_SHORT;                        m_components = 2; break;
-		case DDS_DXGI_FORMAT_R16G16_FLOAT:        m_formatQualifier = "rg16f";          m_internalFormat = GL_RG16F;          m_format = GL_RG;           m_type = GL_HALF_FLOAT;                   m_components = 2; break;
-		case DDS_DXGI_FORMAT_R32G32_FLOAT:        m_formatQualifier = "rg32f";          m_internalFormat = GL_RG32F;          m_format = GL_RG;           m_type = GL_FLOAT;                        m_components = 2; break;
-		case DDS_DXGI_FORMAT_R8G8B8A8_UNORM:      m_formatQualifier = "rgba8";          m_internalFormat = GL_RGBA8;          m_format = GL_RGBA;         m_type = GL_UNSIGNED_BYTE;                m_components = 4; break;
-		case DDS_DXGI_FORMAT_R8G8B8A8_UNORM_SRGB: m_formatQualifier = "rgba8";          m_internalFormat = GL_SRGB8_ALPHA8;   m_format = GL_RGBA;         m_type = GL_UNSIGNED_BYTE;                m_components = 4; break;
-		case DDS_DXGI_FORMAT_R8G8B8A8_SNORM:      m_formatQualifier = "rgba8_snorm";    m_internalFormat = GL_RGBA8_SNORM;    m_format = GL_RGBA;         m_type = GL_BYTE;                         m_components = 4; break;
-		case DDS_DXGI_FORMAT_B8G8R8A8_UNORM:      m_formatQualifier = "rgba8";          m_internalFormat = GL_RGBA8;          m_format = GL_BGRA;         m_type = GL_UNSIGNED_BYTE;                m_components = 4; break; // compatible with Pixel32
-		case DDS_DXGI_FORMAT_B8G8R8A8_UNORM_SRGB: m_formatQualifier = "rgba8";          m_internalFormat = GL_SRGB8_ALPHA8;   m_format = GL_BGRA;         m_type = GL_UNSIGNED_BYTE;                m_components = 4; break;
-		case DDS_DXGI_FORMAT_R16G16B16A16_UNORM:  m_formatQualifier = "rgba16";         m_internalFormat = GL_RGBA16;         m_format = GL_RGBA;         m_type = GL_UNSIGNED_SHORT;               m_components = 4; break;
-		case DDS_DXGI_FORMAT_R16G16B16A16_SNORM:  m_formatQualifier = "rgba16_snorm";   m_internalFormat = GL_RGBA16_SNORM;   m_format = GL_RGBA;         m_type = GL_SHORT;                        m_components = 4; break;
-		case DDS_DXGI_FORMAT_R16G16B16A16_FLOAT:  m_formatQualifier = "rgba16f";        m_internalFormat = GL_RGBA16F;        m_format = GL_RGBA;         m_type = GL_HALF_FLOAT;                   m_components = 4; break;
-		case DDS_DXGI_FORMAT_R32G32B32A32_FLOAT:  m_formatQualifier = "rgba32f";        m_internalFormat = GL_RGBA32F;        m_format = GL_RGBA;         m_type = GL_FLOAT;                        m_components = 4; break;
-		case DDS_DXGI_FORMAT_R32G32B32_FLOAT:     m_formatQualifier = "rgb32f";         m_internalFormat = GL_RGB32F;         m_format = GL_RGB;          m_type = GL_FLOAT;                        m_components = 3; break;
-		case DDS_DXGI_FORMAT_R10G10B10A2_UNORM:   m_formatQualifier = "rgb10_a2";       m_internalFormat = GL_RGB10_A2;       m_format = GL_RGBA;         m_type = GL_UNSIGNED_INT_2_10_10_10_REV;  m_components = 4; break;
-		case DDS_DXGI_FORMAT_R11G11B10_FLOAT:     m_formatQualifier = "r11f_g11f_b10f"; m_internalFormat = GL_R11F_G11F_B10F; m_format = GL_RGB;          m_type = GL_UNSIGNED_INT_10F_11F_11F_REV; m_components = 3; break;
-		case DDS_DXGI_FORMAT_R9G9B9E5_SHAREDEXP:  m_formatQualifier = "unknown";        m_internalFormat = GL_RGB9_E5;        m_format = GL_RGB;          m_type = GL_UNSIGNED_INT_5_9_9_9_REV;     m_components = 3; break;
-		case DDS_DXGI_FORMAT_B5G6R5_UNORM:        m_formatQualifier = "unknown";        m_internalFormat = GL_RGB565;         m_format = GL_RGB;          m_type = GL_UNSIGNED_SHORT_5_6_5;         m_components = 3; break;
-		case DDS_DXGI_FORMAT_B5G5R5A1_UNORM:      m_formatQualifier = "unknown";        m_internalFormat = GL_RGB5_A1;        m_format = GL_BGRA;         m_type = GL_UNSIGNED_SHORT_1_5_5_5_REV;   m_components = 4; break;
-		case DDS_DXGI_FORMAT_B4G4R4A4_UNORM:      m_formatQualifier = "unknown";        m_internalFormat = GL_RGBA4;          m_format = GL_BGRA;         m_type = GL_UNSIGNED_SHORT_4_4_4_4_REV;   m_components = 4; break;
-		// unsigned integer
-		case DDS_DXGI_FORMAT_R8_UINT:             m_formatQualifier = "r8ui";           m_internalFormat = GL_R8UI;           m_format = GL_RED_INTEGER;  m_type = GL_UNSIGNED_BYTE;                m_components = 1; m_samplerType = SAMPLER_TYPE_UNSIGNED_INT; break;
-		case DDS_DXGI_FORMAT_R8G8_UINT:           m_formatQualifier = "rg8ui";          m_internalFormat = GL_RG8UI;          m_format = GL_RG_INTEGER;   m_type = GL_UNSIGNED_BYTE;                m_components = 2; m_samplerType = SAMPLER_TYPE_UNSIGNED_INT; break;
-		case DDS_DXGI_FORMAT_R8G8B8A8_UINT:       m_formatQualifier = "rgba8ui";        m_internalFormat = GL_RGBA8UI;        m_format = GL_RGBA_INTEGER; m_type = GL_UNSIGNED_BYTE;                m_components = 4; m_samplerType = SAMPLER_TYPE_UNSIGNED_INT; break;
-		case DDS_DXGI_FORMAT_R16_UINT:            m_formatQualifier = "r16ui";          m_internalFormat = GL_R16UI;          m_format = GL_RED_INTEGER;  m_type = GL_UNSIGNED_SHORT;               m_components = 1; m_samplerType = SAMPLER_TYPE_UNSIGNED_INT; break;
-		case DDS_DXGI_FORMAT_R16G16_UINT:         m_formatQualifier = "rg16ui";         m_internalFormat = GL_RG16UI;         m_format = GL_RG_INTEGER;   m_type = GL_UNSIGNED_SHORT;               m_components = 2; m_samplerType = SAMPLER_TYPE_UNSIGNED_INT; break;
-		case DDS_DXGI_FORMAT_R16G16B16A16_UINT:   m_formatQualifier = "rgba16ui";       m_internalFormat = GL_RGBA16UI;       m_format = GL_RGBA_INTEGER; m_type = GL_UNSIGNED_SHORT;               m_components = 4; m_samplerType = SAMPLER_TYPE_UNSIGNED_INT; break;
-		case DDS_DXGI_FORMAT_R32_UINT:            m_formatQualifier = "r32ui";          m_internalFormat = GL_R32UI;          m_format = GL_RED_INTEGER;  m_type = GL_UNSIGNED_INT;                 m_components = 1; m_samplerType = SAMPLER_TYPE_UNSIGNED_INT; break;
-		case DDS_DXGI_FORMAT_R32G32_UINT:         m_formatQualifier = "rg32ui";         m_internalFormat = GL_RG32UI;         m_format = GL_RG_INTEGER;   m_type = GL_UNSIGNED_INT;                 m_components = 2; m_samplerType = SAMPLER_TYPE_UNSIGNED_INT; break;
-		case DDS_DXGI_FORMAT_R32G32B32A32_UINT:   m_formatQualifier = "rgba32ui";       m_internalFormat = GL_RGBA32UI;       m_format = GL_RGBA_INTEGER; m_type = GL_UNSIGNED_INT;                 m_components = 4; m_samplerType = SAMPLER_TYPE_UNSIGNED_INT; break;
-		case DDS_DXGI_FORMAT_R10G10B10A2_UINT:    m_formatQualifier = "rgb10_a2ui";     m_internalFormat = GL_RGB10_A2UI;     m_format = GL_RGBA_INTEGER; m_type = GL_UNSIGNED_INT_2_10_10_10_REV;  m_components = 4; m_samplerType = SAMPLER_TYPE_UNSIGNED_INT; break; // untested!
-		// signed integer
-		case DDS_DXGI_FORMAT_R8_SINT:             m_formatQualifier = "r8i";            m_internalFormat = GL_R8I;            m_format = GL_RED_INTEGER;  m_type = GL_BYTE;                         m_components = 1; m_samplerType = SAMPLER_TYPE_SIGNED_INT; break;
-		case DDS_DXGI_FORMAT_R8G8_SINT:           m_formatQualifier = "rg8i";           m_internalFormat = GL_RG8I;           m_format = GL_RG_INTEGER;   m_type = GL_BYTE;                         m_components = 2; m_samplerType = SAMPLER_TYPE_SIGNED_INT; break;
-		case DDS_DXGI_FORMAT_R8G8B8A8_SINT:       m_formatQualifier = "rgba8i";         m_internalFormat = GL_RGBA8I;         m_format = GL_RGBA_INTEGER; m_type = GL_BYTE;                         m_components = 4; m_samplerType = SAMPLER_TYPE_SIGNED_INT; break;
-		case DDS_DXGI_FORMAT_R16_SINT:            m_formatQualifier = "r16i";           m_internalFormat = GL_R16I;           m_format = GL_RED_INTEGER;  m_type = GL_SHORT;                        m_components = 1; m_samplerType = SAMPLER_TYPE_SIGNED_INT; break;
-		case DDS_DXGI_FORMAT_R16G16_SINT:         m_formatQualifier = "rg16i";          m_internalFormat = GL_RG16I;          m_format = GL_RG_INTEGER;   m_type = GL_SHORT;                        m_components = 2; m_samplerType = SAMPLER_TYPE_SIGNED_INT; break;
-		case DDS_DXGI_FORMAT_R16G16B16A16_SINT:   m_formatQualifier = "rgba16i";        m_internalFormat = GL_RGBA16I;        m_format = GL_RGBA_INTEGER; m_type = GL_SHORT;                        m_components = 4; m_samplerType = SAMPLER_TYPE_SIGNED_INT; break;
-		case DDS_DXGI_FORMAT_R32_SINT:            m_formatQualifier = "r32i";           m_internalFormat = GL_R32I;           m_format = GL_RED_INTEGER;  m_type = GL_INT;                          m_components = 1; m_samplerType = SAMPLER_TYPE_SIGNED_INT; break;
-		case DDS_DXGI_FORMAT_R32G32_SINT:         m_formatQualifier = "rg32i";          m_internalFormat = GL_RG32I;          m_format = GL_RG_INTEGER;   m_type = GL_INT;                          m_components = 2; m_samplerType = SAMPLER_TYPE_SIGNED_INT; break;
-		case DDS_DXGI_FORMAT_R32G32B32A32_SINT:   m_formatQualifier = "rgba32i";        m_internalFormat = GL_RGBA32I;        m_format = GL_RGBA_INTEGER; m_type = GL_INT;                          m_components = 4; m_samplerType = SAMPLER_TYPE_SIGNED_INT; break;
-		// block compressed
-		case DDS_DXGI_FORMAT_BC1_UNORM:           m_internalFormat = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;        m_components = 4; m_compressed = true; break;
-		case DDS_DXGI_FORMAT_BC1_UNORM_SRGB:      m_internalFormat = GL_COMPRESSED_SRGB_S3TC_DXT1_EXT;       m_components = 4; m_compressed = true; break;
-		case DDS_DXGI_FORMAT_BC2_UNORM:           m_internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;       m_components = 4; m_compressed = true; break;
-		case DDS_DXGI_FORMAT_BC2_UNORM_SRGB:      m_internalFormat = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT; m_components = 4; m_compressed = true; break;
-		case DDS_DXGI_FORMAT_BC3_UNORM:           m_internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;       m_components = 4; m_compressed = true; break;
-		case DDS_DXGI_FORMAT_BC3_UNORM_SRGB:      m_internalFormat = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT; m_components = 4; m_compressed = true; break;
-		case DDS_DXGI_FORMAT_BC4_UNORM:           m_internalFormat = GL_COMPRESSED_RED_RGTC1;                m_components = 1; m_compressed = true; break;
-		case DDS_DXGI_FORMAT_BC4_SNORM:           m_internalFormat = GL_COMPRESSED_SIGNED_RED_RGTC1;         m_components = 1; m_compressed = true; break;
-		case DDS_DXGI_FORMAT_BC5_UNORM:           m_internalFormat = GL_COMPRESSED_RG_RGTC2;                 m_components = 2; m_compressed = true; break;
-		case DDS_DXGI_FORMAT_BC5_SNORM:           m_internalFormat = GL_COMPRESSED_SIGNED_RG_RGTC2;          m_components = 2; m_compressed = true; break;
-		case DDS_DXGI_FORMAT_BC6H_UF16:           m_internalFormat = GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT;  m_components = 3; m_compressed = true; break;
-		case DDS_DXGI_FORMAT_BC6H_SF16:           m_internalFormat = GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT;    m_components = 3; m_compressed = true; break;
-		case DDS_DXGI_FORMAT_BC7_UNORM:           m_internalFormat = GL_COMPRESSED_RGBA_BPTC_UNORM;          m_components = 4; m_compressed = true; break;
-		case DDS_DXGI_FORMAT_BC7_UNORM_SRGB:      m_internalFormat = GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM;    m_components = 4; m_compressed = true; break;
-
-		// =============================================================
-		// notable DXGI formats missing:
-		// all "typeless" formats (they don't really belong here)
-		// all formats with "X" (e.g. R8G8B8X8)
-		// all formats with "D" (e.g. D32_FLOAT)
-		// interleaved formats (R8G8_B8G8 and G8R8_G8B8)
-		// R10G10B10_XR_BIAS_A2_UNORM
-		// 7E3 and 6E4 compressed float formats
-		// R10G10B10_SNORM_A2_UNORM and R4G4_UNORM, and R1_UNORM formats
-		// =============================================================
-		default: ForceAssert(false);
-		}
-
-		const bool isTypeUInt = (m_type == GL_UNSIGNED_BYTE || m_type == GL_UNSIGNED_SHORT || m_type == GL_UNSIGNED_INT || m_type == GL_UNSIGNED_INT_2_10_10_10_REV);
-		const bool isTypeSInt = (m_type == GL_BYTE || m_type == GL_SHORT || m_type == GL_INT);
-		switch (m_format) {
-		case GL_RED:  m_formatType = "float"; break;
-		case GL_RG:   m_formatType = "vec2";  break;
-		case GL_RGB:  m_formatType = "vec3";  break;
-		case GL_RGBA: m_formatType = "vec4";  break;
-		case GL_BGRA: m_formatType = "vec4";  break;
-		case GL_RED_INTEGER:  m_formatType = isTypeUInt ? "uint"  : "int";   break;
-		case GL_RG_INTEGER:   m_formatType = isTypeUInt ? "uvec2" : "ivec2"; break;
-		case GL_RGB_INTEGER:  m_formatType = isTypeUInt ? "uvec3" : "ivec3"; break;
-		case GL_RGBA_INTEGER: m_formatType = isTypeUInt ? "uvec4" : "ivec4"; break;
-		}
-	}
-
-	const char* m_formatQualifier; // e.g. "rgba8"
-	const char* m_formatType; // e.g. "vec4"
-	GLenum m_internalFormat; // e.g. GL_RGBA8
-	GLenum m_format; // e.g. GL_RGBA
-	GLenum m_type; // e.g. GL_UNSIGNED_BYTE
-	eSamplerType m_samplerType;
-	uint32 m_components;
-	bool m_compressed;
-};
-
-static std::string GetOpenGLSamplerTypeStr(GLenum target, DDS_DXGI_FORMAT format, bool isShadowSampler = false, bool isImageSampler = false, bool isLayered = true)
-{
-	if (!isLayered) {
-		switch (target) {
-		case GL_TEXTURE_1D_ARRAY:             target = GL_TEXTURE_1D; break;
-		case GL_TEXTURE_2D_ARRAY:             target = GL_TEXTURE_2D; break; // once layer of array texture
-		case GL_TEXTURE_2D_MULTISAMPLE_ARRAY: target = GL_TEXTURE_2D_MULTISAMPLE; break;
-		case GL_TEXTURE_3D:                   target = GL_TEXTURE_2D; break; // one slice of 3D texture
-		case GL_TEXTURE_CUBE_MAP:             target = GL_TEXTURE_2D; break; // once face of cube map texture
-		case GL_TEXTURE_CUBE_MAP_ARRAY:       target = GL_TEXTURE_2D; break;
-		}
-	}
-	const char* samplerTypeStr = "samplerUnknown";
-	if (isShadowSampler) {
-		switch (target) {
-		case GL_TEXTURE_1D:                   samplerTypeStr = "sampler1DShadow"; break;
-		case GL_TEXTURE_1D_ARRAY:             samplerTypeStr = "sampler1DArrayShadow"; break;
-		case GL_TEXTURE_2D:                   samplerTypeStr = "sampler2DShadow"; break;
-		case GL_TEXTURE_2D_ARRAY:             samplerTypeStr = "sampler2DArrayShadow"; break;
-		case GL_TEXTURE_CUBE_MAP:             samplerTypeStr = "samplerCubeShadowShadow"; break;
-		case GL_TEXTURE_CUBE_MAP_ARRAY:       samplerTypeStr = "samplerCubeArrayShadow"; break;
-		case GL_TEXTURE_RECTANGLE:            samplerTypeStr = "sampler2DRectShadow"; break;
-		}
-	} else {
-		switch (target) {
-		case GL_TEXTURE_1D:                   samplerTypeStr = "sampler1D"; break;
-		case GL_TEXTURE_1D_ARRAY:             samplerTypeStr = "sampler1DArray"; break;
-		case GL_TEXTURE_2D:                   samplerTypeStr = "sampler2D"; break;
-		case GL_TEXTURE_2D_ARRAY:             samplerTypeStr = "sampler2DArray"; break;
-		case GL_TEXTURE_2D_MULTISAMPLE:       samplerTypeStr = "sampler2DMS"; break;
-		case GL_TEXTURE_2D_MULTISAMPLE_ARRAY: samplerTypeStr = "sampler2DMSArray"; break;
-		case GL_TEXTURE_3D:                   samplerTypeStr = "sampler3D"; break;
-		case GL_TEXTURE_CUBE_MAP:             samplerTypeStr = "samplerCube"; break;
-		case GL_TEXTURE_CUBE_MAP_ARRAY:       samplerTypeStr = "samplerCubeArray"; break;
-		case GL_TEXTURE_RECTANGLE:            samplerTypeStr = "sampler2DRect"; break;
-		case GL_TEXTURE_BUFFER:               samplerTypeStr = "samplerBuffer"; break;
-		}
-	}
-	if (isImageSampler) {
-		static char temp[64];
-		sprintf(temp, "image%s", samplerTypeStr + strlen("sampler")); // replace 'sampler' with 'image'
-		samplerTypeStr = temp;
-	}
-	const char* samplerTypePrefix = "";
-	const TextureFormatInfo info(format);
-	if (info.m_samplerType == TextureFormatInfo::SAMPLER_TYPE_UNSIGNED_INT)
-		samplerTypePrefix = "u";
-	else if (info.m_samplerType == TextureFormatInfo::SAMPLER_TYPE_SIGNED_INT)
-		samplerTypePrefix = "i";
-	return varString("%s%s", samplerTypePrefix, samplerTypeStr);
-}
-
-static void BindTextureTarget(GLuint programID, GLuint textureID, GLenum target, uint32 slot, const char* varName, uint32 varIndex = 0)
-{
-	ForceAssert(slot < 32);
-	glActiveTexture(GL_TEXTURE0 + slot);
-	glBindTexture(target, textureID);
-	const GLint location = glGetUniformLocation(programID, varName);
-	if (location != -1)
-		glUniform1i(location + varIndex, slot);
-	glActiveTexture(GL_TEXTURE0); // restore
-}
-
-static uint32 g_Frame = 0;
-static float g_Time = 0.0f;
-static float g_TimeDelta = 0.0f;
-
-static void UpdateFrameTime()
-{
-	static uint64 time0 = 0;
-	static uint64 time = 0;
-	if (time == 0)
-		time = time0 = ProgressDisplay::GetCurrentPerformanceTime();
-	else {
-		g_Time = ProgressDisplay::GetTimeInSeconds(time0);
-		g_TimeDelta = ProgressDisplay::GetDeltaTimeInSeconds(time);
-	}
-}
-
-static bool LoadFileIntoStrings(std::vector<std::string>& strings, const char* path)
-{
-	FILE* file = fopen(path, "r");
-	if (file) {
-		char line[8192];
-		while (fgets(line, sizeof(line), file)) {
-			char* end = strstr(line, "\r\n");
-			if (end)
-				*end = '\0';
-			else {
-				end = strrchr(line, '\n');
-				if (end && end[1] == '\0')
-					*end = '\0';
-			}
-			strings.push_back(line);
-		}
-		fclose(file);
-		return true;
-	} else
-		return false;
-}
-
-template <typename PixelType> static void Downsample2D(PixelType* dstImage, uint32 dstW, uint32 dstH, const PixelType* srcImage, uint32 srcW, uint32 srcH)
-{
-	if (dstW == srcW && dstH == srcH)
-		memcpy(dstImage, srcImage, srcW*srcH*sizeof(PixelType));
-	else {
-		ForceAssert(dstW <= srcW && dstH <= srcH);
-		const uint32 sx = srcW/dstW;
-		const uint32 sy = srcH/dstH;
-		for (uint32 mj = 0; mj < dstH; mj++) {
-			for (uint32 mi = 0; mi < dstW; mi++) {
-				Vec4V sum(V_ZERO);
-				uint32 count = 0;
-				for (uint32 jj = 0; jj < sy; jj++) {
-					for (uint32 ii = 0; ii < sx; ii++) {
-						const uint32 i = ii + mi*sx;
-						const uint32 j = jj + mj*sy;
-						if (i < srcW && j < srcH) {
-							sum += srcImage[i + j*srcW];
-							count++;
-						}
-					}
-				}
-				if (count > 0)
-					sum *= 1.0f/(float)count;
-				dstImage[mi + mj*dstW] = sum;
-			}
-		}
-	}
-}
-
-static void ReshapeFunc(int width, int height)
-{
-	g_ViewportWidth = width;
-	g_ViewportHeight = height;
-	g_Frame = 0; // iFrame does not get reset when window changes in ShaderToy .. but i find this behavior useful
-	glutReshapeWindow(width, height);
-}
-
-static const char* GetName(const NameValuePairs* nvp)
-{
-	if (nvp && nvp->size() > 0 && (nvp->operator[](0).m_name == std::string("name") || nvp->operator[](0).m_name.empty()))
-		return nvp->operator[](0).m_value.c_str();
-	else
-		return nullptr;
-}
-
-// e.g. //$BUFFER: name=variance, relative_width=0.25, relative_height=0.25, format=R32G32B32_FLOAT, filter=OFF
-class ShaderToyBuffer
-{
-public:
-	enum
-	{
-		KEYBOARD_INPUT_TEXTURE_WIDTH = 256,
-		KEYBOARD_INPUT_TEXTURE_HEIGHT = 3, // y=0..2 (0=down,1=pressed,2=toggled)
-
-		KEYBOARD2_INPUT_TEXTURE_WIDTH = 256,
-		KEYBOARD2_INPUT_TEXTURE_HEIGHT = 10,
-	};
-
-	class Desc
-	{
-	public:
-		Desc()
-			: m_hash(0)
-			, m_name("")
-			, m_path("")
-			, m_resolutionX(0)
-			, m_resolutionY(0)
-			, m_resolutionZ(0)
-			, m_relativeResX(0.0f)
-			, m_relativeResY(0.0f)
-			, m_numLayers(0)
-			, m_mipLevels(0)
-			, m_isCubemap(false)
-			, m_format(DDS_DXGI_FORMAT_UNKNOWN)
-			, m_filter(false)
-			, m_wrap(false)
-		{}
-
-		bool IsImmutable() const
-		{
-			return Max(m_relativeResX, m_relativeResY) <= 0.0f;
-		}
-
-		void CalculateHash()
-		{
-			ForceAssert(m_hash == 0);
-			uint64 hash = 0;
-			hash = Crc64(m_name.c_str(), m_name.size(), hash);
-			hash = Crc64(m_path.c_str(), m_path.size(), hash);
-			hash = Crc64(m_resolutionX, hash);
-			hash = Crc64(m_resolutionY, hash);
-			hash = Crc64(m_resolutionZ, hash);
-			hash = Crc64(m_relativeResX, hash);
-			hash = Crc64(m_relativeResY, hash);
-			hash = Crc64(m_numLayers, hash);
-			hash = Crc64(m_mipLevels, hash);
-			hash = Crc64(m_isCubemap, hash);
-			hash = Crc64(m_format, hash);
-			hash = Crc64(m_filter, hash);
-			hash = Crc64(m_wrap, hash);
-			m_hash = hash;
-		}
-
-		void Print(const char* indent = "") const
-		{
-			printf("%sm_hash = 0x%08x%08x\n", indent, (uint32)(m_hash >> 32), (uint32)m_hash);
-			printf("%sm_name = \"%s\"\n", indent, m_name.c_str());
-			printf("%sm_path = \"%s\"\n", indent, m_path.c_str());
-			printf("%sm_resolutionX = %u\n", indent, m_resolutionX);
-			printf("%sm_resolutionY = %u\n", indent, m_resolutionY);
-			printf("%sm_resolutionZ = %u\n", indent, m_resolutionZ);
-			printf("%sm_relativeResX = %f\n", indent, m_relativeResX);
-			printf("%sm_relativeResY = %f\n", indent, m_relativeResY);
-			printf("%sm_numLayers = %u\n", indent, m_numLayers);
-			printf("%sm_mipLevels = %u\n", indent, m_mipLevels);
-			printf("%sm_isCubemap = %s\n", indent, m_isCubemap ? "TRUE" : "FALSE");
-			printf("%sm_format = %s\n", indent, GetDX10FormatStr(m_format, true));
-			printf("%sm_filter = %s\n", indent, m_filter ? "TRUE" : "FALSE");
-			printf("%sm_wrap = %s\n", indent, m_wrap ? "TRUE" : "FALSE");
-		}
-
-		uint64 m_hash;
-		std::string m_name;
-		std::string m_path;
-		uint32 m_resolutionX; // specified resolution
-		uint32 m_resolutionY;
-		uint32 m_resolutionZ;
-		float m_relativeResX; // if >0, xy resolution will be relative to main viewport
-		float m_relativeResY;
-		uint32 m_numLayers;
-		uint32 m_mipLevels;
-		bool m_isCubemap; // TODO
-		DDS_DXGI_FORMAT m_format;
-		bool m_filter;
-		bool m_wrap;
-	};
-
-	static ShaderToyBuffer* Add(int passIndex, const char* name, const NameValuePairs* nvp = nullptr)
-	{
-		const char* bufferDescParams[] = {
-			"path",
-			"width",
-			"height",
-			"depth",
-			"relative_width",
-			"relative_height",
-			"layers",
-			"mips",
-			"format",
-			"filter",
-			"wrap",
-		};
-		Desc desc;
-		desc.m_name = name;
-		if (strcmp(name, "[KEYBOARD]") == 0) {
-			desc.m_path = "";
-			desc.m_resolutionX = KEYBOARD_INPUT_TEXTURE_WIDTH;
-			desc.m_resolutionY = KEYBOARD_INPUT_TEXTURE_HEIGHT;
-			desc.m_resolutionZ = 1;
-			desc.m_relativeResX = 0.0f;
-			desc.m_relativeResY = 0.0f;
-			desc.m_numLayers = 1;
-			desc.m_mipLevels = 1;
-			desc.m_isCubemap = false;
-			desc.m_format = DDS_DXGI_FORMAT_R8_UNORM;
-			desc.m_filter = false;
-			desc.m_wrap = false;
-		} else if (strcmp(name, "[KEYBOARD2]") == 0) {
-			desc.m_path = "";
-			desc.m_resolutionX = KEYBOARD2_INPUT_TEXTURE_WIDTH;
-			desc.m_resolutionY = KEYBOARD2_INPUT_TEXTURE_HEIGHT;
-			desc.m_resolutionZ = 1;
-			desc.m_relativeResX = 0.0f;
-			desc.m_relativeResY = 0.0f;
-			desc.m_numLayers = 1;
-			desc.m_mipLevels = 1;
-			desc.m_isCubemap = false;
-			desc.m_format = DDS_DXGI_FORMAT_R32_UINT;
-			desc.m_filter = false;
-			desc.m_wrap = false;
-		} else {
-			desc.m_path = nvp->GetStringValue("path", "");
-			desc.m_resolutionX = nvp->GetUIntValue("width");
-			desc.m_resolutionY = nvp->GetUIntValue("height");
-			desc.m_resolutionZ = nvp->GetUIntValue("depth", 1);
-			desc.m_relativeResX = nvp->GetFloatValue("relative_width");
-			desc.m_relativeResY = nvp->GetFloatValue("relative_height");
-			desc.m_numLayers = nvp->GetUIntValue("layers", 1);
-			desc.m_mipLevels = nvp->GetUIntValue("mips", 1);
-			desc.m_isCubemap = false;
-			desc.m_format = GetDX10FormatFromString(nvp->GetStringValue("format", "UNKNOWN"));
-			desc.m_filter = nvp->GetBoolValue("filter", !desc.m_path.empty());
-			desc.m_wrap = nvp->GetBoolValue("wrap");
-		}
-
-		// defaults
-		if (desc.m_relativeResX <= 0.0f && desc.m_resolutionX == 0 && desc.m_path.empty())
-			desc.m_relativeResX = 1.0f;
-		if (desc.m_relativeResY <= 0.0f && desc.m_resolutionY == 0 && desc.m_path.empty())
-			desc.m_relativeResY = 1.0f;
-		if (desc.m_mipLevels == 0)
-			desc.m_mipLevels = 1;
-		if (desc.m_format == DDS_DXGI_FORMAT_UNKNOWN)
-			desc.m_format = desc.m_path.empty() ? DDS_DXGI_FORMAT_R32G32B32A32_FLOAT : DDS_DXGI_FORMAT_R8G8B8A8_UNORM;
-	#if 1 // my laptop (GeForce 940MX)
-		uint32 maxTextureRes2D = 16384;
-		uint32 maxTextureRes3D = 2048;
-		uint32 maxTextureLayers = 2048;
-	#else // my work desktop (RTX 2080)
-		uint32 maxTextureRes2D = 32768;
-		uint32 maxTextureRes3D = 16384;
-		uint32 maxTextureLayers = 2048;
-	#endif
-		if (1) { // query opengl implementation
-			glGetIntegerv(GL_MAX_TEXTURE_SIZE, (GLint*)&maxTextureRes2D);
-			glGetIntegerv(GL_MAX_3D_TEXTURE_SIZE, (GLint*)&maxTextureRes3D);
-			glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, (GLint*)&maxTextureLayers);
-			static bool once = true;
-			if (once) {
-				once = false;
-				printf("GL_MAX_TEXTURE_SIZE = %u\n", maxTextureRes2D);
-				printf("GL_MAX_3D_TEXTURE_SIZE = %u\n", maxTextureRes3D);
-				printf("GL_MAX_ARRAY_TEXTURE_LAYERS = %u\n", maxTextureLayers);
-			}
-		}
-		if (desc.m_resolutionZ > 1) {
-			if (Max(desc.m_resolutionX, desc.m_resolutionY, desc.m_resolutionZ) > maxTextureRes3D) {
-				printf("warning: 3D texture \"%s\" resolution %ux%ux%u exceeded maximum %u, clamping ..\n", name, desc.m_resolutionX, desc.m_resolutionY, desc.m_resolutionZ, maxTextureRes3D);
-				desc.m_resolutionX = Min(desc.m_resolutionX, maxTextureRes3D);
-				desc.m_resolutionY = Min(desc.m_resolutionY, maxTextureRes3D);
-				desc.m_resolutionZ = Min(desc.m_resolutionZ, maxTextureRes3D);
-			}
-			if (desc.m_numLayers > 1) {
-				printf("warning: 3D texture \"%s\" specified with %u layers, cannot have layers ..\n", name, desc.m_numLayers);
-				desc.m_numLayers = 1;
-			}
-		} else if (Max(desc.m_resolutionX, desc.m_resolutionY) > maxTextureRes2D) {
-			printf("warning: 2D texture \"%s\" resolution %ux%u exceeded maximum %u, clamping ..\n", name, desc.m_resolutionX, desc.m_resolutionY, maxTextureRes2D);
-			desc.m_resolutionX = Min(desc.m_resolutionX, maxTextureRes2D);
-			desc.m_resolutionY = Min(desc.m_resolutionY, maxTextureRes2D);
-		}
-		if (desc.m_numLayers > maxTextureLayers) {
-			printf("warning: texture \"%s\" specified with %u layers exceeded maximum %u, clamping ..\n", name, desc.m_numLayers, maxTextureLayers);
-			desc.m_numLayers = maxTextureLayers;
-		}
-		if (desc.m_mipLevels > 1 && !desc.IsImmutable()) {
-			printf("warning: non-immutable texture \"%s\" specified with %u mips, cannot have mips .. (wait, why?)\n", name, desc.m_mipLevels);
-			desc.m_mipLevels = 1;
-		}
-		if (desc.m_path.empty()) {
-			ForceAssert((desc.m_relativeResX == 0.0f && desc.m_resolutionX > 0) || (desc.m_relativeResX > 0.0f && desc.m_resolutionX == 0)); 
-			ForceAssert((desc.m_relativeResY == 0.0f && desc.m_resolutionY > 0) || (desc.m_relativeResY > 0.0f && desc.m_resolutionY == 0)); 
-		} else {
-			ForceAssert(desc.m_relativeResX == 0.0f && desc.m_relativeResY == 0.0f);
-			//ForceAssert(Max(desc.m_resolutionX, desc.m_resolutionY) == 0 && desc.m_resolutionZ == 1); // texture gets resolution from image file
-			//ForceAssert(desc.m_numLayers == 1);
-			// TODO -- might be nice to allow for arrays or volumes (or mips) stored as atlases ..
-		}
-
-		ShaderToyBuffer* buffer = Find(name);
-		Vec4V* image = nullptr;
-		if (!desc.m_path.empty()) {
-			uint32 w = 0;
-			uint32 h = 0;
-			if (FileExists(desc.m_path.c_str()))
-				image = LoadImage_Vec4V(desc.m_path.c_str(), (int&)w, (int&)h);
-			if (image) {
-				desc.m_resolutionX = w;
-				desc.m_resolutionY = h;
-				desc.m_mipLevels = Min(Log2FloorInt(Max(w, h)) + 1U, desc.m_mipLevels);
-			} else {
-				desc.m_path = "[DEFAULT]";
-				desc.m_resolutionX = w = 4; // tiny black square
-				desc.m_resolutionY = h = 4;
-				image = new Vec4V[w*h];
-				memset(image, 0, w*h*sizeof(Vec4V));
-			}
-		}
-		desc.CalculateHash();
-		if (buffer) {
-			if (desc.m_hash != buffer->m_desc.m_hash && nvp && nvp->size() > 1) {
-				// let's see if there are actually any buffer description params - nvp might just contain other params (e.g. layer=xxx for outputs)
-				bool hasBufferDescParams = false;
-				for (int i = 0; i < icountof(bufferDescParams); i++) {
-					if (nvp->HasValue(bufferDescParams[i])) {
-						hasBufferDescParams = true;
-						break;
-					}
-				}
-				if (hasBufferDescParams) {
-					printf("warning: buffer hash mismatch for \"%s\" in pass %i!\n", name, passIndex);
-					printf("existing buffer was:\n");
-					buffer->m_desc.Print("\t");
-					printf("new buffer is:\n");
-					desc.Print("\t");
-				}
-			}
-		} else {
-			buffer = new ShaderToyBuffer();
-			buffer->m_desc = desc;
-			buffer->m_res[0] = 0;
-			buffer->m_res[1] = 0;
-			buffer->m_res[2] = 0;
-			buffer->m_textureID = 0;
-			buffer->m_target = GL_NONE;
-			buffer->Update(image);
-			GetMap()[name] = buffer;
-		}
-		if (image)
-			delete[] image;
-		return buffer;
-	}
-
-	void Update(const Vec4V* image = nullptr)
-	{
-		const uint32 w = m_desc.m_relativeResX <= 0.0f ? m_desc.m_resolutionX : (uint32)Ceiling(m_desc.m_relativeResX*(float)g_ViewportWidth);
-		const uint32 h = m_desc.m_relativeResY <= 0.0f ? m_desc.m_resolutionY : (uint32)Ceiling(m_desc.m_relativeResY*(float)g_ViewportHeight);
-		const uint32 d = m_desc.m_resolutionZ;
-		if (m_res[0] != w || m_res[1] != h) { // resolution changed (because window size changed), or needs setup
-			m_res[0] = w;
-			m_res[1] = h;
-			m_res[2] = d;
-			m_target = m_desc.m_resolutionZ > 1 ? GL_TEXTURE_3D : (m_desc.m_numLayers > 1 ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D);
-			m_mipLevels = Min(Log2FloorInt(Max(w, h, d)) + 1U, m_desc.m_mipLevels); // actual mip levels
-			const bool isArrayOr3D = m_desc.m_resolutionZ > 1 || m_desc.m_numLayers > 1;
-			const TextureFormatInfo info(m_desc.m_format);
-			if (m_textureID == 0) {
-				glGenTextures(1, &m_textureID);
-				glBindTexture(m_target, m_textureID);
-				glTexParameteri(m_target, GL_TEXTURE_MAG_FILTER, m_desc.m_filter ? GL_LINEAR : GL_NEAREST);
-				glTexParameteri(m_target, GL_TEXTURE_MIN_FILTER, m_desc.m_filter ? (m_mipLevels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR) : GL_NEAREST);
-				glTexParameteri(m_target, GL_TEXTURE_MAX_LEVEL, m_mipLevels - 1);
-				glTexParameteri(m_target, GL_TEXTURE_WRAP_S, m_desc.m_wrap ? GL_REPEAT : GL_CLAMP_TO_EDGE);
-				glTexParameteri(m_target, GL_TEXTURE_WRAP_T, m_desc.m_wrap ? GL_REPEAT : GL_CLAMP_TO_EDGE);
-				if (m_target == GL_TEXTURE_3D)
-					glTexParameteri(m_target, GL_TEXTURE_WRAP_R, m_desc.m_wrap ? GL_REPEAT : GL_CLAMP_TO_EDGE);
-			} else
-				glBindTexture(m_target, m_textureID);
-			if (m_desc.IsImmutable()) {
-				const uint32 numLayersOrSlices = m_desc.m_resolutionZ > 1 ? d : m_desc.m_numLayers;
-				if (isArrayOr3D)
-					glTexStorage3D(m_target, m_mipLevels, info.m_internalFormat, w, h, numLayersOrSlices);
-				else {
-					glTexStorage2D(m_target, m_mipLevels, info.m_internalFormat, w, h);
-					if (image) {
-						const uint32 bs = GetDX10FormatBlockSize(m_desc.m_format);
-						const uint32 blockSizeInBytes = (GetDX10FormatBitsPerPixel(m_desc.m_format)*bs*bs)/8;
-						Vec4V* mipImage = nullptr;
-						const Vec4V* src = image;
-						void* temp = nullptr;
-						for (uint32 mipIndex = 0; mipIndex < m_mipLevels; mipIndex++) {
-							const uint32 mw = Max(1U, w >> mipIndex);
-							const uint32 mh = Max(1U, h >> mipIndex);
-							const uint32 bw = (mw + bs - 1)/bs;
-							const uint32 bh = (mh + bs - 1)/bs;
-							const uint32 imageSizeInBytes = bw*bh*blockSizeInBytes;
-							if (mipIndex > 0) {
-								if (mipImage == nullptr)
-									mipImage = new Vec4V[mw*mh];
-								Downsample2D(mipImage, mw, mh, image, w, h);
-								src = mipImage;
-							}
-							if (temp == nullptr)
-								temp = new char[imageSizeInBytes];
-							const bool sRGB =
-								m_desc.m_format == DDS_DXGI_FORMAT_R8G8B8A8_UNORM_SRGB ||
-								m_desc.m_format == DDS_DXGI_FORMAT_B8G8R8A8_UNORM_SRGB ||
-								m_desc.m_format == DDS_DXGI_FORMAT_B8G8R8X8_UNORM_SRGB ||
-								m_desc.m_format == DDS_DXGI_FORMAT_BC1_UNORM_SRGB      ||
-								m_desc.m_format == DDS_DXGI_FORMAT_BC2_UNORM_SRGB      ||
-								m_desc.m_format == DDS_DXGI_FORMAT_BC3_UNORM_SRGB      ||
-								m_desc.m_format == DDS_DXGI_FORMAT_BC7_UNORM_SRGB;
-							if (ForceAssertVerify(ConvertPixelsToDX10Format(temp, m_desc.m_format, src, mw, mh, sRGB))) {
-								if (info.m_compressed)
-									glCompressedTexSubImage2D(GL_TEXTURE_2D, mipIndex, 0, 0, mw, mh, info.m_internalFormat, imageSizeInBytes, temp);
-								else
-									glTexSubImage2D(GL_TEXTURE_2D, mipIndex, 0, 0, mw, mh, info.m_format, info.m_type, temp);
-							}
-						}
-						if (mipImage)
-							delete[] mipImage;
-						if (temp)
-							delete[] temp;
-					}
-				}
-			} else {
-				const GLint border = 0;
-				for (uint32 mipIndex = 0; mipIndex < m_mipLevels; mipIndex++) {
-					const uint32 mw = Max(1U, w >> mipIndex);
-					const uint32 mh = Max(1U, h >> mipIndex);
-					const uint32 md = Max(1U, d >> mipIndex);
-					const uint32 numLayersOrSlices = m_desc.m_resolutionZ > 1 ? md : m_desc.m_numLayers;
-					if (isArrayOr3D)
-						glTexImage3D(m_target, mipIndex, info.m_internalFormat, mw, mh, numLayersOrSlices, border, info.m_format, info.m_type, nullptr);
-					else
-						glTexImage2D(m_target, mipIndex, info.m_internalFormat, mw, mh, border, info.m_format, info.m_type, nullptr);
-				}
-			}
-			glBindTexture(m_target, 0); // restore
-		}
-
-		// update keyboard texture
-		if (m_desc.m_name == std::string("[KEYBOARD]")) {
-			const uint32 w = KEYBOARD_INPUT_TEXTURE_WIDTH;
-			const uint32 h = KEYBOARD_INPUT_TEXTURE_HEIGHT;
-			static uint8 keyToggled[(w + 7)>>3];
-			static bool keyOnce = true;
-			if (keyOnce) {
-				keyOnce = false;
-				memset(keyToggled, 0, sizeof(keyToggled));
-			}
-			for (uint32 i = 0; i < w; i++) {
-				if (g_Keyboard.IsKeyPressed(i, Keyboard::MODIFIER_ANY))
-					keyToggled[i>>3] ^= BIT(i&7);
-			}
-			static uint8* keyboardInputData = nullptr;
-			if (keyboardInputData == nullptr)
-				keyboardInputData = new uint8[w*h];
-			memset(keyboardInputData, 0, w*h*sizeof(uint8));
-			for (uint32 i = 0; i < w; i++) {
-				if (g_Keyboard.IsKeyDown(i, Keyboard::MODIFIER_ANY))
-					keyboardInputData[i + 0*w] = 255;
-				if (g_Keyboard.IsKeyPressed(i, Keyboard::MODIFIER_ANY))
-					keyboardInputData[i + 1*w] = 255;
-				if (keyToggled[i>>3] & BIT(i&7))
-					keyboardInputData[i + 2*w] = 255;
-			}
-			const TextureFormatInfo info(DDS_DXGI_FORMAT_R8_UNORM);
-			glBindTexture(GL_TEXTURE_2D, m_textureID);
-			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, w, h, info.m_format, info.m_type, keyboardInputData);
-			glBindTexture(GL_TEXTURE_2D, 0);
-		} else if (m_desc.m_name == std::string("[KEYBOARD2]")) {
-			const uint32 w = KEYBOARD2_INPUT_TEXTURE_WIDTH;
-			const uint32 h = KEYBOARD2_INPUT_TEXTURE_HEIGHT;
-			static uint32* keyboardInputData = nullptr;
-			if (keyboardInputData == nullptr) {
-				keyboardInputData = new uint32[w*h];
-				memset(keyboardInputData, 0, w*h*sizeof(uint32));
-			}
-			for (uint32 i = 0; i < w; i++) {
-				for (uint32 modifiers = 0; modifiers < 8; modifiers++) {
-					StaticAssert(BIT(0) == Keyboard::MODIFIER_SHIFT); // make sure Keyboard::MODIFIERS matches the layout here
-					StaticAssert(BIT(1) == Keyboard::MODIFIER_CONTROL);
-					StaticAssert(BIT(2) == Keyboard::MODIFIER_ALT);
-					if (g_Keyboard.IsKeyPressed(i, modifiers))
-						keyboardInputData[i + (KEYBOARD2_ROW_COUNTER_NO_MODIFIERS + modifiers)*w]++;
-				}
-				uint32 state = KEYBOARD2_STATE_UP;
-				if (g_Keyboard.IsKeyPressed(i, Keyboard::MODIFIER_ANY)) {
-					keyboardInputData[i + KEYBOARD2_ROW_COUNTER_ANY_MODIFIERS*w]++;
-					state = KEYBOARD2_STATE_PRESSED;
-				} else if (g_Keyboard.IsKeyReleased(i))
-					state = KEYBOARD2_STATE_RELEASED;
-				else if (g_Keyboard.IsKeyDown(i, Keyboard::MODIFIER_ANY))
-					state = KEYBOARD2_STATE_DOWN;
-				keyboardInputData[i + KEYBOARD2_ROW_STATE*w] = state;
-			}
-			const TextureFormatInfo info(DDS_DXGI_FORMAT_R32_UINT);
-			glBindTexture(GL_TEXTURE_2D, m_textureID);
-			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, w, h, info.m_format, info.m_type, keyboardInputData);
-			glBindTexture(GL_TEXTURE_2D, 0);
-		}
-	}
-
-	static void UpdateAll()
-	{
-		std::map<std::string,ShaderToyBuffer*>& m = GetMap();
-		for (auto it = m.begin(); it != m.end(); ++it)
-			it->second->Update();
-	}
-
-	static std::map<std::string,ShaderToyBuffer*>& GetMap()
-	{
-		static std::map<std::string,ShaderToyBuffer*> m;
-		return m;
-	}
-
-	static ShaderToyBuffer* Find(const char* name)
-	{
-		std::map<std::string,ShaderToyBuffer*>& m = GetMap();
-		const auto f = m.find(name);
-		if (f != m.end())
-			return f->second;
-		else
-			return nullptr;
-	}
-
-	Desc m_desc;
-	uint32 m_res[3];
-	uint32 m_mipLevels; // actual mip levels
-	GLuint m_textureID;
-	GLenum m_target;
-};
-
-class ShaderToyRenderPass
-{
-public:
-	enum
-	{
-		MAX_INPUTS = SHADERTOY_MAX_INPUT_CHANNELS,
-		MAX_IMAGES = 8,
-		MAX_PASSES = 256,
-	};
-
-	class PassInput
-	{
-	public:
-		PassInput() : m_buffer(nullptr) {}
-		ShaderToyBuffer* m_buffer;
-	};
-
-	class PassOutput
-	{
-	public:
-		PassOutput() : m_buffer(nullptr), m_layerOrSliceIndex(0), m_mipIndex(0) {}
-		ShaderToyBuffer* m_buffer;
-		uint32 m_layerOrSliceIndex;
-		uint32 m_mipIndex;
-	};
-
-#if SUPPORT_IMAGES
-	class PassImage
-	{
-	public:
-		PassImage() : m_buffer(nullptr), m_layered(false), m_layerOrSliceIndex(0), m_mipIndex(0), m_access(GL_NONE), m_internalFormat(GL_NONE) {}
-		std::string m_name;
-		ShaderToyBuffer* m_buffer;
-		bool m_layered; // if true, ignore m_layerOrSliceIndex and bind the entire mip level as an array or 3D
-		uint32 m_layerOrSliceIndex;
-		uint32 m_mipIndex;
-		GLenum m_access;
-		GLenum m_internalFormat;
-	};
-#endif // SUPPORT_IMAGES
-
-	ShaderToyRenderPass(uint32 passIndex, GLuint programID)
-		: m_passIndex(passIndex)
-		, m_programID(programID)
-		, m_outputFramebufferID(0)
-	{}
-
-	void AddBuffer(char* s)
-	{
-		SkipLeadingWhitespace(s);
-		if (*s++ == ':') {
-			char* trailingComment = strstr(s, "//");
-			if (trailingComment)
-				*trailingComment = '\0';
-			const NameValuePairs nvp(s);
-			const char* name = GetName(&nvp);
-			if (name)
-				ShaderToyBuffer::Add(m_passIndex, name, &nvp);
-			else
-				printf("error: pass %u buffer description expected to start with name!\n", m_passIndex);
-		} else
-			printf("error: pass %u buffer not processed, missing ':'!\n", m_passIndex);
-	}
-
-	void AddInput(char* s)
-	{
-		// for ShaderToy support, we need to allow for specified input indices (maybe .. i dunno .. don't want to think about it too much)
-		// for sanity's sake, please declare inputs with specified indices FIRST, before any inputs with unspecified indices
-		const bool allowSpecificInputIndex = true;
-		uint32 inputIndex = 0;
-		if (allowSpecificInputIndex) {
-			if (isdigit(*s)) {
-				inputIndex = (uint32)atoi(s);
-				while (isdigit(*s))
-					s++;
-				if (inputIndex >= m_inputs.size())
-					m_inputs.resize(inputIndex + 1);
-				else if (m_inputs[inputIndex].m_buffer) {
-					printf("error: pass %u input specified index %u, but this input is already bound to a buffer!\n", m_passIndex, inputIndex);
-					return;
-				}
-			} else { // unspecified input index - find the first one available
-				inputIndex = (uint32)m_inputs.size();
-				for (uint32 i = 0; i < m_inputs.size(); i++) {
-					if (m_inputs[i].m_buffer == nullptr) {
-						inputIndex = i;
-						break;
-					}
-				}
-				if (inputIndex == m_inputs.size())
-					m_inputs.resize(inputIndex + 1);
-			}
-		} else {
-			while (isdigit(*s))
-				s++;
-		}
-		SkipLeadingWhitespace(s);
-		if (*s++ == ':') {
-			char* trailingComment = strstr(s, "//");
-			if (trailingComment)
-				*trailingComment = '\0';
-			const NameValuePairs nvp(s);
-			const char* name = GetName(&nvp);
-			if (name) {
-				if (ShaderToyBuffer::Find(name) == nullptr && nvp.size() <= 1 && name[0] != '[')
-					printf("warning: pass %u input buffer (\"%s\") has not been defined yet!\n", m_passIndex, name);
-				if (allowSpecificInputIndex)
-					m_inputs[inputIndex].m_buffer = ShaderToyBuffer::Add(m_passIndex, name, &nvp);
-				else {
-					m_inputs.resize(m_inputs.size() + 1);
-					m_inputs.back().m_buffer = ShaderToyBuffer::Add(m_passIndex, name, &nvp);
-				}
-			} else
-				printf("error: pass %u input description expected to start with name!\n", m_passIndex);
-		} else
-			printf("error: pass %u input not processed, missing ':'!\n", m_passIndex);
-	}
-
-	void AddOutput(char* s)
-	{
-		uint32 outputIndex = 0;
-		if (isdigit(*s)) {
-			outputIndex = (uint32)atoi(s);
-			while (isdigit(*s))
-				s++;
-		}
-		static uint32 maxDrawBuffers = 0;
-		if (maxDrawBuffers == 0)  {
-			uint32 maxColorAttachments = 0;
-			glGetIntegerv(GL_MAX_COLOR_ATTACHMENTS, (GLint*)&maxColorAttachments);
-			printf("GL_MAX_COLOR_ATTACHMENTS = %u\n", maxColorAttachments);
-			glGetIntegerv(GL_MAX_DRAW_BUFFERS, (GLint*)&maxDrawBuffers);
-			printf("GL_MAX_DRAW_BUFFERS = %u\n", maxDrawBuffers);
-		}
-		if (outputIndex < maxDrawBuffers) {
-			SkipLeadingWhitespace(s);
-			if (*s++ == ':') {
-				if (m_outputs.size() < outputIndex + 1)
-					m_outputs.resize(outputIndex + 1);
-				PassOutput& output = m_outputs[outputIndex];
-				if (output.m_buffer == nullptr) {
-					char* trailingComment = strstr(s, "//");
-					if (trailingComment)
-						*trailingComment = '\0';
-					const NameValuePairs nvp(s);
-					const char* name = GetName(&nvp);
-					if (name) {
-						output.m_buffer = ShaderToyBuffer::Add(m_passIndex, name, &nvp);
-						output.m_layerOrSliceIndex = nvp.GetUIntValue("layer");
-						output.m_mipIndex = nvp.GetUIntValue("mip");
-					} else
-						printf("error: pass %u output %u description expected to start with name!\n", m_passIndex, outputIndex);
-				} else
-					printf("error: pass %u output %u already bound to a buffer!\n", m_passIndex, outputIndex);
-			} else
-				printf("error: pass %u output %u not processed, missing ':'!\n", m_passIndex, outputIndex);
-		} else
-			printf("error: pass %u output %u not processed, max output index is %u!\n", m_passIndex, outputIndex, maxDrawBuffers - 1);
-	}
-
-#if SUPPORT_IMAGES
-	void AddImage(char* s)
-	{
-		SkipLeadingWhitespace(s);
-		if (*s++ == ':') {
-			char* trailingComment = strstr(s, "//");
-			if (trailingComment)
-				*trailingComment = '\0';
-			const NameValuePairs nvp(s);
-			const char* name = GetName(&nvp);
-			if (name) {
-				const char* bufferName = nvp.GetStringValue("buffer", name);
-				if (ShaderToyBuffer::Find(bufferName) == nullptr && nvp.size() <= 1 && bufferName[0] != '[')
-					printf("warning: pass %u image buffer (\"%s\") has not been defined yet!\n", m_passIndex, bufferName);
-				ShaderToyBuffer* buffer = ShaderToyBuffer::Add(m_passIndex, bufferName, &nvp);
-				m_images.resize(m_images.size() + 1);
-				PassImage& image = m_images.back();
-				image.m_name = name;
-				image.m_buffer = buffer;
-				image.m_layered = nvp.GetBoolValue("layered");
-				image.m_layerOrSliceIndex = nvp.GetUIntValue("layer");
-				image.m_mipIndex = nvp.GetUIntValue("mip");
-				if (nvp.HasValue("read") || nvp.HasValue("write")) {
-					const bool readAccess = nvp.GetBoolValue("read");
-					const bool writeAccess = nvp.GetBoolValue("write");
-					if (readAccess && writeAccess)
-						image.m_access = GL_READ_WRITE;
-					else if (readAccess)
-						image.m_access = GL_READ_ONLY;
-					else if (writeAccess)
-						image.m_access = GL_WRITE_ONLY;
-				} else
-					image.m_access = GL_READ_WRITE; // default
-				image.m_internalFormat = TextureFormatInfo(buffer->m_desc.m_format).m_internalFormat;
-			} else
-				printf("error: pass %u image description expected to start with name!\n", m_passIndex);
-		} else
-			printf("error: pass %u image not processed, missing ':'!\n", m_passIndex);
-	}
-#endif // SUPPORT_IMAGES
-
-	class PassRef
-	{
-	public:
-		PassRef(const char* path, float data = 0.0f) : m_path(path), m_data(data) {}
-		std::string m_path;
-		float m_data;
-	};
-
-	static ShaderToyRenderPass* LoadPass(
-		uint32 passIndex,
-		const PassRef& ref,
-		GLuint commonVertexShaderID,
-		const std::vector<std::string>& sourceHeader)
-	{
-		const char* path = ref.m_path.c_str();
-		printf("loading pass \"%s\" ..\n", path);
-	#if USE_GUI
-		GUISlider::SetCurrentPassIndexForShaderLoad(passIndex);
-	#endif // USE_GUI
-		ShaderToyRenderPass* pass = nullptr;
-		FILE* file = fopen(path, "r");
-		if (file) {
-			pass = new ShaderToyRenderPass(passIndex, 0);
-
-			// process metadata
-			char line[SHADER_CODE_MAX_LINE_SIZE];
-			while (rage_fgetline(line, sizeof(line), file)) {
-				const std::string lineCopy = line;
-				char* s = line;
-				SkipLeadingWhitespace(s);
-				if (!if_strskip(s, "//"))
-					continue;
-				SkipLeadingWhitespace(s);
-				if      (if_strskip(s, "$BUFFER")) pass->AddBuffer(s);
-				else if (if_strskip(s, "$INPUT" )) pass->AddInput(s);
-				else if (if_strskip(s, "$OUTPUT")) pass->AddOutput(s);
-			#if SUPPORT_IMAGES
-				else if (if_strskip(s, "$IMAGE" )) pass->AddImage(s);					
-			#endif // SUPPORT_IMAGES
-			}
-			std::vector<std::string> sourceHeaderPlusInputSamplers;
-			sourceHeaderPlusInputSamplers.push_back("");
-			sourceHeaderPlusInputSamplers.push_back("//<=== BEGIN SAMPLERS ===>");
-			for (uint32 inputIndex = 0; inputIndex < pass->m_inputs.size(); inputIndex++) {
-				const PassInput& input = pass->m_inputs[inputIndex];
-				const ShaderToyBuffer* buffer = input.m_buffer;
-				if (buffer) {
-					const std::string samplerTypeStr = GetOpenGLSamplerTypeStr(buffer->m_target, buffer->m_desc.m_format);
-					char channelName[256];
-					strcpy(channelName, buffer->m_desc.m_name.c_str());
-					for (char* s1 = channelName; *s1; s1++) {
-						if (!isalnum(*s1))
-							*s1 = '_';
-					}
-					sourceHeaderPlusInputSamplers.push_back(varString("uniform %s iChannel%u;", samplerTypeStr.c_str(), inputIndex));
-					sourceHeaderPlusInputSamplers.push_back(varString("#define %s iChannel%u", channelName, inputIndex));
-				}
-			}
-		#if SUPPORT_IMAGES
-			for (uint32 imageIndex = 0; imageIndex < pass->m_images.size(); imageIndex++) {
-				const PassImage& image = pass->m_images[imageIndex];
-				const ShaderToyBuffer* buffer = image.m_buffer;
-				if (buffer) {
-					const bool isShadow = false;
-					const bool isImage = true;
-					const std::string samplerTypeStr = GetOpenGLSamplerTypeStr(buffer->m_target, buffer->m_desc.m_format, isShadow, isImage, image.m_layered);
-					char imageName[256];
-					strcpy(imageName, image.m_name.c_str());
-					for (char* s1 = imageName; *s1; s1++) {
-						if (!isalnum(*s1))
-							*s1 = '_';
-					}
-					sourceHeaderPlusInputSamplers.push_back(varString("layout(binding=%u,%s) uniform %s iImageChannel%u;", imageIndex, TextureFormatInfo(buffer->m_desc.m_format).m_formatQualifier, samplerTypeStr.c_str(), imageIndex));
-					sourceHeaderPlusInputSamplers.push_back(varString("#define %s_IMAGE iImageChannel%u", imageName, imageIndex));
-				}
-			}
-		#endif // SUPPORT_IMAGES
-			sourceHeaderPlusInputSamplers.push_back("//<=== END SAMPLERS ===>");
-			sourceHeaderPlusInputSamplers.push_back("");
-			for (uint32 i = 0; i < sourceHeader.size(); i++)
-				sourceHeaderPlusInputSamplers.push_back(sourceHeader[i]);
-
-			const bool alwaysEmit4ComponentVector = true; // pretty sure compiler will optimize out any unused components .. but you can change this if you want
-			std::vector<std::string> sourceFooter; // this links the shadertoy main function (mainImage) to the GLSL main function
-			std::string params = "";
-			sourceFooter.push_back("");
-			sourceFooter.push_back("//<=== BEGIN FOOTER ===>");
-			if (pass->m_outputs.size() > 0) {
-				for (uint32 i = 0; i < pass->m_outputs.size(); i++) {
-					const ShaderToyBuffer* buffer = pass->m_outputs[i].m_buffer;
-					if (buffer) {
-						char layoutStr[64] = "";
-						const char* typeStr = TextureFormatInfo(buffer->m_desc.m_format).m_formatType;
-						if (alwaysEmit4ComponentVector) {
-							if (strcmp(typeStr, "float") == 0 ||
-								strcmp(typeStr, "vec2") == 0 ||
-								strcmp(typeStr, "vec3") == 0)
-								typeStr = "vec4";
-							if (strcmp(typeStr, "int") == 0 ||
-								strcmp(typeStr, "ivec2") == 0 ||
-								strcmp(typeStr, "ivec3") == 0)
-								typeStr = "ivec4";
-							if (strcmp(typeStr, "uint") == 0 ||
-								strcmp(typeStr, "uvec2") == 0 ||
-								strcmp(typeStr, "uvec3") == 0)
-								typeStr = "uvec4";
-						}
-						char paramName[64] = "fragOut";
-						if (pass->m_outputs.size() > 1) {
-							sprintf(layoutStr, "layout(location=%u) ", i);
-							strcatf(paramName, "%u", i);
-						}
-						params += varString("%s%s", params.empty() ? "" : ", ", paramName);
-						sourceFooter.push_back(varString("%sout %s %s;", layoutStr, typeStr, paramName));
-					}
-				}
-			} else {
-				const char* typeStr = "vec4";
-				const char paramName[64] = "fragOut";
-				params = paramName;
-				sourceFooter.push_back(varString("out %s %s;", typeStr, paramName));
-			}
-			sourceFooter.push_back("");
-			sourceFooter.push_back("void main()");
-			sourceFooter.push_back("{");
-			sourceFooter.push_back(varString("\tmainImage(%s, gl_FragCoord.xy);", params.c_str()));
-			sourceFooter.push_back("}");
-			sourceFooter.push_back("//<=== END FOOTER ===>");
-			pass->m_programID = LoadShaderProgram(path, commonVertexShaderID, &sourceHeaderPlusInputSamplers, &sourceFooter);
-			if (pass->m_programID != 0)
-				GetPasses().push_back(pass);
-			else {
-				delete pass;
-				pass = nullptr;
-			}
-			fclose(file);
-		}
-		return pass;
-	}
-
-	static void LoadShaders(const char* dir = "shaders")
-	{
-		// this includes all the shadertoy uniforms as well as the common file
-		std::vector<std::string> sourceHeader;
-		sourceHeader.push_back("//<=== BEGIN HEADER ===>");
-		LoadFileIntoStrings(sourceHeader, "shaders_common\\shadertoy_common.h");
-		LoadFileIntoStrings(sourceHeader, "shaders_common\\shadertoy_common.glsl");
-	#if USE_GUI
-		if (g_GUIEnabled) {
-			sourceHeader.push_back("#define SLIDER_VAR(type,name,init,rangemin,rangemax) uniform type name = type(init)\n");
-			sourceHeader.push_back("#define SLIDER_CHANGED g_GUISliderChanged\n");
-			sourceHeader.push_back("uniform bool g_GUISliderChanged = false;\n");
-		}
-	#endif // USE_GUI
-		sourceHeader.push_back("//<=== END HEADER ===>");
-		sourceHeader.push_back("");
-		sourceHeader.push_back("//<=== BEGIN COMMON ===>");
-		std::vector<PassRef> passRefs;
-		const uint32 firstLineIndex = (uint32)sourceHeader.size();
-		const varString commonPath("%s\\COMMON.glsl", dir);
-		LoadFileIntoStrings(sourceHeader, commonPath);
-		for (uint32 i = firstLineIndex; i < sourceHeader.size(); i++) { // add buffers specified in common ..
-			char temp[SHADER_CODE_MAX_LINE_SIZE];
-			strcpy(temp, sourceHeader[i].c_str());
-			char* s = temp;
-			SkipLeadingWhitespace(s);
-			if (!if_strskip(s, "//"))
-				continue;
-			SkipLeadingWhitespace(s);
-			if (if_strskip(s, "$BUFFER")) {
-				SkipLeadingWhitespace(s);
-				if (*s++ == ':') {
-					char* trailingComment = strstr(s, "//");
-					if (trailingComment)
-						*trailingComment = '\0';
-					const NameValuePairs nvp(s);
-					const char* name = GetName(&nvp);
-					if (name)
-						ShaderToyBuffer::Add(-1, name, &nvp);
-					else
-						printf("error: buffer description expected to start with name!\n");
-				} else
-					printf("error: buffer not processed, missing ':'!\n");
-			} else if (if_strskip(s, "$PASS")) {
-				SkipLeadingWhitespace(s);
-				if (*s++ == ':') {
-					char* trailingComment = strstr(s, "//");
-					if (trailingComment)
-						*trailingComment = '\0';
-					const NameValuePairs nvp(s);
-					const char* name = GetName(&nvp);
-					if (name) {
-						const float data = nvp.GetFloatValue("data");
-						passRefs.push_back(PassRef(varString("%s\\%s", dir, name).c_str(), data));
-					} else
-						printf("error: pass description expected to start with path!\n");
-				} else
-					printf("error: pass not processed, missing ':'!\n");
-			}
-		}
-	#if USE_GUI
-		if (g_GUIEnabled) {
-			GUISlider::SetCurrentPassIndexForShaderLoad(-1);
-			for (uint32 i = firstLineIndex; i < sourceHeader.size(); i++)
-				GUISlider::AddSlider(commonPath, i - firstLineIndex, sourceHeader[i].c_str());
-		}
-	#endif // USE_GUI
-		sourceHeader.push_back("//<=== END COMMON ===>");
-		sourceHeader.push_back("");
-
-		if (passRefs.size() == 0) { // no passes specified in COMMON.glsl .. try hardcoded "PASS_0.glsl", "PASS_1.glsl", etc.
-			for (uint32 passIndex = 0; passIndex < MAX_PASSES; passIndex++) {
-				const varString path("%s\\PASS_%u.glsl", dir, passIndex);
-				if (FileExists(path.c_str()))
-					passRefs.push_back(PassRef(path.c_str()));
-				else
-					break;
-			}
-		}
-		// ==================================================================================================
-		// TODO -- LoadPass should not store the pass - it should store the *reference* to the pass and only
-		// load (and store) the pass if the path is unique. we want to be able to handle multiple refs to the
-		// same pass in memory, each ref has its own 'data'
-		// ==================================================================================================
-		GLuint commonVertexShaderID = 0;
-		LoadShader(commonVertexShaderID, "shaders_common\\shadertoy_vertex.glsl", nullptr, GL_VERTEX_SHADER, VERTEX_SHADER_VERSION_STR);
-		for (uint32 passIndex = 0; passIndex < passRefs.size(); passIndex++) {
-			const ShaderToyRenderPass* pass = LoadPass(passIndex, passRefs[passIndex], commonVertexShaderID, sourceHeader);
-			if (pass)
-				printf("loaded pass \"%s\"\n", passRefs[passIndex].m_path.c_str());
-			else
-				printf("failed to load pass \"%s\"!\n", passRefs[passIndex].m_path.c_str());
-		}
-
-		if (0) { // dump pass info
-			std::vector<ShaderToyRenderPass*>& passes = GetPasses();
-			for (uint32 i = 0; i < passes.size(); i++) {
-				const ShaderToyRenderPass* pass = passes[i];
-				printf("\n");
-				for (uint32 j = 0; j < pass->m_inputs.size(); j++) {
-					const ShaderToyRenderPass::PassInput& input = pass->m_inputs[j];
-					if (input.m_buffer)
-						printf("PASS_%u - INPUT%u: %s\n", i, j, input.m_buffer->m_desc.m_name.c_str());
-				}
-				for (uint32 j = 0; j < pass->m_outputs.size(); j++) {
-					const ShaderToyRenderPass::PassOutput& output = pass->m_outputs[j];
-					if (output.m_buffer)
-						printf("PASS_%u - OUTPUT%u: %s (layer=%u)\n", i, j, output.m_buffer->m_desc.m_name.c_str(), output.m_layerOrSliceIndex);
-				}
-			}
-		}
-	}
-
-	static uint32 GetResolution(float res, uint32 resViewport)
-	{
-		if (res > 0.0f) // explicit resolution
-			return (uint32)Ceiling(res);
-		else if (res < 0.0f) // proportional to viewport
-			return (uint32)Ceiling(-res*(float)resViewport);
-		else // viewport
-			return resViewport;
-	}
-	
-	void Render()
-	{
-		if (m_programID != 0) {
-		#if SUPPORT_IMAGES
-			bool needsImageBarrier = false;
-		#endif // SUPPORT_IMAGES
-			glUseProgram(m_programID);
-			if (m_outputs.size() > 0) {
-				if (m_outputFramebufferID == 0) {
-					glGenFramebuffers(1, &m_outputFramebufferID);
-					glBindFramebuffer(GL_FRAMEBUFFER, m_outputFramebufferID);
-					std::vector<GLenum> attachments(m_outputs.size());
-					for (uint32 i = 0; i < m_outputs.size(); i++) {
-						const PassOutput& output = m_outputs[i];
-						attachments[i] = GL_COLOR_ATTACHMENT0 + i;
-						if (output.m_buffer) {
-							if (output.m_buffer->m_target == GL_TEXTURE_2D_ARRAY ||
-								output.m_buffer->m_target == GL_TEXTURE_2D_MULTISAMPLE_ARRAY ||
-								output.m_buffer->m_target == GL_TEXTURE_CUBE_MAP ||
-								output.m_buffer->m_target == GL_TEXTURE_CUBE_MAP_ARRAY ||
-								output.m_buffer->m_target == GL_TEXTURE_3D)
-								glFramebufferTextureLayer(GL_FRAMEBUFFER, attachments[i], output.m_buffer->m_textureID, output.m_mipIndex, output.m_layerOrSliceIndex);
-							else
-								glFramebufferTexture(GL_FRAMEBUFFER, attachments[i], output.m_buffer->m_textureID, output.m_mipIndex);
-						} else
-							glFramebufferTexture(GL_FRAMEBUFFER, attachments[i], 0, 0);
-					}
-					glDrawBuffers((GLsizei)m_outputs.size(), attachments.data());
-				} else
-					glBindFramebuffer(GL_FRAMEBUFFER, m_outputFramebufferID);
-				glViewport(0, 0, m_outputs[0].m_buffer->m_res[0], m_outputs[0].m_buffer->m_res[1]);
-			} else {
-				glBindFramebuffer(GL_FRAMEBUFFER, 0);
-				glViewport(0, 0, g_ViewportWidth, g_ViewportHeight);
-			}
-			const float pixelAspect = 1.0f;
-			const Vec3f viewportRes((float)g_ViewportWidth, (float)g_ViewportHeight, pixelAspect);
-			const Vec3f outputRes = m_outputs.size() > 0 ? Vec3f((float)m_outputs[0].m_buffer->m_res[0], (float)m_outputs[0].m_buffer->m_res[1], (float)m_outputs[0].m_buffer->m_res[2]) : viewportRes;
-			Vec3f channelRes[MAX_INPUTS];
-			memset(channelRes, 0, MAX_INPUTS*sizeof(Vec3f));
-			for (uint32 inputIndex = 0; inputIndex < m_inputs.size(); inputIndex++) {
-				const PassInput& input = m_inputs[inputIndex];
-				const ShaderToyBuffer* buffer = input.m_buffer;
-				if (buffer) {
-					BindTextureTarget(m_programID, buffer->m_textureID, buffer->m_target, inputIndex, varString("iChannel%u", inputIndex));
-					const uint32 numLayersOrSlices = buffer->m_desc.m_resolutionZ > 1 ? buffer->m_res[2] : buffer->m_desc.m_numLayers;
-					channelRes[inputIndex] = Vec3f((float)buffer->m_res[0], (float)buffer->m_res[1], numLayersOrSlices > 1 ? (float)numLayersOrSlices : pixelAspect);
-				}
-			}
-		#if SUPPORT_IMAGES
-			for (uint32 imageIndex = 0; imageIndex < m_images.size(); imageIndex++) {
-				const PassImage& image = m_images[imageIndex];
-				const ShaderToyBuffer* buffer = image.m_buffer;
-				if (buffer) {
-					glBindImageTexture(imageIndex, buffer->m_textureID, image.m_mipIndex, image.m_layered ? GL_TRUE : GL_FALSE, image.m_layerOrSliceIndex, image.m_access, image.m_internalFormat);
-					if (image.m_access == GL_WRITE_ONLY ||
-						image.m_access == GL_READ_WRITE)
-						needsImageBarrier = true;
-				}
-			}
-		#endif // SUPPORT_IMAGES
-			// TODO -- if this block becomes large, consider changing to a single uniform buffer that can be bound to all shaders
-			glUniform3fv(glGetUniformLocation(m_programID, "iResolution"), 1, (const GLfloat*)&viewportRes);
-			glUniform3fv(glGetUniformLocation(m_programID, "iOutputResolution"), 1, (const GLfloat*)&outputRes);
-			glUniform3fv(glGetUniformLocation(m_programID, "iChannelResolution"), MAX_INPUTS, (const GLfloat*)channelRes);
-			glUniform1f(glGetUniformLocation(m_programID, "iTime"), g_Time); 
-			glUniform1f(glGetUniformLocation(m_programID, "iTimeDelta"), g_TimeDelta);
-			glUniform1i(glGetUniformLocation(m_programID, "iFrame"), (int)g_Frame);
-			glUniform1f(glGetUniformLocation(m_programID, "iFrameRate"), 60.0f); // whatev.
-			glUniform4f(glGetUniformLocation(m_programID, "iMouse"), (float)g_MouseDragCurr[0], (float)g_MouseDragCurr[1], (float)g_MouseDragStart[0], (float)g_MouseDragStart[1]);
-		#if USE_GUI
-			GUISlider::SetUniformsForPass(m_passIndex, m_programID);
-		#endif // USE_GUI
-			glBegin(GL_QUADS);
-			glVertex2f(-1.0f, -1.0f);
-			glVertex2f(+1.0f, -1.0f);
-			glVertex2f(+1.0f, +1.0f);
-			glVertex2f(-1.0f, +1.0f);
-			glEnd();
-		#if SUPPORT_IMAGES
-			// TODO -- memory barrier only when needed (i.e. when about to access a buffer via texture or image(read) sampler which was potentially written to earlier)
-			if (needsImageBarrier)
-				glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
-		#endif // SUPPORT_IMAGES
-		}
-	}
-
-	static void RenderAll()
-	{
-		std::vector<ShaderToyRenderPass*>& passes = GetPasses();
-		ShaderToyBuffer::UpdateAll();
-		for (uint32 i = 0; i < passes.size(); i++)
-			passes[i]->Render();
-		glBindFramebuffer(GL_FRAMEBUFFER, 0); // restore
-		glUseProgram(0); // restore
-	#if USE_GUI
-		g_GUISliderChanged = false;
-	#endif // USE_GUI
-	}
-
-	static std::vector<ShaderToyRenderPass*>& GetPasses()
-	{
-		static std::vector<ShaderToyRenderPass*> passes;
-		return passes;
-	}
-
-	uint32 m_passIndex;
-	GLuint m_programID;
-	std::vector<PassInput> m_inputs;
-	std::vector<PassOutput> m_outputs; // multiple outputs for MRT
-#if SUPPORT_IMAGES
-	std::vector<PassImage> m_images;
-#endif // SUPPORT_IMAGES
-	GLuint m_outputFramebufferID;
-};
-
-static void DisplayFunc()
-{
-	g_Keyboard.Update();
-#if USE_GUI
-	if (g_GUIFrame)
-		GUI::Idle(&g_Keyboard);
-#endif // USE_GUI
-
-	static bool once = true;
-	if (once) {
-		once = false;
-		ShaderToyRenderPass::LoadShaders(g_ShadersDir.c_str());
-	}
-	UpdateFrameTime();
-	glViewport(0, 0, g_ViewportWidth, g_ViewportHeight);
-	glDisable(GL_BLEND);
-	ShaderToyRenderPass::RenderAll();
-
-#if USE_GUI
-	if (g_GUIFrame) {
-		GUI::RenderBegin(0, 0, g_ViewportWidth, g_ViewportHeight);
-		GUI::RenderWindow();
-	}
-#endif // USE_GUI
-
-	g_Frame++;
-	glutSwapBuffers();
-	glutPostRedisplay();
-}
-
-static void MouseFunc(int button, int state, int x, int y)
-{
-	if (g_GUIFrame && GUI::MouseButton(button, state, x, y, g_Keyboard.GetModifiers()))
-		return;
-
-	g_MouseWheelState = 0;
-	int buttonID = -1;
-	switch (button) {
-	case GLUT_LEFT_BUTTON: buttonID = 0; break;
-	case GLUT_RIGHT_BUTTON: buttonID = 1; break;
-	case GLUT_MIDDLE_BUTTON: buttonID = 2; break;
-	}
-	if (state == GLUT_DOWN) {
-		if (button == 3)
-			g_MouseWheelState = +1;
-		else if (button == 4)
-			g_MouseWheelState = -1;
-		else if (buttonID != -1)
-			g_MouseButtonState[buttonID] = true;
-	} else if (state == GLUT_UP) {
-		if (buttonID != -1)
-			g_MouseButtonState[buttonID] = false;
-	}
-
-	x = Clamp(x, 0, g_ViewportWidth - 1);
-	y = Clamp(g_ViewportHeight - 1 - y, 0, g_ViewportHeight - 1);
-	if (g_MouseButtonState[0]) {
-		if (button == GLUT_LEFT_BUTTON && state == GLUT_DOWN) {
-			g_MouseDragStart[0] = x;
-			g_MouseDragStart[1] = y;
-		}
-		g_MouseDragCurr[0] = x;
-		g_MouseDragCurr[1] = y;
-	} else {
-		g_MouseDragStart[0] = 0;
-		g_MouseDragStart[1] = 0;
-	}
-}
-
-static void MotionFunc(int x, int y)
-{
-	if (g_GUIFrame && GUI::MouseMotion(x, y))
-		return;
-
-	if (g_MouseButtonState[0]) {
-		g_MouseDragCurr[0] = x;
-		g_MouseDragCurr[1] = g_ViewportHeight - 1 - y;
-	}
-}
-
-static void VisibilityFunc(int vis)
-{
-}
-
-static void SaveStandardTextures()
-{
-	// noise
-	{
-		uint32 w = 256;
-		uint32 h = 256;
-		Vec4V* image = new Vec4V[w*h];
-		for (uint32 i = 0; i < w*h; i++) {
-			image[i].xf_ref() = GetRandomValue();
-			image[i].yf_ref() = GetRandomValue();
-			image[i].zf_ref() = GetRandomValue();
-			image[i].wf_ref() = GetRandomValue();
-		}
-		SaveImage("textures\\RGBA_NOISE_MEDIUM.tga", image, w, h);
-		delete[] image;
-	}
-
-	// permutation
-	{
-		typedef uint16 PixelType;
-		const uint32 n = 2048;
-		PixelType* image = new PixelType[n*n];
-		memset(image, 0, n*n*sizeof(PixelType));
-		for (uint32 j = 0; j < n; j++) {
-			std::vector<PixelType> x(j + 1);
-			for (uint32 i = 0; i <= j; i++)
-				x[i] = (PixelType)i;
-			std::random_shuffle (x.begin(), x.end());
-			memcpy(image + j*n, x.data(), (j + 1)*sizeof(PixelType));
-		}
-		SaveImage("textures\\PERMUTATION.dds", image, n, n, false, true); // save native R16_UNORM
-		delete[] image;
-	}
-}
-
-int main(int argc, const char* argv[])
-{
-	//SaveStandardTextures();
-
-	StartupMain(argc, argv);
-	if (argc > 1)
-		g_ShadersDir = argv[1];
-
-	glutInit(&argc, (char**)argv);
-	glutInitDisplayMode(GLUT_DOUBLE | GLUT_ALPHA);
-	glutInitWindowSize(g_ViewportWidth, g_ViewportHeight);
-	glutCreateWindow(argv[0]);
-	glutReshapeFunc(ReshapeFunc);
-	glutDisplayFunc(DisplayFunc);
-	glutMouseFunc(MouseFunc);
-	glutMotionFunc(MotionFunc);
-	glutPassiveMotionFunc(MotionFunc);
-	glutVisibilityFunc(VisibilityFunc);
-
-	const GLubyte* versionStr = glGetString(GL_VERSION);
-	fprintf(stdout, "OpenGL version: %s\n", versionStr);
-#if FREEGLUT_INCLUDE_GLEW_2_1_0
-	const GLenum err = glewInit();
-	if (err == GLEW_OK) {
-		fprintf(stdout, "glewInit: Status OK - using GLEW_VERSION %s\n", glewGetString(GLEW_VERSION));
-		if (GLEW_VERSION_4_4) {
-			// ok
-		} else {
-			fprintf(stderr, "OpenGL version 4.4 required, but not present ..\n");
-			system("pause");
-			exit(-1);
-		}
-	} else {
-		fprintf(stderr, "glewInit error: %s\n", glewGetErrorString(err));
-		system("pause");
-		exit(-1);
-	}
-#endif // FREEGLUT_INCLUDE_GLEW_2_1_0
-
-	if (glewIsSupported("GL_NV_gpu_shader5") &&
-		glewIsSupported("GL_NV_bindless_texture")) {
-		printf("GPU Shader 5 support enabled\n");
-		g_GPUShader5 = true;
-	} else {
-		printf("GPU Shader 5 support not enabled\n");
-		// ===================================================================================
-		// TODO -- this code is ineffective - the ReshapeFunc callback gets invoked as soon as
-		// glutMainLoop is entered, and the width and height get reset according to the
-		// call to glutInitWindowSize above. not sure how to fix this cleanly without hacking
-		// the ReshapeFunc callback, so that's what i did.
-		// ===================================================================================
-		//g_ViewportWidth /= 2;
-		//g_ViewportHeight /= 2;
-		//glutInitWindowSize(g_ViewportWidth, g_ViewportHeight);
-		//glutReshapeWindow(g_ViewportWidth, g_ViewportHeight);
-	}
-
-#if 1
-	// https://www.khronos.org/opengl/wiki/OpenGL_Error
-	class OpenGLDebugMessageCallback { public: static void GLAPIENTRY func(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message, const void* userParam) {
-		if (severity != GL_DEBUG_SEVERITY_NOTIFICATION &&
-			severity != GL_DEBUG_SEVERITY_LOW) {
-			const char* sourceStr = "?";
-			switch (source) {
-			case GL_DEBUG_SOURCE_API:             sourceStr = "API";             break;
-			case GL_DEBUG_SOURCE_WINDOW_SYSTEM:   sourceStr = "WINDOW_SYSTEM";   break;
-			case GL_DEBUG_SOURCE_SHADER_COMPILER: sourceStr = "SHADER_COMPILER"; break;
-			case GL_DEBUG_SOURCE_THIRD_PARTY:     sourceStr = "THIRD_PARTY";     break;
-			case GL_DEBUG_SOURCE_APPLICATION:     sourceStr = "APPLICATION";     break;
-			case GL_DEBUG_SOURCE_OTHER:           sourceStr = "OTHER";           break;
-			}
-			const char* typeStr = "?";
-			switch (type) {
-			case GL_DEBUG_TYPE_ERROR:               typeStr = "ERROR";               break; // An error, typically from the API
-			case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: typeStr = "DEPRECATED_BEHAVIOR"; break; // Some behavior marked deprecated has been used
-			case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:  typeStr = "UNDEFINED_BEHAVIOR";  break; // Something has invoked undefined behavior
-			case GL_DEBUG_TYPE_PORTABILITY:         typeStr = "PORTABILITY";         break; // Some functionality the user relies upon is not portable
-			case GL_DEBUG_TYPE_PERFORMANCE:         typeStr = "PERFORMANCE";         break; // Code has triggered possible performance issues
-			case GL_DEBUG_TYPE_MARKER:              typeStr = "MARKER";              break; // Command stream annotation
-			case GL_DEBUG_TYPE_PUSH_GROUP:          typeStr = "PUSH_GROUP";          break; // Group pushing
-			case GL_DEBUG_TYPE_POP_GROUP:           typeStr = "POP_GROUP";           break; // Group popping
-			case GL_DEBUG_TYPE_OTHER:               typeStr = "OTHER";               break; // Some type that isn't one of these
-			}
-			const char* severityStr = "?";
-			switch (severity) {
-			case GL_DEBUG_SEVERITY_HIGH:         severityStr = "HIGH";         break; // All OpenGL Errors, shader compilation/linking errors, or highly-dangerous undefined behavior
-			case GL_DEBUG_SEVERITY_MEDIUM:       severityStr = "MEDIUM";       break; // Major performance warnings, shader compilation/linking warnings, or the use of deprecated functionality
-			case GL_DEBUG_SEVERITY_LOW:          severityStr = "LOW";          break; // Redundant state change performance warning, or unimportant undefined behavior
-			case GL_DEBUG_SEVERITY_NOTIFICATION: severityStr = "NOTIFICATION"; break; // Anything that isn't an error or performance issue.
-			}
-			if (source == GL_DEBUG_SOURCE_API && // skip this particular warning about vertex shadering being recompiled based on GL state .. i don't understand it
-				type == GL_DEBUG_TYPE_PERFORMANCE &&
-				severity == GL_DEBUG_SEVERITY_MEDIUM) {
-				if (strstr(message, "Program/shader state performance warning: Vertex shader in program") ||
-					strstr(message, "shader recompiled due to state change"))
-					return;
-			}
-			if (g_CurrentShaderBeingCompiled)
-				fprintf(stderr, "error compiling shader \"%s\"!\n", g_CurrentShaderBeingCompiled);
-			fprintf(stderr, "GL CALLBACK:%s (source=%s, type=%s, severity=%s): %s\n",
-				type == GL_DEBUG_TYPE_ERROR ? " ** GL ERROR **" : "",
-				sourceStr,
-				typeStr,
-				severityStr,
-				message);
-			if (severity == GL_DEBUG_SEVERITY_HIGH) {
-				static bool stop = true;
-				if (stop) {
-					stop = false;
-					__debugbreak();
-				}
-			}
-		}
-	}};
-	glEnable(GL_DEBUG_OUTPUT);
-	glDebugMessageCallback(OpenGLDebugMessageCallback::func, nullptr);
-#endif
-
-	glutMainLoop();
-	return 0;
+// ====================
+// shadertoy_player.cpp
+// ====================
+
+// ======================================================================================================================================
+// TODO --
+// + decouple buffers from pass outputs - allow for say pass 0 to render to an MRT and pass 1 to render to just one layer of the same MRT
+// + allow MRTs with different formats
+// - framebuffer blending (do we really need this? since we can bind the output as an input ..)
+// + cubemap and volume textures
+// + buffers can be texture arrays (different from MRT as you can bind the whole array for sampling)
+// + integer formats (need isampler, usampler etc.)
+// + automatic mipmap generation
+// + subpasses (each pass renders N times, N controllable in pass metadata, and a shader uniform int 'iPass' is available)
+// - mouse passive motion and wheel support
+// + imageLoadStore
+// - allow hookup between bool SLIDER_VAR and keyboard toggles
+// + extended keyboard input texture: store uint16 instead of toggle, ...
+// - would be nice to have a running graph interface - e.g. number of visible lightmap texels over time
+//    need image to store array of float data
+//    every frame, the image writes to itself one row down and one row over
+// + remove indices from inputs and images (still need them for outputs i guess)
+// + allow for passes to be references from COMMON.glsl
+// + hot reload - passes are recompiled when their source files change
+// - improve shader compiling - allow for #defines to be referenced from working directory, etc.
+
+#define SUPPORT_IMAGES (1)
+#define SUPPORT_TRACE (1) // -trace=file.json, see TRACE_SCOPE
+#define SUPPORT_HEADLESS (1) // -headless, renders through a hidden window on windows, an EGL surfaceless context (or OSMesa if HEADLESS_OSMESA is defined) on linux
+
+// ======================================================================================================================================
+
+#include "common/common.h"
+
+#include "GraphicsTools/util/camera.h"
+#include "GraphicsTools/util/crc.h"
+#include "GraphicsTools/util/fileutil.h"
+#include "GraphicsTools/util/font.h"
+#include "GraphicsTools/util/framebuffer.h"
+#include "GraphicsTools/util/gui.h"
+#include "GraphicsTools/util/imagedxt.h"
+#include "GraphicsTools/util/imageutil.h"
+#include "GraphicsTools/util/keyboard.h"
+#include "GraphicsTools/util/memory.h"
+#include "GraphicsTools/util/mesh.h"
+#include "GraphicsTools/util/progressdisplay.h"
+#include "GraphicsTools/util/stringutil.h"
+
+#include "vmath/vmath_color.h"
+#include "vmath/vmath_float16.h"
+#include "vmath/vmath_matrix.h"
+#include "vmath/vmath_random.h"
+#include "vmath/vmath_sampling.h"
+#include "vmath/vmath_sphere.h"
+#include "vmath/vmath_test.h"
+#include "vmath/vmath_triangle.h"
+#include "vmath/vmath_vec4.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <random>
+#include <set>
+#include <time.h>
+#include <sys/stat.h>
+#if defined(__linux__)
+#include <dirent.h>
+#include <sys/inotify.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#else
+#include <direct.h>
+#include <windows.h>
+#endif
+#if SUPPORT_HEADLESS && defined(__linux__)
+#if defined(HEADLESS_OSMESA)
+#include <GL/osmesa.h>
+#else
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+#endif // SUPPORT_HEADLESS && defined(__linux__)
+
+#include "shaders_common/shadertoy_common.h"
+
+static std::string GetOpenGLTextureTargetStr(GLenum target)
+{
+	switch (target) {
+	case GL_TEXTURE_1D:                   return "GL_TEXTURE_1D";
+	case GL_TEXTURE_1D_ARRAY:             return "GL_TEXTURE_1D_ARRAY";
+	case GL_TEXTURE_2D:                   return "GL_TEXTURE_2D";
+	case GL_TEXTURE_2D_ARRAY:             return "GL_TEXTURE_2D_ARRAY";
+	case GL_TEXTURE_2D_MULTISAMPLE:       return "GL_TEXTURE_2D_MULTISAMPLE";
+	case GL_TEXTURE_2D_MULTISAMPLE_ARRAY: return "GL_TEXTURE_2D_MULTISAMPLE_ARRAY";
+	case GL_TEXTURE_3D:                   return "GL_TEXTURE_3D";
+	case GL_TEXTURE_CUBE_MAP:             return "GL_TEXTURE_CUBE_MAP";
+	case GL_TEXTURE_CUBE_MAP_ARRAY:       return "GL_TEXTURE_CUBE_MAP_ARRAY";
+	case GL_TEXTURE_RECTANGLE:            return "GL_TEXTURE_RECTANGLE";
+	case GL_TEXTURE_BUFFER:               return "GL_TEXTURE_BUFFER";
+	case GL_NONE:                         return "GL_NONE";
+	}
+	return varString("UNKNOWN(%i)", target);
+}
+
+static GLenum GetOpenGLTextureTargetBinding(GLenum target)
+{
+	switch (target) {
+	case GL_TEXTURE_1D:                   return GL_TEXTURE_BINDING_1D;
+	case GL_TEXTURE_1D_ARRAY:             return GL_TEXTURE_BINDING_1D_ARRAY;
+	case GL_TEXTURE_2D:                   return GL_TEXTURE_BINDING_2D;
+	case GL_TEXTURE_2D_ARRAY:             return GL_TEXTURE_BINDING_2D_ARRAY;
+	case GL_TEXTURE_2D_MULTISAMPLE:       return GL_TEXTURE_BINDING_2D_MULTISAMPLE;
+	case GL_TEXTURE_2D_MULTISAMPLE_ARRAY: return GL_TEXTURE_BINDING_2D_MULTISAMPLE_ARRAY;
+	case GL_TEXTURE_3D:                   return GL_TEXTURE_BINDING_3D;
+	case GL_TEXTURE_CUBE_MAP:             return GL_TEXTURE_BINDING_CUBE_MAP;
+	case GL_TEXTURE_CUBE_MAP_ARRAY:       return GL_TEXTURE_BINDING_CUBE_MAP_ARRAY;
+	case GL_TEXTURE_RECTANGLE:            return GL_TEXTURE_BINDING_RECTANGLE;
+	case GL_TEXTURE_BUFFER:               return GL_TEXTURE_BINDING_BUFFER;
+	}
+	return GL_NONE;
+}
+
+static void glBindTextureDEBUG(GLenum target, GLuint textureID)
+{
+#if 0
+	GLuint textureID_prev = 0;
+	glGetIntegerv(GetOpenGLTextureTargetBinding(target), (GLint*)&textureID_prev);
+	printf("*** binding target %s to textureID %u (was bound to texture ID %u)\n", GetOpenGLTextureTargetStr(target).c_str(), textureID, textureID_prev);
+	const GLenum targets[] = {
+		GL_TEXTURE_1D,
+		GL_TEXTURE_1D_ARRAY,
+		GL_TEXTURE_2D,
+		GL_TEXTURE_2D_ARRAY,
+		GL_TEXTURE_2D_MULTISAMPLE,
+		GL_TEXTURE_2D_MULTISAMPLE_ARRAY,
+		GL_TEXTURE_3D,
+		GL_TEXTURE_CUBE_MAP,
+		GL_TEXTURE_CUBE_MAP_ARRAY,
+		GL_TEXTURE_RECTANGLE,
+		GL_TEXTURE_BUFFER,
+	};
+	for (int i = 0; i < icountof(targets); i++) {
+		glGetIntegerv(GetOpenGLTextureTargetBinding(targets[i]), (GLint*)&textureID_prev);
+		printf("***   texture ID %u was bound by target %s\n", textureID_prev, GetOpenGLTextureTargetStr(targets[i]).c_str());
+	}
+#endif
+	glBindTexture(target, textureID);
+}
+
+static uint32 g_ViewportWidth = 960;
+static uint32 g_ViewportHeight = 512;
+static float g_RenderScale = 1.0f; // relative-sized buffers and the final pass render at this fraction of the viewport, see DynamicResolution
+static GLuint g_DefaultFramebufferID = 0; // passes with no outputs render here - offscreen when running headless
+
+static uint32 GetRenderWidth() { return Max(1U, (uint32)Ceiling(g_RenderScale*(float)g_ViewportWidth)); }
+static uint32 GetRenderHeight() { return Max(1U, (uint32)Ceiling(g_RenderScale*(float)g_ViewportHeight)); }
+static bool g_Headless = false;
+static bool g_TextureBakeCache = true; // -no_texture_cache, see ShaderToyBuffer::LoadImageJob
+static bool g_TextureBakeRebuild = false; // -bake
+static std::atomic<uint32> g_NumBakedTexturesLoaded(0);
+static std::atomic<uint32> g_NumTexturesBaked(0);
+static float g_FixedTimeDelta = 0.0f; // -dt, if > 0 then time advances by exactly this much every frame
+static std::map<std::string,bool> g_CapturedBuffers; // buffers read back on the CPU, these are never aliased
+
+class OfflineRenderSettings
+{
+public:
+	OfflineRenderSettings() : m_enabled(false), m_startFrame(0), m_endFrame(100), m_captureEvery(1), m_capture(false), m_captureDir("_capture"), m_captureExt("tga") {}
+	bool m_enabled;
+	uint32 m_startFrame; // earlier frames are rendered but not captured, so frame N comes out the same whatever the range
+	uint32 m_endFrame; // exclusive
+	uint32 m_captureEvery;
+	bool m_capture;
+	std::vector<std::string> m_captureNames; // buffer names, "final" for the final image
+	std::string m_captureDir;
+	std::string m_captureExt; // raw, dds, exr or anything SaveImage supports
+};
+
+static OfflineRenderSettings g_Offline;
+
+// -benchmark, see RunBenchmarkSuite
+class BenchmarkSettings
+{
+public:
+	BenchmarkSettings() : m_warmupFrames(20), m_frames(200), m_thresholdPercent(10.0f), m_outputPath("_benchmark.json") {}
+	uint32 m_warmupFrames;
+	uint32 m_frames;
+	std::vector<std::pair<uint32,uint32> > m_resolutions; // -bench_res, default is -res
+	float m_thresholdPercent; // a result regresses if its p50 is this much slower than the baseline's
+	std::string m_outputPath;
+	std::string m_baselinePath;
+	std::string m_runPath; // -bench_run, set for the child processes which each render one shader directory at one resolution
+};
+
+static BenchmarkSettings g_Benchmark;
+static std::string g_ShadersDir = "shaders";
+static bool g_GPUShader5 = false;
+static bool g_CoreProfile = false; // request a core 4.4 context (no immediate mode, no GUI)
+static Keyboard g_Keyboard;
+static int g_MouseDragCurr[2] = {0,0};
+static int g_MouseDragStart[2] = {0,0};
+static bool g_MouseButtonState[3] = {false,false,false}; // left,right,middle
+static int g_MouseWheelState = 0; // instantaneous state
+
+#define SHADER_DEFINE_STRING "#define " // note: line must start literally with "#define ", not "<spaces or tabs> # <spaces or tabs> define" etc.
+#define SHADER_CODE_MAX_LINE_SIZE 4096
+
+// uniform reflection table, built once per program after it links - per-frame code never calls glGetUniformLocation
+static std::map<GLuint,std::map<std::string,GLint> > g_ProgramUniformLocations; // programID -> uniform name -> location
+
+class UniformCallCounter
+{
+public:
+	UniformCallCounter() : m_requested(0), m_issued(0) {}
+	bool operator!=(const UniformCallCounter& rhs) const { return m_requested != rhs.m_requested || m_issued != rhs.m_issued; }
+	uint32 m_requested; // uniform updates requested - an estimate of the uncached path, where each one was a glGetUniformLocation + glUniform*
+	uint32 m_issued; // glUniform* calls actually made (value changed since last frame)
+};
+
+static UniformCallCounter g_UniformCallsThisFrame;
+static bool g_ReportUniformCalls = false;
+
+// -profile: per-pass GPU timings (and shader invocation counts, if GL_ARB_pipeline_statistics_query is supported)
+static bool g_Profile = false;
+static bool g_ProfileOverlay = true; // toggled with ctrl+P
+static std::string g_ProfileDumpPath = "_profile.csv"; // written on ctrl+shift+P and at the end of -offline, .csv or .json
+static bool g_PipelineStatistics = false;
+
+#if SUPPORT_TRACE
+static std::string g_TracePath; // -trace
+static uint32 g_TraceEndFrame = 300; // the trace is written after this many frames, or at the end of -offline
+#endif // SUPPORT_TRACE
+
+static void BuildProgramUniformLocations(GLuint programID)
+{
+	std::map<std::string,GLint>& locations = g_ProgramUniformLocations[programID];
+	locations.clear();
+	GLint numUniforms = 0;
+	GLint maxNameLength = 0;
+	glGetProgramiv(programID, GL_ACTIVE_UNIFORMS, &numUniforms);
+	glGetProgramiv(programID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+	std::vector<GLchar> name(maxNameLength + 1);
+	for (GLint i = 0; i < numUniforms; i++) {
+		GLint size = 0;
+		GLenum type = GL_NONE;
+		glGetActiveUniform(programID, (GLuint)i, (GLsizei)name.size(), nullptr, &size, &type, name.data());
+		const GLint location = glGetUniformLocation(programID, name.data());
+		if (location != -1) { // uniforms in blocks don't have locations
+			const size_t length = strlen(name.data()); // arrays are reported as "name[0]", strip only that trailing suffix so "s[0].x" stays intact
+			if (length > 3 && strcmp(name.data() + length - 3, "[0]") == 0)
+				name[length - 3] = '\0';
+			locations[name.data()] = location;
+		}
+	}
+}
+
+static GLint GetProgramUniformLocation(GLuint programID, const char* name)
+{
+	const auto p = g_ProgramUniformLocations.find(programID);
+	if (p != g_ProgramUniformLocations.end()) {
+		const auto f = p->second.find(name);
+		if (f != p->second.end())
+			return f->second;
+	}
+	return -1;
+}
+
+// cached uniform location plus the last value pushed to the program, so unchanged values are not re-sent
+class ProgramUniform
+{
+public:
+	ProgramUniform() : m_location(-1) {}
+
+	void Init(GLuint programID, const char* name)
+	{
+		m_location = GetProgramUniformLocation(programID, name);
+		m_value.clear();
+	}
+
+	void SetFloat(const float* v, uint32 components, uint32 count = 1)
+	{
+		if (Changed(v, components*count*sizeof(float))) {
+			switch (components) {
+			case 1: glUniform1fv(m_location, count, v); break;
+			case 2: glUniform2fv(m_location, count, v); break;
+			case 3: glUniform3fv(m_location, count, v); break;
+			case 4: glUniform4fv(m_location, count, v); break;
+			}
+		}
+	}
+
+	void SetInt(const int* v, uint32 components, uint32 count = 1)
+	{
+		if (Changed(v, components*count*sizeof(int))) {
+			switch (components) {
+			case 1: glUniform1iv(m_location, count, v); break;
+			case 2: glUniform2iv(m_location, count, v); break;
+			case 3: glUniform3iv(m_location, count, v); break;
+			case 4: glUniform4iv(m_location, count, v); break;
+			}
+		}
+	}
+
+	void SetUInt(const uint32* v, uint32 components, uint32 count = 1)
+	{
+		if (Changed(v, components*count*sizeof(uint32))) {
+			switch (components) {
+			case 1: glUniform1uiv(m_location, count, v); break;
+			case 2: glUniform2uiv(m_location, count, v); break;
+			case 3: glUniform3uiv(m_location, count, v); break;
+			case 4: glUniform4uiv(m_location, count, v); break;
+			}
+		}
+	}
+
+	void Set1f(float x) { SetFloat(&x, 1); }
+	void Set1i(int x) { SetInt(&x, 1); }
+	void Set1ui(uint32 x) { SetUInt(&x, 1); }
+
+private:
+	bool Changed(const void* data, size_t size)
+	{
+		g_UniformCallsThisFrame.m_requested++;
+		if (m_location == -1)
+			return false;
+		if (m_value.size() == size && memcmp(m_value.data(), data, size) == 0)
+			return false;
+		m_value.assign((const uint8*)data, (const uint8*)data + size);
+		g_UniformCallsThisFrame.m_issued++;
+		return true;
+	}
+
+	GLint m_location;
+	std::vector<uint8> m_value; // last value pushed to the program
+};
+
+#if USE_GUI
+static bool g_GUIEnabled = true;
+static GUIFrame* g_GUIFrame = nullptr;
+static bool g_GUISliderChanged = false;
+
+static void SetGUISliderChanged(GUISliderElement*, GUI::eGUIEvent)
+{
+	g_GUISliderChanged = true;
+}
+
+enum eGUISliderType
+{
+	GUI_SLIDER_TYPE_NONE = 0,
+	GUI_SLIDER_TYPE_FLOAT,
+	GUI_SLIDER_TYPE_INT,
+	GUI_SLIDER_TYPE_UINT,
+	GUI_SLIDER_TYPE_BOOL,
+};
+
+class GUISlider
+{
+private:
+	GUISlider(int passIndex, eGUISliderType type, uint32 components, const char* name, const char* init)
+		: m_passIndex(passIndex)
+		, m_type(type)
+		, m_components(components)
+		, m_name(name)
+		, m_data(nullptr)
+	{
+		switch (type) {
+		case GUI_SLIDER_TYPE_FLOAT: {
+			m_data = new float[components];
+			if (init) {
+				const float dataInit = (float)atof(init);
+				for (uint32 i = 0; i < components; i++)
+					((float*)m_data)[i] = dataInit;
+			} else
+				memset(m_data, 0, components*sizeof(float));
+			break;
+		} case GUI_SLIDER_TYPE_INT:
+			m_data = new int[components];
+			if (init) {
+				const int dataInit = atoi(init);
+				for (uint32 i = 0; i < components; i++)
+					((int*)m_data)[i] = dataInit;
+			} else
+				memset(m_data, 0, components*sizeof(int));
+			break;
+		case GUI_SLIDER_TYPE_UINT:
+			m_data = new uint32[components];
+			if (init) {
+				const uint32 dataInit = (uint32)atoi(init);
+				for (uint32 i = 0; i < components; i++)
+					((uint32*)m_data)[i] = dataInit;
+			} else
+				memset(m_data, 0, components*sizeof(int));
+			break;
+		case GUI_SLIDER_TYPE_BOOL:
+			m_data = new bool[components];
+			if (init) {
+				const bool dataInit = stricmp(init, "true") == 0;
+				for (uint32 i = 0; i < components; i++)
+					((bool*)m_data)[i] = dataInit;
+			} else
+				memset(m_data, 0, components*sizeof(bool));
+			break;
+		};
+	}
+
+public:
+	static void SetCurrentPassIndexForShaderLoad(int passIndex)
+	{
+		GetCurrentPassIndexForShaderLoad() = passIndex;
+	}
+
+	static bool AddSlider(const char* shaderPath, uint32 shaderLineIndex, const char* line)
+	{
+		// e.g. "SLIDER_VAR(vec3,myvec,1,-2,2);"
+		while (*line == ' ' || *line == '\t')
+			line++;
+		if (if_strskip(line, "SLIDER_VAR(")) {
+			char temp[SHADER_CODE_MAX_LINE_SIZE];
+			strcpy(temp, line);
+			char* end = strchr(temp, ')');
+			if (end) {
+				*end = '\0';
+				NameValuePairs params(temp);
+				if (params.size() >= 3) { // (type,name,init) are mandatory
+					const char* typeStr = params[0].m_value.c_str();
+					const char* nameStr = params[1].m_value.c_str();
+					const char* initStr = params[2].m_value.c_str();
+					eGUISliderType type = GUI_SLIDER_TYPE_NONE;
+					uint32 components = 0;
+					if      (strcmp(typeStr, "float") == 0) { type = GUI_SLIDER_TYPE_FLOAT; components = 1; }
+					else if (strcmp(typeStr, "vec2" ) == 0) { type = GUI_SLIDER_TYPE_FLOAT; components = 2; }
+					else if (strcmp(typeStr, "vec3" ) == 0) { type = GUI_SLIDER_TYPE_FLOAT; components = 3; }
+					else if (strcmp(typeStr, "vec4" ) == 0) { type = GUI_SLIDER_TYPE_FLOAT; components = 4; }
+					if      (strcmp(typeStr, "int"  ) == 0) { type = GUI_SLIDER_TYPE_INT;   components = 1; }
+					else if (strcmp(typeStr, "ivec2") == 0) { type = GUI_SLIDER_TYPE_INT;   components = 2; }
+					else if (strcmp(typeStr, "ivec3") == 0) { type = GUI_SLIDER_TYPE_INT;   components = 3; }
+					else if (strcmp(typeStr, "ivec4") == 0) { type = GUI_SLIDER_TYPE_INT;   components = 4; }
+					if      (strcmp(typeStr, "uint" ) == 0) { type = GUI_SLIDER_TYPE_UINT;  components = 1; }
+					else if (strcmp(typeStr, "uvec2") == 0) { type = GUI_SLIDER_TYPE_UINT;  components = 2; }
+					else if (strcmp(typeStr, "uvec3") == 0) { type = GUI_SLIDER_TYPE_UINT;  components = 3; }
+					else if (strcmp(typeStr, "uvec4") == 0) { type = GUI_SLIDER_TYPE_UINT;  components = 4; }
+					if      (strcmp(typeStr, "bool" ) == 0) { type = GUI_SLIDER_TYPE_BOOL;  components = 1; }
+					else if (strcmp(typeStr, "bvec2") == 0) { type = GUI_SLIDER_TYPE_BOOL;  components = 2; }
+					else if (strcmp(typeStr, "bvec3") == 0) { type = GUI_SLIDER_TYPE_BOOL;  components = 3; }
+					else if (strcmp(typeStr, "bvec4") == 0) { type = GUI_SLIDER_TYPE_BOOL;  components = 4; }
+					if (type != GUI_SLIDER_TYPE_NONE || (type != GUI_SLIDER_TYPE_BOOL && params.size() < 5)) {
+						const char* minStr = params.size() > 3 ? params[3].m_value.c_str() : nullptr;
+						const char* maxStr = params.size() > 4 ? params[4].m_value.c_str() : nullptr;
+						const int passIndex = GetCurrentPassIndexForShaderLoad();
+						GUISlider* slider = new GUISlider(passIndex, type, components, nameStr, initStr);
+						if (g_GUIFrame == nullptr) {
+							GUIWindow* window = new GUIWindow();
+							g_GUIFrame = &window->m_frame;
+							GUI::RegisterWindow(window);
+						}
+						for (uint32 i = 0; i < components; i++) {
+							char componentName[256] = "";
+							if (passIndex != -1)
+								sprintf(componentName, "pass %i - ", passIndex);
+							strcat(componentName, slider->m_name.c_str());
+							if (components > 1)
+								strcatf(componentName, ".%c", 'x' + i);
+							for (char* s = componentName; *s; s++)
+								if (*s == '_')
+									*s = ' ';
+							switch (type) {
+							case GUI_SLIDER_TYPE_FLOAT:
+								g_GUIFrame->AddElement(new GUISliderElement(componentName, ((float*)slider->m_data)[i], (float)atof(minStr), (float)atof(maxStr), SetGUISliderChanged));
+								break;
+							case GUI_SLIDER_TYPE_INT:
+								g_GUIFrame->AddElement(new GUIIntSliderElement(componentName, ((int*)slider->m_data)[i], atoi(minStr), atoi(maxStr), SetGUISliderChanged));
+								break;
+							case GUI_SLIDER_TYPE_UINT:
+								g_GUIFrame->AddElement(new GUIIntSliderElement(componentName, ((int*)slider->m_data)[i], atoi(minStr), atoi(maxStr), SetGUISliderChanged)); // TODO -- uint sliders
+								break;
+							case GUI_SLIDER_TYPE_BOOL:
+								g_GUIFrame->AddElement(new GUIBoolSliderElement(componentName, ((bool*)slider->m_data)[i], SetGUISliderChanged));
+								break;
+							}
+						}
+						GetSliders().push_back(slider);
+						g_GUIFrame->AlignSliders();
+						return true;
+					} else
+						fprintf(stderr, "shader error in %s (line %u): unknown type for SLIDER_VAR\n", shaderPath, shaderLineIndex);
+				} else
+					fprintf(stderr, "shader error in %s (line %u): incorrect number of params for SLIDER_VAR\n", shaderPath, shaderLineIndex);
+			} else
+				fprintf(stderr, "shader error in %s (line %u): no close parenthesis found for SLIDER_VAR\n", shaderPath, shaderLineIndex);
+		}
+		return false;
+	}
+
+	static void InitUniformsForPass(uint32 passIndex, GLuint programID, std::vector<ProgramUniform>& uniforms, ProgramUniform& sliderChanged)
+	{
+		const std::vector<GUISlider*>& sliders = GetSliders();
+		uniforms.clear();
+		uniforms.resize(sliders.size());
+		for (uint32 i = 0; i < sliders.size(); i++) {
+			const GUISlider* slider = sliders[i];
+			if (slider->m_passIndex == -1 || slider->m_passIndex == (int)passIndex)
+				uniforms[i].Init(programID, slider->m_name.c_str());
+		}
+		sliderChanged.Init(programID, "g_GUISliderChanged");
+	}
+
+	static void SetUniformsForPass(uint32 passIndex, std::vector<ProgramUniform>& uniforms, ProgramUniform& sliderChanged)
+	{
+		const std::vector<GUISlider*>& sliders = GetSliders();
+		for (uint32 i = 0; i < sliders.size() && i < uniforms.size(); i++) {
+			const GUISlider* slider = sliders[i];
+			if (slider->m_passIndex == -1 || slider->m_passIndex == (int)passIndex) {
+				switch (slider->m_type) {
+				case GUI_SLIDER_TYPE_FLOAT: uniforms[i].SetFloat((const float*)slider->m_data, slider->m_components); break;
+				case GUI_SLIDER_TYPE_INT:   uniforms[i].SetInt((const int*)slider->m_data, slider->m_components); break;
+				case GUI_SLIDER_TYPE_UINT:  uniforms[i].SetUInt((const uint32*)slider->m_data, slider->m_components); break;
+				case GUI_SLIDER_TYPE_BOOL: {
+					const bool* data = (const bool*)slider->m_data;
+					uint32 temp[4];
+					for (uint32 j = 0; j < slider->m_components; j++)
+						temp[j] = data[j] ? 1 : 0;
+					uniforms[i].SetUInt(temp, slider->m_components);
+					break;
+				}
+				}
+			}
+		}
+		sliderChanged.Set1ui(g_GUISliderChanged ? 1 : 0);
+	}
+
+private:
+	static std::vector<GUISlider*>& GetSliders()
+	{
+		static std::vector<GUISlider*> sliders;
+		return sliders;
+	}
+
+	static int& GetCurrentPassIndexForShaderLoad()
+	{
+		static int passIndex = -1;
+		return passIndex;
+	}
+
+	int m_passIndex; // -1=common
+	eGUISliderType m_type;
+	uint32 m_components; // [1..4]
+	std::string m_name;
+	void* m_data;
+};
+#endif // USE_GUI
+
+static uint32 g_NumShaderCompilerLinkErrors = 0;
+static const char* g_CurrentShaderBeingCompiled = nullptr;
+static bool g_HotReloading = false; // don't pause on compile errors while the player is running
+static std::map<GLenum,std::map<GLuint,std::string> > g_ShaderToProcessedPath; // target -> programID -> path
+static std::map<GLuint,uint64> g_ShaderSourceHash; // shaderID -> hash of preprocessed source, for the program binary cache
+static bool g_ProgramBinaryCache = true;
+static uint32 g_ProgramBinaryCacheHits = 0;
+static uint32 g_ProgramBinaryCacheMisses = 0;
+static bool g_ParallelShaderCompile = false; // GL_ARB_parallel_shader_compile is supported and not disabled with -serial_compile
+static bool g_SerialShaderCompile = false;
+
+#ifndef GL_COMPLETION_STATUS_ARB
+#define GL_COMPLETION_STATUS_ARB 0x91B1 // same value as GL_COMPLETION_STATUS_KHR
+#endif
+
+#if SUPPORT_TRACE
+// -trace: chrome://tracing (or ui.perfetto.dev) json of the TRACE_SCOPE blocks on every thread, plus the GPU pass
+// timestamps on their own row. each thread records into its own ring without locking, and while tracing is off a
+// scope is a single branch (or nothing at all with SUPPORT_TRACE=0)
+class Trace
+{
+public:
+	enum { RING_SIZE = 1<<14 }; // events per thread, the oldest are overwritten
+
+	class Scope
+	{
+	public:
+		Scope(const char* name, const char* detail = nullptr) : m_name(nullptr), m_detail(detail), m_beginUs(0)
+		{
+			if (IsEnabled()) {
+				m_name = name;
+				m_beginUs = GetTimeUs();
+			}
+		}
+
+		~Scope()
+		{
+			if (m_name)
+				Record(GetRing(), m_name, m_detail, m_beginUs, GetTimeUs());
+		}
+
+	private:
+		const char* m_name; // nullptr if tracing was off when the scope began
+		const char* m_detail;
+		uint64 m_beginUs;
+	};
+
+	static bool IsEnabled() { return Get().m_enabled.load(std::memory_order_relaxed); }
+
+	// needs the GL context, to line up the GPU timestamps with the CPU clock
+	static void Start()
+	{
+		State& st = Get();
+		st.m_startTime = std::chrono::steady_clock::now();
+		GLint64 gpuNs = 0;
+		glGetInteger64v(GL_TIMESTAMP, &gpuNs);
+		st.m_gpuStartNs = (uint64)gpuNs;
+		st.m_enabled = true;
+	}
+
+	static void SetThreadName(const char* name)
+	{
+		strncpy(GetThreadName(), name, THREAD_NAME_SIZE - 1);
+	}
+
+	// main thread only, timestamps come from GL_TIMESTAMP queries
+	static void AddGPUEvent(const std::string& name, uint64 beginNs, uint64 endNs)
+	{
+		State& st = Get();
+		if (IsEnabled() && beginNs >= st.m_gpuStartNs)
+			Record(st.m_gpuRing, st.m_gpuNames.insert(name).first->c_str(), nullptr, (beginNs - st.m_gpuStartNs)/1000, (endNs - st.m_gpuStartNs)/1000);
+	}
+
+	// stops tracing. events still being recorded on other threads may or may not make it in
+	static bool Write(const char* path)
+	{
+		State& st = Get();
+		if (!st.m_enabled.exchange(false))
+			return false;
+		FILE* file = fopen(path, "w");
+		if (file == nullptr) {
+			fprintf(stderr, "failed to write trace to %s\n", path);
+			return false;
+		}
+		std::lock_guard<std::mutex> lock(st.m_mutex);
+		std::vector<Ring*> rings(1, &st.m_gpuRing);
+		rings.insert(rings.end(), st.m_rings.begin(), st.m_rings.end());
+		uint64 numEvents = 0;
+		fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+		for (uint32 i = 0; i < rings.size(); i++) {
+			const Ring& ring = *rings[i];
+			fprintf(file, "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %u, \"args\": {\"name\": \"%s\"}}", i > 0 ? ",\n" : "", ring.m_threadIndex, ring.m_threadName.c_str());
+			fprintf(file, ",\n{\"name\": \"thread_sort_index\", \"ph\": \"M\", \"pid\": 1, \"tid\": %u, \"args\": {\"sort_index\": %u}}", ring.m_threadIndex, ring.m_threadIndex);
+			const uint64 count = ring.m_count.load(std::memory_order_acquire);
+			for (uint64 j = count > RING_SIZE ? count - RING_SIZE : 0; j < count; j++) {
+				const Event& e = ring.m_events[j%RING_SIZE];
+				fprintf(file, ",\n{\"name\": \"%s\", \"ph\": \"X\", \"ts\": %llu, \"dur\": %llu, \"pid\": 1, \"tid\": %u", e.m_name, (unsigned long long)e.m_beginUs, (unsigned long long)(e.m_endUs - e.m_beginUs), ring.m_threadIndex);
+				if (e.m_detail[0]) {
+					fprintf(file, ", \"args\": {\"detail\": \"");
+					for (const char* c = e.m_detail; *c; c++)
+						fprintf(file, (*c == '\\' || *c == '"') ? "\\%c" : "%c", *c);
+					fprintf(file, "\"}");
+				}
+				fprintf(file, "}");
+				numEvents++;
+			}
+		}
+		fprintf(file, "\n]}\n");
+		fclose(file);
+		printf("wrote %llu trace events from %u threads to %s\n", (unsigned long long)numEvents, (uint32)rings.size(), path);
+		return true;
+	}
+
+private:
+	enum { THREAD_NAME_SIZE = 32, DETAIL_SIZE = 96 };
+
+	class Event
+	{
+	public:
+		const char* m_name; // static (or interned, for the GPU row)
+		char m_detail[DETAIL_SIZE]; // copied, e.g. the file being compiled
+		uint64 m_beginUs;
+		uint64 m_endUs;
+	};
+
+	class Ring
+	{
+	public:
+		Ring(uint32 threadIndex, const char* threadName) : m_threadIndex(threadIndex), m_threadName(threadName), m_events(RING_SIZE), m_count(0) {}
+		uint32 m_threadIndex; // tid in the trace, 0 is the GPU
+		std::string m_threadName;
+		std::vector<Event> m_events;
+		std::atomic<uint64> m_count; // total recorded, only the owning thread writes
+	};
+
+	class State
+	{
+	public:
+		State() : m_enabled(false), m_gpuStartNs(0), m_gpuRing(0, "GPU") {}
+		std::atomic<bool> m_enabled;
+		std::chrono::steady_clock::time_point m_startTime;
+		uint64 m_gpuStartNs;
+		Ring m_gpuRing;
+		std::set<std::string> m_gpuNames;
+		std::vector<Ring*> m_rings; // never freed, threads may still be recording when the trace is written
+		std::mutex m_mutex;
+	};
+
+	static State& Get()
+	{
+		static State* st = new State();
+		return *st;
+	}
+
+	static char* GetThreadName()
+	{
+		static thread_local char name[THREAD_NAME_SIZE] = "";
+		return name;
+	}
+
+	static Ring& GetRing()
+	{
+		static thread_local Ring* ring = nullptr;
+		if (ring == nullptr) {
+			State& st = Get();
+			std::lock_guard<std::mutex> lock(st.m_mutex);
+			const uint32 threadIndex = (uint32)st.m_rings.size() + 1;
+			ring = new Ring(threadIndex, GetThreadName()[0] ? GetThreadName() : varString("thread %u", threadIndex).c_str());
+			st.m_rings.push_back(ring);
+		}
+		return *ring;
+	}
+
+	static uint64 GetTimeUs()
+	{
+		return (uint64)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - Get().m_startTime).count();
+	}
+
+	static void Record(Ring& ring, const char* name, const char* detail, uint64 beginUs, uint64 endUs)
+	{
+		const uint64 index = ring.m_count.load(std::memory_order_relaxed);
+		Event& e = ring.m_events[index%RING_SIZE];
+		e.m_name = name;
+		e.m_detail[0] = '\0';
+		if (detail)
+			strncat(e.m_detail, detail, DETAIL_SIZE - 1);
+		e.m_beginUs = beginUs;
+		e.m_endUs = endUs;
+		ring.m_count.store(index + 1, std::memory_order_release);
+	}
+};
+
+#define TRACE_CONCAT_(a,b) a##b
+#define TRACE_CONCAT(a,b) TRACE_CONCAT_(a,b)
+#define TRACE_SCOPE(name) Trace::Scope TRACE_CONCAT(traceScope_, __LINE__)(name)
+#define TRACE_SCOPE_DETAIL(name, detail) Trace::Scope TRACE_CONCAT(traceScope_, __LINE__)(name, detail)
+#else
+#define TRACE_SCOPE(name)
+#define TRACE_SCOPE_DETAIL(name, detail)
+#endif // SUPPORT_TRACE
+
+// small persistent thread pool for CPU work (preprocessing, file io, image processing). jobs must not make GL calls,
+// the context is only current on the main thread
+class JobSystem
+{
+public:
+	static void Submit(const std::function<void()>& job)
+	{
+		State& st = Get();
+		{
+			std::lock_guard<std::mutex> lock(st.m_mutex);
+			st.m_jobs.push_back(job);
+		}
+		st.m_cv.notify_one();
+	}
+
+	// runs job(0..count-1) across the workers and the calling thread, returns when all are done
+	static void ParallelFor(uint32 count, const std::function<void(uint32)>& job)
+	{
+		class Batch
+		{
+		public:
+			Batch(uint32 count, const std::function<void(uint32)>& job) : m_count(count), m_next(0), m_done(0), m_job(job) {}
+			void Run()
+			{
+				uint32 index;
+				while ((index = m_next++) < m_count) {
+					m_job(index);
+					if (++m_done == m_count) {
+						std::lock_guard<std::mutex> lock(m_mutex);
+						m_cv.notify_all();
+					}
+				}
+			}
+			const uint32 m_count;
+			std::atomic<uint32> m_next;
+			std::atomic<uint32> m_done;
+			std::function<void(uint32)> m_job;
+			std::mutex m_mutex;
+			std::condition_variable m_cv;
+		};
+		if (count == 0)
+			return;
+		std::shared_ptr<Batch> batch = std::make_shared<Batch>(count, job); // workers which start late still hold a reference
+		const uint32 numHelpers = Min(count - 1, GetNumThreads());
+		for (uint32 i = 0; i < numHelpers; i++)
+			Submit([batch]() { batch->Run(); });
+		batch->Run();
+		std::unique_lock<std::mutex> lock(batch->m_mutex);
+		batch->m_cv.wait(lock, [&batch]() { return batch->m_done == batch->m_count; });
+	}
+
+	static uint32 GetNumThreads() { return (uint32)Get().m_workers.size(); }
+
+private:
+	class State
+	{
+	public:
+		State()
+		{
+			const uint32 numThreads = Max(2U, (uint32)std::thread::hardware_concurrency()) - 1; // main thread makes up the rest
+			for (uint32 i = 0; i < numThreads; i++)
+				m_workers.push_back(std::thread(&State::WorkerMain, this, i));
+		}
+
+		void WorkerMain(uint32 workerIndex)
+		{
+		#if SUPPORT_TRACE
+			Trace::SetThreadName(varString("worker %u", workerIndex).c_str());
+		#endif // SUPPORT_TRACE
+			while (true) {
+				std::function<void()> job;
+				{
+					std::unique_lock<std::mutex> lock(m_mutex);
+					m_cv.wait(lock, [this]() { return !m_jobs.empty(); });
+					job = m_jobs.front();
+					m_jobs.pop_front();
+				}
+				job();
+			}
+		}
+
+		std::vector<std::thread> m_workers;
+		std::deque<std::function<void()> > m_jobs;
+		std::mutex m_mutex;
+		std::condition_variable m_cv;
+	};
+
+	static State& Get()
+	{
+		static State* st = new State(); // never destroyed, the workers just die with the process
+		return *st;
+	}
+};
+
+// asynchronous readback - glReadPixels goes into a PBO with a fence, and a PBO is only mapped once its fence has
+// signalled, so the render thread never waits on the GPU (or on the writers) outside of Flush. PBOs are reused once
+// they've been mapped, and more are added while readbacks are in flight, up to maxInFlight - past that (or when the
+// writers have fallen behind) a readback is dropped rather than stalling the frame. the data is then handed to a
+// JobSystem worker (e.g. to encode and write an image file)
+class ReadbackQueue
+{
+public:
+	typedef std::function<void(const uint8* data, uint32 w, uint32 h)> CompletionFunc; // called on a worker thread
+
+	ReadbackQueue(uint32 maxInFlight = 64, uint32 maxPendingJobs = 16) : m_maxInFlight(maxInFlight), m_maxPendingJobs(maxPendingJobs), m_pendingJobs(0), m_numDropped(0) {}
+
+	// reads w x h pixels from the bound GL_READ_FRAMEBUFFER and read buffer, returns false if the readback was dropped
+	bool Read(uint32 w, uint32 h, GLenum format, GLenum type, uint32 bytesPerPixel, const CompletionFunc& func)
+	{
+		if (m_inFlight.size() >= m_maxInFlight) {
+			if (m_numDropped++ == 0)
+				fprintf(stderr, "readback queue is full (%u in flight), dropping readbacks until it drains\n", (uint32)m_inFlight.size());
+			return false;
+		}
+		Slot slot;
+		if (!m_free.empty()) {
+			slot = m_free.back();
+			m_free.pop_back();
+		}
+		const uint32 size = w*h*bytesPerPixel;
+		if (slot.m_bufferID == 0)
+			glGenBuffers(1, &slot.m_bufferID);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.m_bufferID);
+		if (slot.m_capacity < size) {
+			glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+			slot.m_capacity = size;
+		}
+		glPixelStorei(GL_PACK_ALIGNMENT, 1);
+		glReadPixels(0, 0, w, h, format, type, nullptr);
+		glPixelStorei(GL_PACK_ALIGNMENT, 4); // restore
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		slot.m_fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		slot.m_size = size;
+		slot.m_w = w;
+		slot.m_h = h;
+		slot.m_func = func;
+		m_inFlight.push_back(slot);
+		return true;
+	}
+
+	void Poll() // completes any readbacks which are ready, without waiting
+	{
+		while (!m_inFlight.empty() && m_pendingJobs < m_maxPendingJobs && Complete(m_inFlight.front(), false))
+			Retire();
+		if (m_numDropped > 0 && m_inFlight.empty()) {
+			fprintf(stderr, "dropped %u readbacks\n", m_numDropped);
+			m_numDropped = 0;
+		}
+	}
+
+	void Flush() // waits for all readbacks and writes
+	{
+		while (!m_inFlight.empty()) {
+			while (m_pendingJobs >= m_maxPendingJobs)
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			Complete(m_inFlight.front(), true);
+			Retire();
+		}
+		while (m_pendingJobs > 0)
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		if (m_numDropped > 0) {
+			fprintf(stderr, "dropped %u readbacks\n", m_numDropped);
+			m_numDropped = 0;
+		}
+	}
+
+private:
+	class Slot
+	{
+	public:
+		Slot() : m_bufferID(0), m_capacity(0), m_size(0), m_fence(nullptr), m_w(0), m_h(0) {}
+		GLuint m_bufferID;
+		uint32 m_capacity;
+		uint32 m_size;
+		GLsync m_fence;
+		uint32 m_w;
+		uint32 m_h;
+		CompletionFunc m_func;
+	};
+
+	// maps the slot and hands its data to a worker, returns false if the fence hasn't signalled yet (and !wait)
+	bool Complete(Slot& slot, bool wait)
+	{
+		GLenum result;
+		do {
+			result = glClientWaitSync(slot.m_fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, wait ? 1000000000ULL : 0);
+		} while (wait && result == GL_TIMEOUT_EXPIRED);
+		if (result == GL_TIMEOUT_EXPIRED)
+			return false;
+		glDeleteSync(slot.m_fence);
+		slot.m_fence = nullptr;
+		std::shared_ptr<std::vector<uint8> > data = std::make_shared<std::vector<uint8> >(slot.m_size);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.m_bufferID);
+		const void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, slot.m_size, GL_MAP_READ_BIT);
+		if (mapped) {
+			memcpy(data->data(), mapped, slot.m_size);
+			glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+		}
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		if (mapped) {
+			m_pendingJobs++;
+			const CompletionFunc func = slot.m_func;
+			const uint32 w = slot.m_w;
+			const uint32 h = slot.m_h;
+			std::atomic<uint32>* pendingJobs = &m_pendingJobs;
+			JobSystem::Submit([func, data, w, h, pendingJobs]() { func(data->data(), w, h); (*pendingJobs)--; });
+		} else
+			fprintf(stderr, "glMapBufferRange failed for readback (%ux%u)\n", slot.m_w, slot.m_h);
+		slot.m_func = nullptr;
+		return true;
+	}
+
+	void Retire() // moves the completed oldest slot to the free list, so its PBO gets reused
+	{
+		m_free.push_back(m_inFlight.front());
+		m_inFlight.pop_front();
+	}
+
+	std::deque<Slot> m_inFlight; // oldest first
+	std::vector<Slot> m_free;
+	uint32 m_maxInFlight;
+	uint32 m_maxPendingJobs; // worker jobs (e.g. image writes) allowed to be queued before Poll stops mapping
+	std::atomic<uint32> m_pendingJobs;
+	uint32 m_numDropped;
+};
+
+// paths are built with '/', which windows accepts as well - paths from pass metadata and #includes are often written
+// with '\\', so those are converted when they're parsed
+static std::string GetPortablePath(const std::string& path)
+{
+	std::string portable = path;
+	std::replace(portable.begin(), portable.end(), '\\', '/');
+	return portable;
+}
+
+static const char* GetPathFileName(const char* path)
+{
+	const char* name = path;
+	for (const char* c = path; *c; c++)
+		if (*c == '/' || *c == '\\')
+			name = c + 1;
+	return name;
+}
+
+// "dir/name.ext" -> "dir/_processed/name.ext"
+static std::string GetProcessedPath(const char* path)
+{
+	const char* name = GetPathFileName(path);
+	return std::string(path, name) + "_processed/" + name;
+}
+
+// files and subdirectories of dir (not recursive, skips '.' entries), joined to dir with '/'
+static void GetDirectoryEntries(std::vector<std::string>* files, std::vector<std::string>* subdirs, const char* dir)
+{
+#if defined(__linux__)
+	DIR* d = opendir(dir);
+	if (d) {
+		while (const dirent* entry = readdir(d)) {
+			if (entry->d_name[0] == '.')
+				continue;
+			const std::string path = varString("%s/%s", dir, entry->d_name).c_str();
+			bool isDir = entry->d_type == DT_DIR;
+			if (entry->d_type == DT_UNKNOWN || entry->d_type == DT_LNK) { // some filesystems don't fill in d_type
+				struct stat st;
+				isDir = stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+			}
+			std::vector<std::string>* entries = isDir ? subdirs : files;
+			if (entries)
+				entries->push_back(path);
+		}
+		closedir(d);
+	}
+#else
+	WIN32_FIND_DATAA data;
+	HANDLE h = FindFirstFileA(varString("%s/*", dir).c_str(), &data);
+	if (h != INVALID_HANDLE_VALUE) {
+		do {
+			if (data.cFileName[0] == '.')
+				continue;
+			std::vector<std::string>* entries = (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) ? subdirs : files;
+			if (entries)
+				entries->push_back(varString("%s/%s", dir, data.cFileName).c_str());
+		} while (FindNextFileA(h, &data));
+		FindClose(h);
+	}
+#endif
+	if (files)
+		std::sort(files->begin(), files->end()); // so runs and reports come out in the same order
+	if (subdirs)
+		std::sort(subdirs->begin(), subdirs->end());
+}
+
+static bool CreateDirectoryIfMissing(const char* dir)
+{
+	struct stat st;
+	if (stat(dir, &st) == 0)
+		return true;
+#if defined(__linux__)
+	return mkdir(dir, 0777) == 0;
+#else
+	return _mkdir(dir) == 0;
+#endif
+}
+
+static bool RenameFile(const char* from, const char* to) // replaces 'to' if it exists
+{
+#if defined(__linux__)
+	return rename(from, to) == 0; // atomic
+#else
+	return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING) != 0;
+#endif
+}
+
+// read-only memory mapped file
+class MappedFile
+{
+public:
+	MappedFile() : m_data(nullptr), m_size(0)
+	#if defined(__linux__)
+		, m_fd(-1)
+	#else
+		, m_file(INVALID_HANDLE_VALUE)
+		, m_mapping(nullptr)
+	#endif
+	{}
+	~MappedFile() { Close(); }
+
+	bool Open(const char* path)
+	{
+		Close();
+	#if defined(__linux__)
+		std::string native = path;
+		std::replace(native.begin(), native.end(), '\\', '/');
+		m_fd = open(native.c_str(), O_RDONLY);
+		struct stat st;
+		if (m_fd < 0 || fstat(m_fd, &st) != 0 || st.st_size == 0) {
+			Close();
+			return false;
+		}
+		void* data = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+		if (data == MAP_FAILED) {
+			Close();
+			return false;
+		}
+		m_data = (const uint8*)data;
+		m_size = (size_t)st.st_size;
+	#else
+		m_file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		LARGE_INTEGER size;
+		if (m_file == INVALID_HANDLE_VALUE || !GetFileSizeEx(m_file, &size) || size.QuadPart == 0) {
+			Close();
+			return false;
+		}
+		m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		m_data = m_mapping ? (const uint8*)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+		if (m_data == nullptr) {
+			Close();
+			return false;
+		}
+		m_size = (size_t)size.QuadPart;
+	#endif
+		return true;
+	}
+
+	void Close()
+	{
+	#if defined(__linux__)
+		if (m_data)
+			munmap((void*)m_data, m_size);
+		if (m_fd >= 0)
+			close(m_fd);
+		m_fd = -1;
+	#else
+		if (m_data)
+			UnmapViewOfFile(m_data);
+		if (m_mapping)
+			CloseHandle(m_mapping);
+		if (m_file != INVALID_HANDLE_VALUE)
+			CloseHandle(m_file);
+		m_mapping = nullptr;
+		m_file = INVALID_HANDLE_VALUE;
+	#endif
+		m_data = nullptr;
+		m_size = 0;
+	}
+
+	const uint8* m_data;
+	size_t m_size;
+
+private:
+#if defined(__linux__)
+	int m_fd;
+#else
+	HANDLE m_file;
+	HANDLE m_mapping;
+#endif
+};
+
+// GL-free shader preprocessor - expands #includes and applies define overrides. included files are read once into
+// a cache shared by every pass (and thread), so the common includes aren't reloaded per pass. SLIDER_VAR lines are
+// collected rather than registered, since the GUI must only be touched on the main thread (see RegisterSliderLines)
+class ShaderPreprocessor
+{
+public:
+	class SliderLine
+	{
+	public:
+		SliderLine(const std::string& path, uint32 lineIndex, const std::string& line) : m_path(path), m_lineIndex(lineIndex), m_line(line) {}
+		std::string m_path;
+		uint32 m_lineIndex; // 1-based
+		std::string m_line;
+	};
+
+	class SourceFile
+	{
+	public:
+		SourceFile() : m_exists(false), m_size(0) {}
+		bool m_exists;
+		size_t m_size; // sum of line lengths plus newlines
+		std::vector<std::string> m_lines; // without line endings
+	};
+
+	ShaderPreprocessor(const std::map<std::string,std::string>* defineOverrides, std::vector<SliderLine>* sliderLines, std::vector<std::string>* dependencies = nullptr)
+		: m_defineOverrides(defineOverrides)
+		, m_sliderLines(sliderLines)
+		, m_dependencies(dependencies)
+	{}
+
+	// appends the expanded contents of path to code
+	void Process(std::string& code, const char* path)
+	{
+		std::map<std::string,bool> included;
+		code.reserve(code.size() + GetExpandedSize(path, included));
+		included.clear();
+		ProcessInternal(code, path, included);
+	}
+
+	static const SourceFile& GetFile(const std::string& path)
+	{
+		FileCache& cache = GetFileCache();
+		{
+			std::lock_guard<std::mutex> lock(cache.m_mutex);
+			const auto f = cache.m_files.find(path);
+			if (f != cache.m_files.end())
+				return *f->second;
+		}
+		SourceFile* file = new SourceFile(); // load outside the lock so other threads can get at other files
+		FILE* fp = fopen(path.c_str(), "rb");
+		if (fp) {
+			file->m_exists = true;
+			fseek(fp, 0, SEEK_END);
+			const long len = ftell(fp);
+			fseek(fp, 0, SEEK_SET);
+			std::vector<char> data(len > 0 ? len : 0);
+			if (len > 0 && fread(data.data(), 1, len, fp) != (size_t)len)
+				data.clear();
+			fclose(fp);
+			const char* s = data.data();
+			const char* end = s + data.size();
+			while (s < end) {
+				const char* eol = s;
+				while (eol < end && *eol != '\n')
+					eol++;
+				const char* lineEnd = (eol > s && eol[-1] == '\r') ? eol - 1 : eol;
+				file->m_lines.push_back(std::string(s, lineEnd));
+				file->m_size += (lineEnd - s) + 1;
+				s = eol + 1;
+			}
+		}
+		std::lock_guard<std::mutex> lock(cache.m_mutex);
+		const auto f = cache.m_files.find(path);
+		if (f != cache.m_files.end()) { // another thread got there first
+			delete file;
+			return *f->second;
+		}
+		cache.m_files[path] = file;
+		return *file;
+	}
+
+	static uint32 GetNumCachedFiles()
+	{
+		FileCache& cache = GetFileCache();
+		std::lock_guard<std::mutex> lock(cache.m_mutex);
+		return (uint32)cache.m_files.size();
+	}
+
+	static void ClearFileCache() // call before reloading shaders so edits are seen
+	{
+		FileCache& cache = GetFileCache();
+		std::lock_guard<std::mutex> lock(cache.m_mutex);
+		for (auto it = cache.m_files.begin(); it != cache.m_files.end(); ++it)
+			delete it->second;
+		cache.m_files.clear();
+	}
+
+private:
+	class FileCache
+	{
+	public:
+		std::mutex m_mutex;
+		std::map<std::string,SourceFile*> m_files;
+	};
+
+	static FileCache& GetFileCache()
+	{
+		static FileCache cache;
+		return cache;
+	}
+
+	static std::string GetIncludePath(const char* path, const char* line, std::string& includeName)
+	{
+		const char* begin = strchr(line, '\"');
+		if (begin) {
+			const char* end = strchr(++begin, '\"');
+			if (end) {
+				includeName = GetPortablePath(std::string(begin, end));
+				return std::string(path, GetPathFileName(path)) + includeName;
+			}
+		}
+		return "";
+	}
+
+	static const char* SkipWhitespace(const char* s)
+	{
+		while (*s == ' ' || *s == '\t')
+			s++;
+		return s;
+	}
+
+	size_t GetExpandedSize(const char* path, std::map<std::string,bool>& included) const // upper bound for the reserve
+	{
+		const SourceFile& file = GetFile(path);
+		size_t size = file.m_size;
+		for (uint32 i = 0; i < file.m_lines.size(); i++) {
+			const char* s = SkipWhitespace(file.m_lines[i].c_str());
+			if (strstr(s, "#include") == s) {
+				std::string includeName;
+				const std::string includePath = GetIncludePath(path, s, includeName);
+				if (!includePath.empty() && included.find(includePath) == included.end()) {
+					included[includePath] = true;
+					size += GetExpandedSize(includePath.c_str(), included) + 2*(file.m_lines[i].size() + 32);
+				}
+			}
+		}
+		return size;
+	}
+
+	void ProcessInternal(std::string& code, const char* path, std::map<std::string,bool>& included)
+	{
+		const SourceFile& file = GetFile(path);
+		if (m_dependencies)
+			m_dependencies->push_back(path);
+		for (uint32 i = 0; i < file.m_lines.size(); i++) {
+			const std::string& line = file.m_lines[i];
+			const char* s = SkipWhitespace(line.c_str());
+			if (m_sliderLines && strstr(s, "SLIDER_VAR(") == s)
+				m_sliderLines->push_back(SliderLine(path, i + 1, line));
+			if (strstr(s, "#include") == s) {
+				std::string includeName;
+				const std::string includePath = GetIncludePath(path, s, includeName);
+				if (!includePath.empty()) {
+					if (included.find(includePath) == included.end()) {
+						included[includePath] = true;
+						code += "//<=== BEGIN ";
+						code += line;
+						code += " ===>\n";
+						ProcessInternal(code, includePath.c_str(), included);
+						code += "//<=== END ";
+						code += line;
+						code += " ===>\n";
+					}
+					continue;
+				}
+			}
+			if (m_defineOverrides && strstr(s, SHADER_DEFINE_STRING) == s) {
+				const char* d = s + strlen(SHADER_DEFINE_STRING);
+				const char* dEnd = d;
+				while (*dEnd && *dEnd != ' ' && *dEnd != '\t')
+					dEnd++;
+				const auto it = m_defineOverrides->find(std::string(d, dEnd));
+				if (it != m_defineOverrides->end() && !it->second.empty()) {
+					code += SHADER_DEFINE_STRING;
+					code += it->first;
+					code += " ";
+					code += it->second;
+					code += "\n";
+					continue;
+				}
+			}
+			code += line;
+			code += "\n";
+		}
+	}
+
+	const std::map<std::string,std::string>* m_defineOverrides;
+	std::vector<SliderLine>* m_sliderLines;
+	std::vector<std::string>* m_dependencies; // every file read, for hot reload
+};
+
+// the include expansion ShaderPreprocessor replaced (minus the slider registration), rereads every file for every
+// pass - only used by -preprocess_bench now, as the baseline
+static void LoadShaderCodeInternal(
+	std::string& code,
+	const char* path,
+	std::map<std::string,bool>& included,
+	const std::map<std::string,std::string>* defineOverrides)
+{
+	FILE* file = fopen(path, "r");
+	if (file) {
+		char line[SHADER_CODE_MAX_LINE_SIZE];
+		char temp[SHADER_CODE_MAX_LINE_SIZE];
+		while (fgets(line, sizeof(line), file)) {
+			char* end = strpbrk(line, "\r\n");
+			if (end)
+				*end = '\0';
+			char* s = line;
+			while (*s == ' ' || *s == '\t')
+				s++;
+			if (strstr(s, "#include") == s) {
+				strcpy(temp, s);
+				char* includePathBegin = strchr(temp, '\"');
+				if (includePathBegin) {
+					*includePathBegin++ = '\0';
+					char* includePathEnd = strchr(includePathBegin, '\"');
+					if (includePathEnd) {
+						*includePathEnd = '\0';
+						char includePath[512];
+						strcpy(includePath, path);
+						s = nullptr;
+						for (char* c = includePath; *c; c++) // last separator, either kind
+							if (*c == '\\' || *c == '/')
+								s = c;
+						if (s)
+							s[1] = '\0';
+						strcat(includePath, includePathBegin);
+						if (included.find(includePath) == included.end()) {
+							included[includePath] = true;
+							code += varString("//<=== BEGIN %s ===>\n", line);
+							LoadShaderCodeInternal(code, includePath, included, defineOverrides);
+							code += varString("//<=== END %s ===>\n", line);
+						}
+						continue;
+					}
+				}
+			}
+			if (defineOverrides && strstr(s, SHADER_DEFINE_STRING) == s) {
+				strcpy(temp, s + strlen(SHADER_DEFINE_STRING));
+				const char* d = strtok(temp, " \t");
+				const auto it = defineOverrides->find(d);
+				if (it != defineOverrides->end() && !it->second.empty()) {
+					code += varString("%s%s %s\n", SHADER_DEFINE_STRING, d, it->second.c_str());
+					continue;
+				}
+			}
+			code += varString("%s\n", line);
+		}
+		fclose(file);
+	}
+}
+
+#if USE_GUI
+static void RegisterSliderLines(const std::vector<ShaderPreprocessor::SliderLine>& sliderLines)
+{
+	if (g_GUIEnabled) {
+		for (uint32 i = 0; i < sliderLines.size(); i++)
+			GUISlider::AddSlider(sliderLines[i].m_path.c_str(), sliderLines[i].m_lineIndex, sliderLines[i].m_line.c_str());
+	}
+}
+#endif // USE_GUI
+
+// watches files for changes. on linux this uses inotify on the containing directories (so editors which save by
+// renaming a temp file over the original are still seen), elsewhere it polls modification times
+class FileWatcher
+{
+public:
+	FileWatcher() : m_lastPollTime(0)
+	{
+	#if defined(__linux__)
+		m_fd = inotify_init1(IN_NONBLOCK);
+		if (m_fd < 0)
+			fprintf(stderr, "inotify_init1 failed, falling back to polling for file changes\n");
+	#endif
+	}
+
+	void Watch(const std::string& path) // path as used elsewhere
+	{
+		if (m_files.find(path) != m_files.end())
+			return;
+		m_files[path] = GetModifiedTime(path);
+	#if defined(__linux__)
+		if (m_fd >= 0) {
+			const std::string native = GetNativePath(path);
+			const size_t slash = native.find_last_of('/');
+			const std::string dir = slash == std::string::npos ? "." : native.substr(0, slash);
+			if (m_watchedDirs.find(dir) == m_watchedDirs.end()) {
+				const int wd = inotify_add_watch(m_fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+				if (wd >= 0) {
+					m_watchedDirs[dir] = wd;
+					m_dirs[wd] = dir;
+				}
+			}
+		}
+	#endif
+	}
+
+	// appends the watched files which changed since the last poll
+	void Poll(std::vector<std::string>& changed)
+	{
+	#if defined(__linux__)
+		if (m_fd >= 0) {
+			char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+			std::map<std::string,bool> names;
+			ssize_t len;
+			while ((len = read(m_fd, buf, sizeof(buf))) > 0) {
+				for (char* p = buf; p < buf + len; p += sizeof(struct inotify_event) + ((struct inotify_event*)p)->len) {
+					const struct inotify_event* e = (const struct inotify_event*)p;
+					const auto d = m_dirs.find(e->wd);
+					if (d != m_dirs.end() && e->len > 0)
+						names[d->second + "/" + e->name] = true;
+				}
+			}
+			for (auto it = m_files.begin(); it != m_files.end(); ++it)
+				if (names.find(GetNativePath(it->first)) != names.end())
+					changed.push_back(it->first);
+			return;
+		}
+	#endif
+		if (ProgressDisplay::GetTimeInSeconds(m_lastPollTime) < 0.25f)
+			return; // stat'ing every file every frame is a waste
+		m_lastPollTime = ProgressDisplay::GetCurrentPerformanceTime();
+		for (auto it = m_files.begin(); it != m_files.end(); ++it) {
+			const time_t t = GetModifiedTime(it->first);
+			if (t != it->second) {
+				it->second = t;
+				changed.push_back(it->first);
+			}
+		}
+	}
+
+private:
+	static std::string GetNativePath(const std::string& path)
+	{
+		std::string native = path;
+	#if defined(__linux__)
+		for (size_t i = 0; i < native.size(); i++)
+			if (native[i] == '\\')
+				native[i] = '/';
+	#endif
+		return native;
+	}
+
+	static time_t GetModifiedTime(const std::string& path)
+	{
+		struct stat st;
+		if (stat(GetNativePath(path).c_str(), &st) == 0)
+			return st.st_mtime;
+		return 0;
+	}
+
+	std::map<std::string,time_t> m_files;
+	uint64 m_lastPollTime;
+#if defined(__linux__)
+	int m_fd;
+	std::map<std::string,int> m_watchedDirs;
+	std::map<int,std::string> m_dirs;
+#endif
+};
+
+static std::string GetShaderProcessedPathForSource(const char* path, const char* processedPathExt, GLenum target)
+{
+	if (processedPathExt)
+		ForceAssert(processedPathExt[0] == '_'); // should start with underscore
+	const char* ext = ".glsl";
+	switch (target) { // glslangValidator compatibility
+	case GL_VERTEX_SHADER         : ext = ".vert"; break;
+	case GL_TESS_CONTROL_SHADER   : ext = ".tesc"; break;
+	case GL_TESS_EVALUATION_SHADER: ext = ".tese"; break;
+	case GL_GEOMETRY_SHADER       : ext = ".geom"; break;
+	case GL_FRAGMENT_SHADER       : ext = ".frag"; break;
+	case GL_COMPUTE_SHADER        : ext = ".comp"; break;
+	}
+	return GetProcessedPath(PathExt(path, "_processed%s%s", processedPathExt ? processedPathExt : "", ext));
+}
+
+// builds the full source for a shader and writes it to processedPath (if not empty). no GL calls, so this can run on
+// a JobSystem thread - processedPath comes from GetShaderProcessedPathForSource on the main thread
+static void PreprocessShader(
+	std::string& code,
+	const char* processedPath,
+	const char* path,
+	GLenum target,
+	const char* versionStr,
+	const std::map<std::string,std::string>* defineOverrides = nullptr,
+	const std::vector<std::string>* sourceHeader = nullptr,
+	const std::vector<std::string>* sourceFooter = nullptr,
+	std::vector<ShaderPreprocessor::SliderLine>* sliderLines = nullptr,
+	std::vector<std::string>* dependencies = nullptr)
+{
+	TRACE_SCOPE_DETAIL("PreprocessShader", path);
+	size_t headerSize = 1024;
+	if (sourceHeader)
+		for (uint32 i = 0; i < sourceHeader->size(); i++)
+			headerSize += sourceHeader->operator[](i).size() + 1;
+	if (sourceFooter)
+		for (uint32 i = 0; i < sourceFooter->size(); i++)
+			headerSize += sourceFooter->operator[](i).size() + 1;
+	code.clear();
+	code.reserve(headerSize); // ShaderPreprocessor::Process reserves the rest
+	if (versionStr) {
+		code += versionStr;
+		code += "\n";
+	}
+	if (g_GPUShader5 && target == GL_FRAGMENT_SHADER) {
+		code += "#extension GL_NV_gpu_shader5 : enable\n";
+		code += "#extension GL_NV_bindless_texture : enable\n"; // just so i can pass samplers around as uint64_t's ..
+		code += "#extension GL_ARB_derivative_control : enable\n";
+		code += "#define _GPU_SHADER_5_\n";
+	}
+	code += "#define _SHADERTOY_PLAYER_VERSION_ 1\n";
+	if (defineOverrides) {
+		code += "//<=== BEGIN DEFINES ===>\n";
+		for (auto iter = defineOverrides->begin(); iter != defineOverrides->end(); ++iter)
+			if (iter->second.empty())
+				code += varString("%s%s\n", SHADER_DEFINE_STRING, iter->first.c_str());
+		code += "//<=== END DEFINES ===>\n";
+	}
+	if (sourceHeader) {
+		for (uint32 i = 0; i < sourceHeader->size(); i++) {
+			code += sourceHeader->operator[](i);
+			code += "\n";
+		}
+	}
+	ShaderPreprocessor(defineOverrides, sliderLines, dependencies).Process(code, path);
+	if (sourceFooter) {
+		for (uint32 i = 0; i < sourceFooter->size(); i++) {
+			code += sourceFooter->operator[](i);
+			code += "\n";
+		}
+	}
+	if (processedPath && processedPath[0]) {
+		FILE* file = fopen(processedPath, "wb");
+		if (file) {
+			fwrite(code.c_str(), 1, code.size(), file);
+			fclose(file);
+		}
+	}
+}
+
+// compiles are split into submit and finish so that with GL_ARB_parallel_shader_compile the driver can work on all
+// of them at once - querying GL_COMPILE_STATUS right after glCompileShader would block
+static void SubmitShaderCompile(GLuint& shaderID, const std::string& code, const char* processedPath, GLenum target)
+{
+	TRACE_SCOPE_DETAIL("SubmitShaderCompile", processedPath);
+	if (shaderID == 0)
+		shaderID = glCreateShader(target);
+	ForceAssert(g_ShaderToProcessedPath[target].find(shaderID) == g_ShaderToProcessedPath[target].end()); // make sure we don't collide
+	g_ShaderToProcessedPath[target][shaderID] = processedPath;
+	g_ShaderSourceHash[shaderID] = Crc64(code.c_str(), code.size(), 0);
+	const char* codeStr = code.c_str();
+	g_CurrentShaderBeingCompiled = processedPath;
+	glShaderSource(shaderID, 1, (const GLcharARB**)&codeStr, nullptr);
+	glCompileShader(shaderID);
+	g_CurrentShaderBeingCompiled = nullptr;
+}
+
+static bool FinishShaderCompile(GLuint shaderID, const char* processedPath)
+{
+	TRACE_SCOPE_DETAIL("FinishShaderCompile", processedPath);
+	GLint compileStatus = 0;
+	glGetShaderiv(shaderID, GL_COMPILE_STATUS, &compileStatus);
+	if (compileStatus == GL_TRUE)
+		return true;
+	else {
+		GLint maxLength = 0;
+		glGetShaderiv(shaderID, GL_INFO_LOG_LENGTH, &maxLength);
+		std::vector<GLchar> infoLog(maxLength);
+		glGetShaderInfoLog(shaderID, maxLength, &maxLength, infoLog.data());
+		fprintf(stderr, "compile (%s): %s\n", processedPath, infoLog.data());
+		if (1) { // insert compile error into processed shader text and open it ..
+			const char* s = strchr(infoLog.data(), '(');
+			if (s) {
+				const uint32 errorLineIndex = atoi(s + 1);
+				FILE* f1 = fopen(processedPath, "r");
+				if (f1) {
+					char processedPath2[512];
+					strcpy(processedPath2, PathExt(processedPath, "_error.txt"));
+					FILE* f2 = fopen(processedPath2, "w");
+					if (f2) {
+						uint32 lineIndex = 0;
+						char line[SHADER_CODE_MAX_LINE_SIZE];
+						bool lineFound = false;
+						while (fgets(line, sizeof(line), f1)) {
+							fprintf(f2, "%s", line);
+							if (++lineIndex == errorLineIndex) {
+								fprintf(f2, "%s\n", infoLog.data());
+								lineFound = true;
+								break; // TODO -- insert multiple errors?
+							}
+						}
+						if (!lineFound) {
+							fprintf(f2, "\n\nCOULD NOT FIND LINE %d TO INSERT ERROR!\n", errorLineIndex);
+							fprintf(f2, "%s\n", infoLog.data());
+						}
+						fclose(f2);
+						system(processedPath2); // open it
+					}
+					fclose(f1);
+				}
+			}
+		}
+		if (++g_NumShaderCompilerLinkErrors < 5 && !g_HotReloading && !g_Headless)
+			system("pause");
+		return false;
+	}
+}
+
+static bool CompileShader(GLuint& shaderID, const std::string& code, const char* processedPath, GLenum target)
+{
+	SubmitShaderCompile(shaderID, code, processedPath, target);
+	return FinishShaderCompile(shaderID, processedPath);
+}
+
+static bool LoadShader(
+	GLuint& shaderID,
+	const char* path,
+	const char* processedPathExt,
+	GLenum target,
+	const char* versionStr,
+	const std::map<std::string,std::string>* defineOverrides = nullptr,
+	const std::vector<std::string>* sourceHeader = nullptr,
+	const std::vector<std::string>* sourceFooter = nullptr)
+{
+	TRACE_SCOPE_DETAIL("LoadShader", path);
+	std::string code;
+	const std::string processedPath = GetShaderProcessedPathForSource(path, processedPathExt, target);
+	std::vector<ShaderPreprocessor::SliderLine> sliderLines;
+	PreprocessShader(code, processedPath.c_str(), path, target, versionStr, defineOverrides, sourceHeader, sourceFooter, &sliderLines);
+#if USE_GUI
+	RegisterSliderLines(sliderLines);
+#endif // USE_GUI
+	return CompileShader(shaderID, code, processedPath.c_str(), target);
+}
+
+static void AddCommentsToShaderASM(char*& text, bool flowControl = true)
+{
+	std::vector<std::string> lines;
+	char* buf = new char[strlen(text) + 1];
+	char* buf1 = buf;
+	strcpy(buf, text);
+	uint32 maxLen = 0;
+	while (true) {
+		char* line = strtok(buf1, "\r\n");
+		if (line) {
+			lines.push_back(line);
+			maxLen = Max((uint32)strlen(line), maxLen);
+			buf1 = nullptr;
+		} else
+			break;
+	}
+	maxLen += (uint32)varString("[line_%05u] ", 0).size();
+	delete[] text; // text has now been copied into lines	
+	class FlowControlStackElement
+	{
+	public:
+		FlowControlStackElement(int lineIf, bool isRep) : m_lineNum_IF(lineIf), m_lineNum_ELSE(-1), m_isRep(isRep) {}
+		int m_lineNum_IF;
+		int m_lineNum_ELSE;
+		bool m_isRep;
+	};
+	std::vector<FlowControlStackElement> flow;
+	for (uint32 i = 0; i < lines.size(); i++) {
+		const int lineNum = i + 1;
+		const char* line = lines[i].c_str();
+		std::string line2 = varString("[line_%05u] %s", lineNum, line);
+		while (line2.size() < maxLen)
+			line2 += " ";
+		line2 += " #";
+		if (flowControl) { // add relevant line numbers for program flow instructions (IF,ELSE,ENDIF,REP,ENDREP,BRK)
+			if (strstartswith(line, "IF ")) {
+				flow.push_back(FlowControlStackElement(lineNum, false));
+			} else if (strstartswith(line, "ELSE;")) {
+				ForceAssert(!flow.empty());
+				ForceAssert(!flow.back().m_isRep);
+				ForceAssert(flow.back().m_lineNum_ELSE == -1);
+				flow.back().m_lineNum_ELSE = lineNum;
+			} else if (strstartswith(line, "ENDIF;")) {
+				ForceAssert(!flow.empty());
+				ForceAssert(!flow.back().m_isRep);
+				line2 += varString(" IF:[line_%05u]", (uint32)flow.back().m_lineNum_IF);
+				lines[flow.back().m_lineNum_IF - 1] += varString(" IF:[line_%05u]", (uint32)flow.back().m_lineNum_IF); // self
+				if (flow.back().m_lineNum_ELSE != -1) {
+					line2 += varString(" ELSE:[line_%05u]", (uint32)flow.back().m_lineNum_ELSE);
+					lines[flow.back().m_lineNum_IF - 1] += varString(" ELSE:[line_%05u]", (uint32)flow.back().m_lineNum_ELSE);
+					lines[flow.back().m_lineNum_ELSE - 1] += varString(" IF:[line_%05u]", (uint32)flow.back().m_lineNum_IF);
+					lines[flow.back().m_lineNum_ELSE - 1] += varString(" ELSE:[line_%05u]", (uint32)flow.back().m_lineNum_ELSE); // self
+					lines[flow.back().m_lineNum_ELSE - 1] += varString(" ENDIF:[line_%05u]", lineNum);
+				}
+				lines[flow.back().m_lineNum_IF - 1] += varString(" ENDIF:[line_%05u]", lineNum);
+				line2 += varString(" ENDIF:[line_%05u]", lineNum); // self
+				flow.pop_back();
+			} else if (strstartswith(line, "REP.S ")) {
+				flow.push_back(FlowControlStackElement(lineNum, true));
+			} else if (strstartswith(line, "ENDREP;")) {
+				ForceAssert(!flow.empty());
+				ForceAssert(flow.back().m_isRep);
+				ForceAssert(flow.back().m_lineNum_ELSE == -1);
+				line2 += varString(" REP:[line_%05u]", (uint32)flow.back().m_lineNum_IF);
+				lines[flow.back().m_lineNum_IF - 1] += varString(" REP:[line_%05u]", (uint32)flow.back().m_lineNum_IF); // self
+				lines[flow.back().m_lineNum_IF - 1] += varString(" ENDREP:[line_%05u]", lineNum);
+				line2 += varString(" ENDREP:[line_%05u]", lineNum); // self
+				flow.pop_back();
+			} else if (strstartswith(line, "BRK ")) {
+				ForceAssert(!flow.empty());
+				int repIndex = -1;
+				for (int j = (int)flow.size() - 1; j >= 0; j--) {
+					if (flow[j].m_isRep) {
+						repIndex = j;
+						break;
+					}
+				}
+				ForceAssert(repIndex != -1);
+				line2 += varString(" REP:[line_%05u]", (uint32)flow[repIndex].m_lineNum_IF); // TODO -- show ENDREP line number, also BRK line numbers on REP/ENDREP lines
+			}
+		}
+		lines[i] = line2;
+	}
+	std::string text2 = "";
+	for (uint32 i = 0; i < lines.size(); i++)
+		text2 += varString("%s\n", lines[i].c_str());
+	text = new char[text2.size() + 1];
+	strcpy(text, text2.c_str());
+	delete[] buf;
+}
+
+static const char* GetShaderProcessedPath(GLuint programID)
+{
+	if (programID != 0) {
+		const auto f = g_ShaderToProcessedPath[GL_SHADER].find(programID);
+		if (f != g_ShaderToProcessedPath[GL_SHADER].end())
+			return f->second.c_str();
+		else
+			return "UNKNOWN";
+	} else
+		return "NONE";
+}
+
+static void SubmitProgramLink(GLuint& programID, GLuint vertexShaderID, GLuint fragmentShaderID) // no vertex shader for compute programs
+{
+	TRACE_SCOPE("SubmitProgramLink");
+	if (programID == 0)
+		programID = glCreateProgram();
+	ForceAssert(fragmentShaderID != 0);
+	if (vertexShaderID)
+		glAttachShader(programID, vertexShaderID);
+	glAttachShader(programID, fragmentShaderID);
+	glProgramParameteri(programID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE); // for the asm dump and the program binary cache
+	glLinkProgram(programID);
+}
+
+static bool FinishProgramLink(GLuint programID, GLuint vertexShaderID, GLuint fragmentShaderID, bool dumpASM = true)
+{
+	TRACE_SCOPE("FinishProgramLink");
+	const char* vsPath = "?";
+	const char* fsPath = "?";
+	const auto vs = g_ShaderToProcessedPath[GL_VERTEX_SHADER].find(vertexShaderID);
+	if (vs != g_ShaderToProcessedPath[GL_VERTEX_SHADER].end()) {
+		vsPath = GetPathFileName(vs->second.c_str());
+	}
+	const GLenum fsTarget = g_ShaderToProcessedPath[GL_COMPUTE_SHADER].count(fragmentShaderID) ? GL_COMPUTE_SHADER : GL_FRAGMENT_SHADER;
+	const auto fs = g_ShaderToProcessedPath[fsTarget].find(fragmentShaderID);
+	if (fs != g_ShaderToProcessedPath[fsTarget].end()) {
+		fsPath = GetPathFileName(fs->second.c_str());
+	}
+	GLint linkStatus = 0;
+	glGetProgramiv(programID, GL_LINK_STATUS, &linkStatus);
+	if (linkStatus == GL_TRUE) {
+		g_ShaderToProcessedPath[GL_SHADER][programID] = varString("(vs=%s, fs=%s)", vsPath, fsPath);
+		BuildProgramUniformLocations(programID);
+		//fprintf(stderr, "link successful - (vs=%s, fs=%s)\n", vsPath, fsPath);
+		if (dumpASM) {
+			// http://www.renderguild.com/gpuguide.pdf
+			GLint len = 0;
+			glGetProgramiv(programID, GL_PROGRAM_BINARY_LENGTH, &len);
+			if (len > 0) {
+				char* bin = new char[len];
+				GLenum format = GL_NONE;
+				glGetProgramBinary(programID, len, nullptr, &format, bin);
+				FILE* f = fopen(PathExt(fs->second.c_str(), "_asm.txt"), "w");
+				if (f) {
+					const char* shaderTextStart = "!!NV"; // e.g. "!!NVfp5.0"
+					const char* shaderTextEnd = "END\n";
+					char* s1 = bin;
+					uint32 numShaders = 0;
+					while (s1 < bin + len) {
+						if (strncmp(s1, shaderTextStart, strlen(shaderTextStart)) == 0) {
+							char* s2 = s1 + strlen(shaderTextStart);
+							while (s2 < bin + len) {
+								if (strncmp(s2, shaderTextEnd, strlen(shaderTextEnd)) == 0) {
+									s2 += strlen(shaderTextEnd);
+									const size_t shaderTextLength = (ptrdiff_t)(s2 - s1);
+									char* temp = new char[shaderTextLength + 1];
+									memcpy(temp, s1, shaderTextLength);
+									temp[shaderTextLength] = '\0';
+									AddCommentsToShaderASM(temp);
+									fprintf(f, "%s\n", temp);
+									numShaders++;
+									s1 = s2;
+									delete[] temp;
+									break;
+								} else
+									s2++;
+							}
+							if (s1 != s2) {
+								fprintf(f, "no end found!\n");
+								break;
+							}
+						} else
+							s1++;
+					}
+					bool dumpBinary = true;//false;
+					if (numShaders == 0) {
+						fprintf(f, "no shaders found!\n");
+						fprintf(f, "dumping binary data ..\n\n");
+						dumpBinary = true;
+					}
+					if (dumpBinary) {
+						FILE* f2 = fopen(PathExt(fs->second.c_str(), "_asm.bin"), "wb");
+						if (f2) {
+							fwrite(bin, sizeof(char), len, f2);
+							fclose(f2);
+						}
+					}
+					fclose(f);
+				}
+				delete[] bin;
+			}
+		}
+		return true;
+	} else {
+		GLint maxLength = 0;
+		glGetProgramiv(programID, GL_INFO_LOG_LENGTH, &maxLength);
+		std::vector<GLchar> infoLog(maxLength);
+		glGetProgramInfoLog(programID, maxLength, &maxLength, &infoLog[0]);
+		fprintf(stderr, "link error (vs=%s, fs=%s): %s\n", vsPath, fsPath, infoLog.data());
+		if (++g_NumShaderCompilerLinkErrors < 5 && !g_HotReloading && !g_Headless)
+			system("pause");
+		return false;
+	}
+}
+
+static bool CreateShaderProgram(GLuint& programID, GLuint vertexShaderID, GLuint fragmentShaderID, bool dumpASM = true)
+{
+	TRACE_SCOPE("CreateShaderProgram");
+	SubmitProgramLink(programID, vertexShaderID, fragmentShaderID);
+	return FinishProgramLink(programID, vertexShaderID, fragmentShaderID, dumpASM);
+}
+
+#define VERTEX_SHADER_VERSION_STR "#version 440"
+#define FRAGMENT_SHADER_VERSION_STR "#version 440"
+
+// program binaries are cached in _processed/<pass>_program.bin, keyed by the preprocessed vertex and fragment source
+// (which already has the define overrides expanded) and the driver. a stale or rejected binary is just recompiled.
+class ProgramBinaryCacheHeader
+{
+public:
+	enum { MAGIC = 0x42505453, VERSION = 1 }; // 'STPB'
+	uint32 m_magic;
+	uint32 m_version;
+	uint64 m_key;
+	uint32 m_format;
+	uint32 m_length;
+};
+
+static uint64 GetProgramBinaryCacheKey(uint64 vertexSourceHash, uint64 fragmentSourceHash)
+{
+	uint64 key = Crc64(vertexSourceHash, 0);
+	key = Crc64(fragmentSourceHash, key);
+	const GLenum strings[] = {GL_VENDOR, GL_RENDERER, GL_VERSION};
+	for (int i = 0; i < icountof(strings); i++) {
+		const char* str = (const char*)glGetString(strings[i]);
+		if (str)
+			key = Crc64(str, strlen(str), key);
+	}
+	return key;
+}
+
+static bool LoadProgramBinary(GLuint& programID, const char* binaryPath, uint64 key)
+{
+	bool loaded = false;
+	FILE* file = fopen(binaryPath, "rb");
+	if (file) {
+		ProgramBinaryCacheHeader header;
+		if (fread(&header, sizeof(header), 1, file) == 1 &&
+			header.m_magic == ProgramBinaryCacheHeader::MAGIC &&
+			header.m_version == ProgramBinaryCacheHeader::VERSION &&
+			header.m_key == key) {
+			std::vector<char> bin(header.m_length);
+			if (fread(bin.data(), 1, header.m_length, file) == header.m_length) {
+				programID = glCreateProgram();
+				glProgramBinary(programID, header.m_format, bin.data(), header.m_length);
+				GLint linkStatus = 0;
+				glGetProgramiv(programID, GL_LINK_STATUS, &linkStatus);
+				if (linkStatus == GL_TRUE)
+					loaded = true;
+				else {
+					printf("program binary \"%s\" was rejected by the driver, recompiling ..\n", binaryPath);
+					glDeleteProgram(programID);
+					programID = 0;
+				}
+			}
+		}
+		fclose(file);
+	}
+	return loaded;
+}
+
+static void SaveProgramBinary(GLuint programID, const char* binaryPath, uint64 key)
+{
+	GLint len = 0;
+	glGetProgramiv(programID, GL_PROGRAM_BINARY_LENGTH, &len);
+	if (len > 0) {
+		ProgramBinaryCacheHeader header;
+		header.m_magic = ProgramBinaryCacheHeader::MAGIC;
+		header.m_version = ProgramBinaryCacheHeader::VERSION;
+		header.m_key = key;
+		header.m_length = (uint32)len;
+		GLenum format = GL_NONE;
+		std::vector<char> bin(len);
+		glGetProgramBinary(programID, len, nullptr, &format, bin.data());
+		header.m_format = format;
+		FILE* file = fopen(binaryPath, "wb");
+		if (file) {
+			fwrite(&header, sizeof(header), 1, file);
+			fwrite(bin.data(), 1, len, file);
+			fclose(file);
+		}
+	}
+}
+
+// a program load in flight. the steps are:
+// PrepareShaderProgram (main thread) - works out the paths
+// PreprocessShaderProgram (any thread) - builds the source, no GL calls
+// SubmitShaderProgram (main thread) - loads the cached binary or starts the compile and link
+// FinishShaderProgram (main thread) - collects the results, call IsReady first to avoid blocking
+class ShaderProgramRequest
+{
+public:
+	ShaderProgramRequest() : m_valid(false), m_target(GL_FRAGMENT_SHADER), m_programID(0), m_vertexShaderID(0), m_fragmentShaderID(0), m_ownsVertexShader(false), m_fromCache(false), m_linked(false), m_key(0) {}
+
+	bool IsReady() const
+	{
+		if (m_programID == 0 || m_fromCache || !g_ParallelShaderCompile)
+			return true;
+		GLint completionStatus = GL_TRUE;
+		glGetProgramiv(m_programID, GL_COMPLETION_STATUS_ARB, &completionStatus);
+		return completionStatus == GL_TRUE;
+	}
+
+	bool m_valid; // fragment shader exists
+	GLenum m_target; // GL_FRAGMENT_SHADER, or GL_COMPUTE_SHADER for $COMPUTE passes (the "fragment" members hold the compute shader)
+	std::string m_vertexShaderPath;
+	std::string m_fragmentShaderPath;
+	std::vector<std::string> m_fragmentSourceHeader;
+	std::vector<std::string> m_fragmentSourceFooter;
+	std::string m_vertexCode; // released after submit
+	std::string m_fragmentCode;
+	std::vector<ShaderPreprocessor::SliderLine> m_sliderLines; // register these before submitting (see RegisterSliderLines)
+	std::vector<std::string> m_sourceFiles; // pass file, vertex shader and includes
+	GLuint m_programID;
+	GLuint m_vertexShaderID;
+	GLuint m_fragmentShaderID;
+	bool m_ownsVertexShader;
+	bool m_fromCache;
+	bool m_linked;
+	std::string m_vertexProcessedPath;
+	std::string m_fragmentProcessedPath;
+	std::string m_binaryPath;
+	uint64 m_key;
+};
+
+static bool PrepareShaderProgram(ShaderProgramRequest& request, const char* fragmentShaderPath,
+	std::vector<std::string>* fragmentShaderSourceHeader = nullptr, // moved into the request
+	std::vector<std::string>* fragmentShaderSourceFooter = nullptr,
+	GLenum target = GL_FRAGMENT_SHADER)
+{
+	request.m_valid = FileExists(fragmentShaderPath);
+	if (request.m_valid) {
+		request.m_target = target;
+		request.m_fragmentShaderPath = fragmentShaderPath;
+		request.m_fragmentProcessedPath = GetShaderProcessedPathForSource(fragmentShaderPath, nullptr, target);
+		char vertexShaderPath[512];
+		strcpy(vertexShaderPath, PathExt(fragmentShaderPath, "_vs.glsl"));
+		request.m_ownsVertexShader = target == GL_FRAGMENT_SHADER && FileExists(vertexShaderPath);
+		if (request.m_ownsVertexShader) {
+			request.m_vertexShaderPath = vertexShaderPath;
+			request.m_vertexProcessedPath = GetShaderProcessedPathForSource(vertexShaderPath, nullptr, GL_VERTEX_SHADER);
+		}
+		request.m_binaryPath = GetProcessedPath(PathExt(fragmentShaderPath, "_program.bin"));
+		if (fragmentShaderSourceHeader)
+			request.m_fragmentSourceHeader.swap(*fragmentShaderSourceHeader);
+		if (fragmentShaderSourceFooter)
+			request.m_fragmentSourceFooter.swap(*fragmentShaderSourceFooter);
+	}
+	return request.m_valid;
+}
+
+static void PreprocessShaderProgram(ShaderProgramRequest& request)
+{
+	TRACE_SCOPE_DETAIL("PreprocessShaderProgram", request.m_fragmentShaderPath.c_str());
+	if (request.m_valid) {
+		if (request.m_ownsVertexShader)
+			PreprocessShader(request.m_vertexCode, request.m_vertexProcessedPath.c_str(), request.m_vertexShaderPath.c_str(), GL_VERTEX_SHADER, VERTEX_SHADER_VERSION_STR, nullptr, nullptr, nullptr, &request.m_sliderLines, &request.m_sourceFiles);
+		PreprocessShader(request.m_fragmentCode, request.m_fragmentProcessedPath.c_str(), request.m_fragmentShaderPath.c_str(), request.m_target, FRAGMENT_SHADER_VERSION_STR, nullptr, &request.m_fragmentSourceHeader, &request.m_fragmentSourceFooter, &request.m_sliderLines, &request.m_sourceFiles);
+	}
+}
+
+static bool SubmitShaderProgram(ShaderProgramRequest& request, GLuint commonVertexShaderID)
+{
+	if (!request.m_valid)
+		return false;
+	const bool isCompute = request.m_target == GL_COMPUTE_SHADER;
+	uint64 vertexSourceHash = 0;
+	if (request.m_ownsVertexShader)
+		vertexSourceHash = Crc64(request.m_vertexCode.c_str(), request.m_vertexCode.size(), 0);
+	else if (!isCompute)
+		vertexSourceHash = g_ShaderSourceHash[commonVertexShaderID];
+	request.m_key = GetProgramBinaryCacheKey(vertexSourceHash, Crc64(request.m_fragmentCode.c_str(), request.m_fragmentCode.size(), 0));
+	if (g_ProgramBinaryCache && LoadProgramBinary(request.m_programID, request.m_binaryPath.c_str(), request.m_key))
+		request.m_fromCache = true;
+	else {
+		if (request.m_ownsVertexShader)
+			SubmitShaderCompile(request.m_vertexShaderID, request.m_vertexCode, request.m_vertexProcessedPath.c_str(), GL_VERTEX_SHADER);
+		else if (!isCompute)
+			request.m_vertexShaderID = commonVertexShaderID;
+		if (request.m_vertexShaderID == 0 && !isCompute)
+			return false;
+		SubmitShaderCompile(request.m_fragmentShaderID, request.m_fragmentCode, request.m_fragmentProcessedPath.c_str(), request.m_target);
+		SubmitProgramLink(request.m_programID, request.m_vertexShaderID, request.m_fragmentShaderID); // fails cleanly if a compile failed
+	}
+	std::string().swap(request.m_vertexCode);
+	std::string().swap(request.m_fragmentCode);
+	return true;
+}
+
+static GLuint FinishShaderProgram(ShaderProgramRequest& request)
+{
+	if (request.m_fromCache) {
+		g_ShaderToProcessedPath[GL_SHADER][request.m_programID] = varString("(binary=%s)", request.m_binaryPath.c_str());
+		BuildProgramUniformLocations(request.m_programID);
+		g_ProgramBinaryCacheHits++;
+		request.m_linked = true;
+		return request.m_programID;
+	}
+	if (request.m_programID == 0)
+		return 0;
+	bool compiled = true;
+	if (request.m_ownsVertexShader && !FinishShaderCompile(request.m_vertexShaderID, request.m_vertexProcessedPath.c_str()))
+		compiled = false;
+	if (!FinishShaderCompile(request.m_fragmentShaderID, request.m_fragmentProcessedPath.c_str()))
+		compiled = false;
+	if (!compiled) { // don't report the link error too
+		glDeleteProgram(request.m_programID);
+		request.m_programID = 0;
+		return 0;
+	}
+	if (FinishProgramLink(request.m_programID, request.m_vertexShaderID, request.m_fragmentShaderID)) {
+		request.m_linked = true;
+		if (g_ProgramBinaryCache)
+			SaveProgramBinary(request.m_programID, request.m_binaryPath.c_str(), request.m_key);
+		g_ProgramBinaryCacheMisses++;
+	}
+	return request.m_programID;
+}
+
+static GLuint LoadShaderProgram(const char* fragmentShaderPath, GLuint commonVertexShaderID,
+	const std::vector<std::string>* fragmentShaderSourceHeader = nullptr,
+	const std::vector<std::string>* fragmentShaderSourceFooter = nullptr)
+{
+	ShaderProgramRequest request;
+	std::vector<std::string> header;
+	std::vector<std::string> footer;
+	if (fragmentShaderSourceHeader)
+		header = *fragmentShaderSourceHeader;
+	if (fragmentShaderSourceFooter)
+		footer = *fragmentShaderSourceFooter;
+	if (PrepareShaderProgram(request, fragmentShaderPath, &header, &footer)) {
+		PreprocessShaderProgram(request);
+	#if USE_GUI
+		RegisterSliderLines(request.m_sliderLines);
+	#endif // USE_GUI
+		if (SubmitShaderProgram(request, commonVertexShaderID))
+			return FinishShaderProgram(request);
+	}
+	return 0;
+}
+
+class TextureFormatInfo
+{
+public:
+	enum eSamplerType
+	{
+		SAMPLER_TYPE_FLOAT,        // e.g. 'sampler2D'
+		SAMPLER_TYPE_UNSIGNED_INT, // e.g. 'usampler2D'
+		SAMPLER_TYPE_SIGNED_INT,   // e.g. 'isampler2D'
+	};
+
+	TextureFormatInfo(DDS_DXGI_FORMAT format)
+		: m_formatQualifier("unknown")
+		, m_formatType("unknown")
+		, m_internalFormat(GL_NONE)
+		, m_format(GL_NONE)
+		, m_type(GL_NONE)
+		, m_samplerType(SAMPLER_TYPE_FLOAT)
+		, m_components(0)
+		, m_compressed(false)
+	{
+		switch (format) {
+		case DDS_DXGI_FORMAT_R8_UNORM:            m_formatQualifier = "r8";             m_internalFormat = GL_R8;             m_format = GL_RED;          m_type = GL_UNSIGNED_BYTE;                m_components = 1; break;
+		case DDS_DXGI_FORMAT_R8_SNORM:            m_formatQualifier = "r8_snorm";       m_internalFormat = GL_R8_SNORM;       m_format = GL_RED;          m_type = GL_BYTE;                         m_components = 1; break;
+		case DDS_DXGI_FORMAT_R16_UNORM:           m_formatQualifier = "r16";            m_internalFormat = GL_R16;            m_format = GL_RED;          m_type = GL_UNSIGNED_SHORT;               m_components = 1; break;
+		case DDS_DXGI_FORMAT_R16_SNORM:           m_formatQualifier = "r16_snorm";      m_internalFormat = GL_R16_SNORM;      m_format = GL_RED;          m_type = GL_SHORT;                        m_components = 1; break;
+		case DDS_DXGI_FORMAT_R16_FLOAT:           m_formatQualifier = "r16f";           m_internalFormat = GL_R16F;           m_format = GL_RED;          m_type = GL_HALF_FLOAT;                   m_components = 1; break;
+		case DDS_DXGI_FORMAT_R32_FLOAT:           m_formatQualifier = "r32f";           m_internalFormat = GL_R32F;           m_format = GL_RED;          m_type = GL_FLOAT;                        m_components = 1; break;
+		case DDS_DXGI_FORMAT_R8G8_UNORM:          m_formatQualifier = "rg8";            m_internalFormat = GL_RG8;            m_format = GL_RG;           m_type = GL_UNSIGNED_BYTE;                m_components = 2; break;
+		case DDS_DXGI_FORMAT_R8G8_SNORM:          m_formatQualifier = "rg8_snorm";      m_internalFormat = GL_RG8_SNORM;      m_format = GL_RG;           m_type = GL_BYTE;                         m_components = 2; break;
+		case DDS_DXGI_FORMAT_R16G16_UNORM:        m_formatQualifier = "rg16";           m_internalFormat = GL_RG16;           m_format = GL_RG;           m_type = GL_UNSIGNED_SHORT;               m_components = 2; break;
+		case DDS_DXGI_FORMAT_R16G16_SNORM:        m_formatQualifier = "rg16_snorm";     m_internalFormat = GL_RG16_SNORM;     m_format = GL_RG;           m_type = GL_SHORT;                        m_components = 2; break;
+		case DDS_DXGI_FORMAT_R16G16_FLOAT:        m_formatQualifier = "rg16f";          m_internalFormat = GL_RG16F;          m_format = GL_RG;           m_type = GL_HALF_FLOAT;                   m_components = 2; break;
+		case DDS_DXGI_FORMAT_R32G32_FLOAT:        m_formatQualifier = "rg32f";          m_internalFormat = GL_RG32F;          m_format = GL_RG;           m_type = GL_FLOAT;                        m_components = 2; break;
+		case DDS_DXGI_FORMAT_R8G8B8A8_UNORM:      m_formatQualifier = "rgba8";          m_internalFormat = GL_RGBA8;          m_format = GL_RGBA;         m_type = GL_UNSIGNED_BYTE;                m_components = 4; break;
+		case DDS_DXGI_FORMAT_R8G8B8A8_UNORM_SRGB: m_formatQualifier = "rgba8";          m_internalFormat = GL_SRGB8_ALPHA8;   m_format = GL_RGBA;         m_type = GL_UNSIGNED_BYTE;                m_components = 4; break;
+		case DDS_DXGI_FORMAT_R8G8B8A8_SNORM:      m_formatQualifier = "rgba8_snorm";    m_internalFormat = GL_RGBA8_SNORM;    m_format = GL_RGBA;         m_type = GL_BYTE;                         m_components = 4; break;
+		case DDS_DXGI_FORMAT_B8G8R8A8_UNORM:      m_formatQualifier = "rgba8";          m_internalFormat = GL_RGBA8;          m_format = GL_BGRA;         m_type = GL_UNSIGNED_BYTE;                m_components = 4; break; // compatible with Pixel32
+		case DDS_DXGI_FORMAT_B8G8R8A8_UNORM_SRGB: m_formatQualifier = "rgba8";          m_internalFormat = GL_SRGB8_ALPHA8;   m_format = GL_BGRA;         m_type = GL_UNSIGNED_BYTE;                m_components = 4; break;
+		case DDS_DXGI_FORMAT_R16G16B16A16_UNORM:  m_formatQualifier = "rgba16";         m_internalFormat = GL_RGBA16;         m_format = GL_RGBA;         m_type = GL_UNSIGNED_SHORT;               m_components = 4; break;
+		case DDS_DXGI_FORMAT_R16G16B16A16_SNORM:  m_formatQualifier = "rgba16_snorm";   m_internalFormat = GL_RGBA16_SNORM;   m_format = GL_RGBA;         m_type = GL_SHORT;                        m_components = 4; break;
+		case DDS_DXGI_FORMAT_R16G16B16A16_FLOAT:  m_formatQualifier = "rgba16f";        m_internalFormat = GL_RGBA16F;        m_format = GL_RGBA;         m_type = GL_HALF_FLOAT;                   m_components = 4; break;
+		case DDS_DXGI_FORMAT_R32G32B32A32_FLOAT:  m_formatQualifier = "rgba32f";        m_internalFormat = GL_RGBA32F;        m_format = GL_RGBA;         m_type = GL_FLOAT;                        m_components = 4; break;
+		case DDS_DXGI_FORMAT_R32G32B32_FLOAT:     m_formatQualifier = "rgb32f";         m_internalFormat = GL_RGB32F;         m_format = GL_RGB;          m_type = GL_FLOAT;                        m_components = 3; break;
+		case DDS_DXGI_FORMAT_R10G10B10A2_UNORM:   m_formatQualifier = "rgb10_a2";       m_internalFormat = GL_RGB10_A2;       m_format = GL_RGBA;         m_type = GL_UNSIGNED_INT_2_10_10_10_REV;  m_components = 4; break;
+		case DDS_DXGI_FORMAT_R11G11B10_FLOAT:     m_formatQualifier = "r11f_g11f_b10f"; m_internalFormat = GL_R11F_G11F_B10F; m_format = GL_RGB;          m_type = GL_UNSIGNED_INT_10F_11F_11F_REV; m_components = 3; break;
+		case DDS_DXGI_FORMAT_R9G9B9E5_SHAREDEXP:  m_formatQualifier = "unknown";        m_internalFormat = GL_RGB9_E5;        m_format = GL_RGB;          m_type = GL_UNSIGNED_INT_5_9_9_9_REV;     m_components = 3; break;
+		case DDS_DXGI_FORMAT_B5G6R5_UNORM:        m_formatQualifier = "unknown";        m_internalFormat = GL_RGB565;         m_format = GL_RGB;          m_type = GL_UNSIGNED_SHORT_5_6_5;         m_components = 3; break;
+		case DDS_DXGI_FORMAT_B5G5R5A1_UNORM:      m_formatQualifier = "unknown";        m_internalFormat = GL_RGB5_A1;        m_format = GL_BGRA;         m_type = GL_UNSIGNED_SHORT_1_5_5_5_REV;   m_components = 4; break;
+		case DDS_DXGI_FORMAT_B4G4R4A4_UNORM:      m_formatQualifier = "unknown";        m_internalFormat = GL_RGBA4;          m_format = GL_BGRA;         m_type = GL_UNSIGNED_SHORT_4_4_4_4_REV;   m_components = 4; break;
+		// unsigned integer
+		case DDS_DXGI_FORMAT_R8_UINT:             m_formatQualifier = "r8ui";           m_internalFormat = GL_R8UI;           m_format = GL_RED_INTEGER;  m_type = GL_UNSIGNED_BYTE;                m_components = 1; m_samplerType = SAMPLER_TYPE_UNSIGNED_INT; break;
+		case DDS_DXGI_FORMAT_R8G8_UINT:           m_formatQualifier = "rg8ui";          m_internalFormat = GL_RG8UI;          m_format = GL_RG_INTEGER;   m_type = GL_UNSIGNED_BYTE;                m_components = 2; m_samplerType = SAMPLER_TYPE_UNSIGNED_INT; break;
+		case DDS_DXGI_FORMAT_R8G8B8A8_UINT:       m_formatQualifier = "rgba8ui";        m_internalFormat = GL_RGBA8UI;        m_format = GL_RGBA_INTEGER; m_type = GL_UNSIGNED_BYTE;                m_components = 4; m_samplerType = SAMPLER_TYPE_UNSIGNED_INT; break;
+		case DDS_DXGI_FORMAT_R16_UINT:            m_formatQualifier = "r16ui";          m_internalFormat = GL_R16UI;          m_format = GL_RED_INTEGER;  m_type = GL_UNSIGNED_SHORT;               m_components = 1; m_samplerType = SAMPLER_TYPE_UNSIGNED_INT; break;
+		case DDS_DXGI_FORMAT_R16G16_UINT:         m_formatQualifier = "rg16ui";         m_internalFormat = GL_RG16UI;         m_format = GL_RG_INTEGER;   m_type = GL_UNSIGNED_SHORT;               m_components = 2; m_samplerType = SAMPLER_TYPE_UNSIGNED_INT; break;
+		case DDS_DXGI_FORMAT_R16G16B16A16_UINT:   m_formatQualifier = "rgba16ui";       m_internalFormat = GL_RGBA16UI;       m_format = GL_RGBA_INTEGER; m_type = GL_UNSIGNED_SHORT;               m_components = 4; m_samplerType = SAMPLER_TYPE_UNSIGNED_INT; break;
+		case DDS_DXGI_FORMAT_R32_UINT:            m_formatQualifier = "r32ui";          m_internalFormat = GL_R32UI;          m_format = GL_RED_INTEGER;  m_type = GL_UNSIGNED_INT;                 m_components = 1; m_samplerType = SAMPLER_TYPE_UNSIGNED_INT; break;
+		case DDS_DXGI_FORMAT_R32G32_UINT:         m_formatQualifier = "rg32ui";         m_internalFormat = GL_RG32UI;         m_format = GL_RG_INTEGER;   m_type = GL_UNSIGNED_INT;                 m_components = 2; m_samplerType = SAMPLER_TYPE_UNSIGNED_INT; break;
+		case DDS_DXGI_FORMAT_R32G32B32A32_UINT:   m_formatQualifier = "rgba32ui";       m_internalFormat = GL_RGBA32UI;       m_format = GL_RGBA_INTEGER; m_type = GL_UNSIGNED_INT;                 m_components = 4; m_samplerType = SAMPLER_TYPE_UNSIGNED_INT; break;
+		case DDS_DXGI_FORMAT_R10G10B10A2_UINT:    m_formatQualifier = "rgb10_a2ui";     m_internalFormat = GL_RGB10_A2UI;     m_format = GL_RGBA_INTEGER; m_type = GL_UNSIGNED_INT_2_10_10_10_REV;  m_components = 4; m_samplerType = SAMPLER_TYPE_UNSIGNED_INT; break; // untested!
+		// signed integer
+		case DDS_DXGI_FORMAT_R8_SINT:             m_formatQualifier = "r8i";            m_internalFormat = GL_R8I;            m_format = GL_RED_INTEGER;  m_type = GL_BYTE;                         m_components = 1; m_samplerType = SAMPLER_TYPE_SIGNED_INT; break;
+		case DDS_DXGI_FORMAT_R8G8_SINT:           m_formatQualifier = "rg8i";           m_internalFormat = GL_RG8I;           m_format = GL_RG_INTEGER;   m_type = GL_BYTE;                         m_components = 2; m_samplerType = SAMPLER_TYPE_SIGNED_INT; break;
+		case DDS_DXGI_FORMAT_R8G8B8A8_SINT:       m_formatQualifier = "rgba8i";         m_internalFormat = GL_RGBA8I;         m_format = GL_RGBA_INTEGER; m_type = GL_BYTE;                         m_components = 4; m_samplerType = SAMPLER_TYPE_SIGNED_INT; break;
+		case DDS_DXGI_FORMAT_R16_SINT:            m_formatQualifier = "r16i";           m_internalFormat = GL_R16I;           m_format = GL_RED_INTEGER;  m_type = GL_SHORT;                        m_components = 1; m_samplerType = SAMPLER_TYPE_SIGNED_INT; break;
+		case DDS_DXGI_FORMAT_R16G16_SINT:         m_formatQualifier = "rg16i";          m_internalFormat = GL_RG16I;          m_format = GL_RG_INTEGER;   m_type = GL_SHORT;                        m_components = 2; m_samplerType = SAMPLER_TYPE_SIGNED_INT; break;
+		case DDS_DXGI_FORMAT_R16G16B16A16_SINT:   m_formatQualifier = "rgba16i";        m_internalFormat = GL_RGBA16I;        m_format = GL_RGBA_INTEGER; m_type = GL_SHORT;                        m_components = 4; m_samplerType = SAMPLER_TYPE_SIGNED_INT; break;
+		case DDS_DXGI_FORMAT_R32_SINT:            m_formatQualifier = "r32i";           m_internalFormat = GL_R32I;           m_format = GL_RED_INTEGER;  m_type = GL_INT;                          m_components = 1; m_samplerType = SAMPLER_TYPE_SIGNED_INT; break;
+		case DDS_DXGI_FORMAT_R32G32_SINT:         m_formatQualifier = "rg32i";          m_internalFormat = GL_RG32I;          m_format = GL_RG_INTEGER;   m_type = GL_INT;                          m_components = 2; m_samplerType = SAMPLER_TYPE_SIGNED_INT; break;
+		case DDS_DXGI_FORMAT_R32G32B32A32_SINT:   m_formatQualifier = "rgba32i";        m_internalFormat = GL_RGBA32I;        m_format = GL_RGBA_INTEGER; m_type = GL_INT;                          m_components = 4; m_samplerType = SAMPLER_TYPE_SIGNED_INT; break;
+		// block compressed
+		case DDS_DXGI_FORMAT_BC1_UNORM:           m_internalFormat = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;        m_components = 4; m_compressed = true; break;
+		case DDS_DXGI_FORMAT_BC1_UNORM_SRGB:      m_internalFormat = GL_COMPRESSED_SRGB_S3TC_DXT1_EXT;       m_components = 4; m_compressed = true; break;
+		case DDS_DXGI_FORMAT_BC2_UNORM:           m_internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;       m_components = 4; m_compressed = true; break;
+		case DDS_DXGI_FORMAT_BC2_UNORM_SRGB:      m_internalFormat = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT; m_components = 4; m_compressed = true; break;
+		case DDS_DXGI_FORMAT_BC3_UNORM:           m_internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;       m_components = 4; m_compressed = true; break;
+		case DDS_DXGI_FORMAT_BC3_UNORM_SRGB:      m_internalFormat = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT; m_components = 4; m_compressed = true; break;
+		case DDS_DXGI_FORMAT_BC4_UNORM:           m_internalFormat = GL_COMPRESSED_RED_RGTC1;                m_components = 1; m_compressed = true; break;
+		case DDS_DXGI_FORMAT_BC4_SNORM:           m_internalFormat = GL_COMPRESSED_SIGNED_RED_RGTC1;         m_components = 1; m_compressed = true; break;
+		case DDS_DXGI_FORMAT_BC5_UNORM:           m_internalFormat = GL_COMPRESSED_RG_RGTC2;                 m_components = 2; m_compressed = true; break;
+		case DDS_DXGI_FORMAT_BC5_SNORM:           m_internalFormat = GL_COMPRESSED_SIGNED_RG_RGTC2;          m_components = 2; m_compressed = true; break;
+		case DDS_DXGI_FORMAT_BC6H_UF16:           m_internalFormat = GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT;  m_components = 3; m_compressed = true; break;
+		case DDS_DXGI_FORMAT_BC6H_SF16:           m_internalFormat = GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT;    m_components = 3; m_compressed = true; break;
+		case DDS_DXGI_FORMAT_BC7_UNORM:           m_internalFormat = GL_COMPRESSED_RGBA_BPTC_UNORM;          m_components = 4; m_compressed = true; break;
+		case DDS_DXGI_FORMAT_BC7_UNORM_SRGB:      m_internalFormat = GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM;    m_components = 4; m_compressed = true; break;
+
+		// =============================================================
+		// notable DXGI formats missing:
+		// all "typeless" formats (they don't really belong here)
+		// all formats with "X" (e.g. R8G8B8X8)
+		// all formats with "D" (e.g. D32_FLOAT)
+		// interleaved formats (R8G8_B8G8 and G8R8_G8B8)
+		// R10G10B10_XR_BIAS_A2_UNORM
+		// 7E3 and 6E4 compressed float formats
+		// R10G10B10_SNORM_A2_UNORM and R4G4_UNORM, and R1_UNORM formats
+		// =============================================================
+		default: ForceAssert(false);
+		}
+
+		const bool isTypeUInt = (m_type == GL_UNSIGNED_BYTE || m_type == GL_UNSIGNED_SHORT || m_type == GL_UNSIGNED_INT || m_type == GL_UNSIGNED_INT_2_10_10_10_REV);
+		const bool isTypeSInt = (m_type == GL_BYTE || m_type == GL_SHORT || m_type == GL_INT);
+		switch (m_format) {
+		case GL_RED:  m_formatType = "float"; break;
+		case GL_RG:   m_formatType = "vec2";  break;
+		case GL_RGB:  m_formatType = "vec3";  break;
+		case GL_RGBA: m_formatType = "vec4";  break;
+		case GL_BGRA: m_formatType = "vec4";  break;
+		case GL_RED_INTEGER:  m_formatType = isTypeUInt ? "uint"  : "int";   break;
+		case GL_RG_INTEGER:   m_formatType = isTypeUInt ? "uvec2" : "ivec2"; break;
+		case GL_RGB_INTEGER:  m_formatType = isTypeUInt ? "uvec3" : "ivec3"; break;
+		case GL_RGBA_INTEGER: m_formatType = isTypeUInt ? "uvec4" : "ivec4"; break;
+		}
+	}
+
+	const char* m_formatQualifier; // e.g. "rgba8"
+	const char* m_formatType; // e.g. "vec4"
+	GLenum m_internalFormat; // e.g. GL_RGBA8
+	GLenum m_format; // e.g. GL_RGBA
+	GLenum m_type; // e.g. GL_UNSIGNED_BYTE
+	eSamplerType m_samplerType;
+	uint32 m_components;
+	bool m_compressed;
+};
+
+static std::string GetOpenGLSamplerTypeStr(GLenum target, DDS_DXGI_FORMAT format, bool isShadowSampler = false, bool isImageSampler = false, bool isLayered = true)
+{
+	if (!isLayered) {
+		switch (target) {
+		case GL_TEXTURE_1D_ARRAY:             target = GL_TEXTURE_1D; break;
+		case GL_TEXTURE_2D_ARRAY:             target = GL_TEXTURE_2D; break; // once layer of array texture
+		case GL_TEXTURE_2D_MULTISAMPLE_ARRAY: target = GL_TEXTURE_2D_MULTISAMPLE; break;
+		case GL_TEXTURE_3D:                   target = GL_TEXTURE_2D; break; // one slice of 3D texture
+		case GL_TEXTURE_CUBE_MAP:             target = GL_TEXTURE_2D; break; // once face of cube map texture
+		case GL_TEXTURE_CUBE_MAP_ARRAY:       target = GL_TEXTURE_2D; break;
+		}
+	}
+	const char* samplerTypeStr = "samplerUnknown";
+	if (isShadowSampler) {
+		switch (target) {
+		case GL_TEXTURE_1D:                   samplerTypeStr = "sampler1DShadow"; break;
+		case GL_TEXTURE_1D_ARRAY:             samplerTypeStr = "sampler1DArrayShadow"; break;
+		case GL_TEXTURE_2D:                   samplerTypeStr = "sampler2DShadow"; break;
+		case GL_TEXTURE_2D_ARRAY:             samplerTypeStr = "sampler2DArrayShadow"; break;
+		case GL_TEXTURE_CUBE_MAP:             samplerTypeStr = "samplerCubeShadowShadow"; break;
+		case GL_TEXTURE_CUBE_MAP_ARRAY:       samplerTypeStr = "samplerCubeArrayShadow"; break;
+		case GL_TEXTURE_RECTANGLE:            samplerTypeStr = "sampler2DRectShadow"; break;
+		}
+	} else {
+		switch (target) {
+		case GL_TEXTURE_1D:                   samplerTypeStr = "sampler1D"; break;
+		case GL_TEXTURE_1D_ARRAY:             samplerTypeStr = "sampler1DArray"; break;
+		case GL_TEXTURE_2D:                   samplerTypeStr = "sampler2D"; break;
+		case GL_TEXTURE_2D_ARRAY:             samplerTypeStr = "sampler2DArray"; break;
+		case GL_TEXTURE_2D_MULTISAMPLE:       samplerTypeStr = "sampler2DMS"; break;
+		case GL_TEXTURE_2D_MULTISAMPLE_ARRAY: samplerTypeStr = "sampler2DMSArray"; break;
+		case GL_TEXTURE_3D:                   samplerTypeStr = "sampler3D"; break;
+		case GL_TEXTURE_CUBE_MAP:             samplerTypeStr = "samplerCube"; break;
+		case GL_TEXTURE_CUBE_MAP_ARRAY:       samplerTypeStr = "samplerCubeArray"; break;
+		case GL_TEXTURE_RECTANGLE:            samplerTypeStr = "sampler2DRect"; break;
+		case GL_TEXTURE_BUFFER:               samplerTypeStr = "samplerBuffer"; break;
+		}
+	}
+	if (isImageSampler) {
+		static char temp[64];
+		sprintf(temp, "image%s", samplerTypeStr + strlen("sampler")); // replace 'sampler' with 'image'
+		samplerTypeStr = temp;
+	}
+	const char* samplerTypePrefix = "";
+	const TextureFormatInfo info(format);
+	if (info.m_samplerType == TextureFormatInfo::SAMPLER_TYPE_UNSIGNED_INT)
+		samplerTypePrefix = "u";
+	else if (info.m_samplerType == TextureFormatInfo::SAMPLER_TYPE_SIGNED_INT)
+		samplerTypePrefix = "i";
+	return varString("%s%s", samplerTypePrefix, samplerTypeStr);
+}
+
+static void BindTextureTarget(ProgramUniform& sampler, GLuint textureID, GLenum target, uint32 slot)
+{
+	ForceAssert(slot < 32);
+	glActiveTexture(GL_TEXTURE0 + slot);
+	glBindTexture(target, textureID);
+	sampler.Set1i((int)slot);
+	glActiveTexture(GL_TEXTURE0); // restore
+}
+
+static uint32 g_Frame = 0;
+static uint32 g_ResetFrame = 0; // iResetFrame - when the render resolution last changed, see DynamicResolution::SetLevel
+static float g_Time = 0.0f;
+static float g_TimeDelta = 0.0f;
+
+static void UpdateFrameTime()
+{
+	if (g_FixedTimeDelta > 0.0f) { // deterministic, e.g. for offline rendering
+		g_Time = (float)g_Frame*g_FixedTimeDelta;
+		g_TimeDelta = g_FixedTimeDelta;
+		return;
+	}
+	static uint64 time0 = 0;
+	static uint64 time = 0;
+	if (time == 0)
+		time = time0 = ProgressDisplay::GetCurrentPerformanceTime();
+	else {
+		g_Time = ProgressDisplay::GetTimeInSeconds(time0);
+		g_TimeDelta = ProgressDisplay::GetDeltaTimeInSeconds(time);
+	}
+}
+
+static bool LoadFileIntoStrings(std::vector<std::string>& strings, const char* path)
+{
+	FILE* file = fopen(path, "r");
+	if (file) {
+		char line[8192];
+		while (fgets(line, sizeof(line), file)) {
+			char* end = strstr(line, "\r\n");
+			if (end)
+				*end = '\0';
+			else {
+				end = strrchr(line, '\n');
+				if (end && end[1] == '\0')
+					*end = '\0';
+			}
+			strings.push_back(line);
+		}
+		fclose(file);
+		return true;
+	} else
+		return false;
+}
+
+// reference box filter, every mip is built from the full-res image - only used by -mip_bench now (see MipGenerator)
+template <typename PixelType> static void Downsample2D(PixelType* dstImage, uint32 dstW, uint32 dstH, const PixelType* srcImage, uint32 srcW, uint32 srcH)
+{
+	if (dstW == srcW && dstH == srcH)
+		memcpy(dstImage, srcImage, srcW*srcH*sizeof(PixelType));
+	else {
+		ForceAssert(dstW <= srcW && dstH <= srcH);
+		const uint32 sx = srcW/dstW;
+		const uint32 sy = srcH/dstH;
+		for (uint32 mj = 0; mj < dstH; mj++) {
+			for (uint32 mi = 0; mi < dstW; mi++) {
+				Vec4V sum(V_ZERO);
+				uint32 count = 0;
+				for (uint32 jj = 0; jj < sy; jj++) {
+					for (uint32 ii = 0; ii < sx; ii++) {
+						const uint32 i = ii + mi*sx;
+						const uint32 j = jj + mj*sy;
+						if (i < srcW && j < srcH) {
+							sum += srcImage[i + j*srcW];
+							count++;
+						}
+					}
+				}
+				if (count > 0)
+					sum *= 1.0f/(float)count;
+				dstImage[mi + mj*dstW] = sum;
+			}
+		}
+	}
+}
+
+// cascading mip generator - each level is filtered from the previous one rather than from the full-res image. the
+// filter is separable, with per-axis tap tables built once per level so the inner loops are plain Vec4V multiply-adds
+// with no bounds checks, and rows are split across the JobSystem in tiles. taps are weighted by their exact footprint
+// so odd (non power of two) sizes don't shift or drop texels. for sRGB formats RGB is filtered in linear space
+class MipGenerator
+{
+public:
+	enum eFilter
+	{
+		FILTER_BOX, // area average
+		FILTER_KAISER, // kaiser windowed sinc, radius 3
+		FILTER_LANCZOS, // lanczos3
+	};
+
+	static eFilter GetFilterFromString(const char* str)
+	{
+		if (stricmp(str, "KAISER") == 0) return FILTER_KAISER;
+		if (stricmp(str, "LANCZOS") == 0) return FILTER_LANCZOS;
+		if (stricmp(str, "BOX") != 0)
+			printf("warning: unknown mip filter \"%s\", using BOX\n", str);
+		return FILTER_BOX;
+	}
+
+	static const char* GetFilterStr(eFilter filter)
+	{
+		switch (filter) {
+		case FILTER_BOX: return "BOX";
+		case FILTER_KAISER: return "KAISER";
+		case FILTER_LANCZOS: return "LANCZOS";
+		}
+		return "?";
+	}
+
+	// levels[0] is the source image (not owned), levels[1..mipLevels-1] are allocated here - release them with Free
+	static void Generate(std::vector<Vec4V*>& levels, const Vec4V* image, uint32 w, uint32 h, uint32 mipLevels, eFilter filter, bool sRGB)
+	{
+		levels.resize(Max(1U, mipLevels));
+		levels[0] = const_cast<Vec4V*>(image);
+		if (mipLevels <= 1)
+			return;
+		const Vec4V* src = image;
+		Vec4V* linear = nullptr;
+		if (sRGB) { // filter a linear copy, each level is re-encoded after it has been used as the source for the next
+			linear = new Vec4V[w*h];
+			memcpy(linear, image, w*h*sizeof(Vec4V));
+			ConvertRows(linear, w, h, false);
+			src = linear;
+		}
+		Vec4V* temp = new Vec4V[Max(1U, w >> 1)*h];
+		uint32 sw = w;
+		uint32 sh = h;
+		for (uint32 mipIndex = 1; mipIndex < mipLevels; mipIndex++) {
+			const uint32 dw = Max(1U, w >> mipIndex);
+			const uint32 dh = Max(1U, h >> mipIndex);
+			Vec4V* dst = new Vec4V[dw*dh];
+			Downsample(dst, dw, dh, src, sw, sh, temp, filter);
+			if (sRGB && mipIndex > 1)
+				ConvertRows(levels[mipIndex - 1], Max(1U, w >> (mipIndex - 1)), Max(1U, h >> (mipIndex - 1)), true);
+			levels[mipIndex] = dst;
+			src = dst;
+			sw = dw;
+			sh = dh;
+		}
+		if (sRGB)
+			ConvertRows(levels[mipLevels - 1], sw, sh, true);
+		delete[] temp;
+		if (linear)
+			delete[] linear;
+	}
+
+	static void Free(std::vector<Vec4V*>& levels)
+	{
+		for (uint32 mipIndex = 1; mipIndex < levels.size(); mipIndex++)
+			delete[] levels[mipIndex];
+		levels.clear();
+	}
+
+	// filters src (sw x sh) to dst (dw x dh), temp must hold dw x sh
+	static void Downsample(Vec4V* dst, uint32 dw, uint32 dh, const Vec4V* src, uint32 sw, uint32 sh, Vec4V* temp, eFilter filter)
+	{
+		TapTable tapsX;
+		TapTable tapsY;
+		tapsX.Build(sw, dw, filter);
+		tapsY.Build(sh, dh, filter);
+		const uint32 rowsPerTile = 16;
+		JobSystem::ParallelFor((sh + rowsPerTile - 1)/rowsPerTile, [&](uint32 tile) { // horizontal
+			for (uint32 j = tile*rowsPerTile; j < Min(sh, (tile + 1)*rowsPerTile); j++) {
+				const Vec4V* srcRow = src + j*sw;
+				Vec4V* tempRow = temp + j*dw;
+				for (uint32 i = 0; i < dw; i++) {
+					const Tap* taps = &tapsX.m_taps[tapsX.m_first[i]];
+					Vec4V sum(V_ZERO);
+					for (uint32 k = 0; k < tapsX.m_count[i]; k++) {
+						Vec4V t = srcRow[taps[k].m_index];
+						t *= taps[k].m_weight;
+						sum += t;
+					}
+					tempRow[i] = sum;
+				}
+			}
+		});
+		JobSystem::ParallelFor((dh + rowsPerTile - 1)/rowsPerTile, [&](uint32 tile) { // vertical, whole rows at a time
+			for (uint32 j = tile*rowsPerTile; j < Min(dh, (tile + 1)*rowsPerTile); j++) {
+				Vec4V* dstRow = dst + j*dw;
+				const Tap* taps = &tapsY.m_taps[tapsY.m_first[j]];
+				for (uint32 i = 0; i < dw; i++)
+					dstRow[i] = Vec4V(V_ZERO);
+				for (uint32 k = 0; k < tapsY.m_count[j]; k++) {
+					const Vec4V* tempRow = temp + taps[k].m_index*dw;
+					const float weight = taps[k].m_weight;
+					for (uint32 i = 0; i < dw; i++) {
+						Vec4V t = tempRow[i];
+						t *= weight;
+						dstRow[i] += t;
+					}
+				}
+			}
+		});
+	}
+
+private:
+	class Tap
+	{
+	public:
+		uint32 m_index;
+		float m_weight;
+	};
+
+	class TapTable // taps for each destination texel along one axis
+	{
+	public:
+		void Build(uint32 srcSize, uint32 dstSize, eFilter filter)
+		{
+			const float scale = (float)srcSize/(float)dstSize;
+			m_first.resize(dstSize);
+			m_count.resize(dstSize);
+			m_taps.clear();
+			for (uint32 i = 0; i < dstSize; i++) {
+				m_first[i] = (uint32)m_taps.size();
+				if (filter == FILTER_BOX) { // exact overlap of [i,i+1)*scale with each source texel
+					const float a = (float)i*scale;
+					const float b = (float)(i + 1)*scale;
+					for (uint32 j = (uint32)a; j < Min(srcSize, (uint32)ceilf(b)); j++) {
+						const float overlap = Min(b, (float)(j + 1)) - Max(a, (float)j);
+						if (overlap > 0.0f)
+							AddTap(j, overlap/scale);
+					}
+				} else {
+					const float radius = 3.0f;
+					const float center = ((float)i + 0.5f)*scale;
+					const int j0 = (int)floorf(center - radius*scale);
+					const int j1 = (int)ceilf(center + radius*scale);
+					float sum = 0.0f;
+					for (int j = j0; j <= j1; j++) {
+						const float x = ((float)j + 0.5f - center)/scale; // in destination texels
+						const float weight = Kernel(x, radius, filter);
+						if (weight != 0.0f) {
+							AddTap((uint32)Clamp(j, 0, (int)srcSize - 1), weight); // clamp to edge
+							sum += weight;
+						}
+					}
+					for (uint32 k = m_first[i]; k < m_taps.size(); k++)
+						m_taps[k].m_weight /= sum;
+				}
+				m_count[i] = (uint32)m_taps.size() - m_first[i];
+			}
+		}
+
+		void AddTap(uint32 index, float weight)
+		{
+			Tap tap;
+			tap.m_index = index;
+			tap.m_weight = weight;
+			m_taps.push_back(tap);
+		}
+
+		std::vector<uint32> m_first;
+		std::vector<uint32> m_count;
+		std::vector<Tap> m_taps;
+	};
+
+	static float Sinc(float x)
+	{
+		if (fabsf(x) < 1e-5f)
+			return 1.0f;
+		const float px = 3.14159265f*x;
+		return sinf(px)/px;
+	}
+
+	static float BesselI0(float x)
+	{
+		float sum = 1.0f;
+		float term = 1.0f;
+		for (int k = 1; k < 20; k++) {
+			term *= (x*0.5f/(float)k)*(x*0.5f/(float)k);
+			sum += term;
+		}
+		return sum;
+	}
+
+	static float Kernel(float x, float radius, eFilter filter)
+	{
+		if (fabsf(x) >= radius)
+			return 0.0f;
+		if (filter == FILTER_LANCZOS)
+			return Sinc(x)*Sinc(x/radius);
+		const float alpha = 4.0f;
+		const float t = x/radius;
+		return Sinc(x)*BesselI0(alpha*sqrtf(1.0f - t*t))/BesselI0(alpha);
+	}
+
+	static void ConvertRows(Vec4V* image, uint32 w, uint32 h, bool toSRGB) // RGB only, alpha is linear already
+	{
+		JobSystem::ParallelFor(h, [=](uint32 j) {
+			for (uint32 i = 0; i < w; i++) {
+				float* c = (float*)&image[i + j*w];
+				for (uint32 k = 0; k < 3; k++) {
+					const float v = Clamp(c[k], 0.0f, 1.0f);
+					if (toSRGB)
+						c[k] = v <= 0.0031308f ? v*12.92f : 1.055f*powf(v, 1.0f/2.4f) - 0.055f;
+					else
+						c[k] = v <= 0.04045f ? v/12.92f : powf((v + 0.055f)/1.055f, 2.4f);
+				}
+			}
+		});
+	}
+};
+
+static void GetImageFiles(std::vector<std::string>& paths, const char* path) // path is an image, or a directory searched recursively
+{
+	struct stat st;
+	if (stat(path, &st) != 0)
+		return;
+	if ((st.st_mode & S_IFDIR) == 0) {
+		paths.push_back(path);
+		return;
+	}
+	std::vector<std::string> files;
+	std::vector<std::string> subdirs;
+	GetDirectoryEntries(&files, &subdirs, path);
+	for (uint32 i = 0; i < files.size(); i++) {
+		const char* ext = strrchr(files[i].c_str(), '.');
+		if (ext && (stricmp(ext, ".jpg") == 0 || stricmp(ext, ".png") == 0 || stricmp(ext, ".tga") == 0 || stricmp(ext, ".bmp") == 0))
+			paths.push_back(files[i]);
+	}
+	for (uint32 i = 0; i < subdirs.size(); i++)
+		if (strcmp(GetPathFileName(subdirs[i].c_str()), "_processed") != 0)
+			GetImageFiles(paths, subdirs[i].c_str());
+}
+
+// -mip_bench: times the reference Downsample2D against MipGenerator on the images given with -mip_bench_images and
+// -mip_bench_dir, or under textures if none are given (no GL needed)
+static void MipBenchmark(uint32 iterations, const std::vector<std::string>& sources)
+{
+	std::vector<std::string> paths;
+	if (sources.empty())
+		GetImageFiles(paths, "textures");
+	for (uint32 i = 0; i < sources.size(); i++)
+		GetImageFiles(paths, GetPortablePath(sources[i]).c_str());
+	if (paths.empty()) {
+		fprintf(stderr, "mip_bench: no images found\n");
+		return;
+	}
+	printf("mip generation, %u iterations, %u threads\n", iterations, JobSystem::GetNumThreads() + 1);
+	printf("%-40s %10s %10s %10s %10s %10s\n", "texture", "size", "reference", "box", "kaiser", "lanczos");
+	float totals[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+	for (uint32 p = 0; p < paths.size(); p++) {
+		uint32 w = 0;
+		uint32 h = 0;
+		Vec4V* image = LoadImage_Vec4V(paths[p].c_str(), (int&)w, (int&)h);
+		if (image == nullptr) {
+			printf("%-40s (failed to load)\n", paths[p].c_str());
+			continue;
+		}
+		const uint32 mipLevels = Log2FloorInt(Max(w, h)) + 1;
+		float ms[4];
+		for (uint32 method = 0; method < 4; method++) {
+			const uint64 t = ProgressDisplay::GetCurrentPerformanceTime();
+			for (uint32 iter = 0; iter < iterations; iter++) {
+				if (method == 0) {
+					Vec4V* mipImage = new Vec4V[Max(1U, w >> 1)*Max(1U, h >> 1)];
+					for (uint32 mipIndex = 1; mipIndex < mipLevels; mipIndex++)
+						Downsample2D(mipImage, Max(1U, w >> mipIndex), Max(1U, h >> mipIndex), image, w, h);
+					delete[] mipImage;
+				} else {
+					std::vector<Vec4V*> levels;
+					MipGenerator::Generate(levels, image, w, h, mipLevels, (MipGenerator::eFilter)(method - 1), false);
+					MipGenerator::Free(levels);
+				}
+			}
+			ms[method] = 1000.0f*ProgressDisplay::GetTimeInSeconds(t)/(float)iterations;
+			totals[method] += ms[method];
+		}
+		printf("%-40s %10s %8.2fms %8.2fms %8.2fms %8.2fms\n", paths[p].c_str(), varString("%ux%u", w, h).c_str(), ms[0], ms[1], ms[2], ms[3]);
+		delete[] image;
+	}
+	printf("%-40s %10s %8.2fms %8.2fms %8.2fms %8.2fms\n", "total", "", totals[0], totals[1], totals[2], totals[3]);
+	if (totals[1] > 0.0f)
+		printf("box is %.1fx faster than the reference\n", totals[0]/totals[1]);
+}
+
+static void ReshapeFunc(int width, int height)
+{
+	g_ViewportWidth = width;
+	g_ViewportHeight = height;
+	g_Frame = 0; // iFrame does not get reset when window changes in ShaderToy .. but i find this behavior useful
+	g_ResetFrame = 0;
+	glutReshapeWindow(width, height);
+}
+
+static const char* GetName(const NameValuePairs* nvp)
+{
+	if (nvp && nvp->size() > 0 && (nvp->operator[](0).m_name == std::string("name") || nvp->operator[](0).m_name.empty()))
+		return nvp->operator[](0).m_value.c_str();
+	else
+		return nullptr;
+}
+
+static ReadbackQueue& GetCaptureQueue() // shared by all captures, polled once per frame in RenderAll
+{
+	static ReadbackQueue queue;
+	return queue;
+}
+
+// converts RGBA pixels read back as GL_FLOAT, GL_UNSIGNED_INT, GL_INT or GL_UNSIGNED_BYTE (bottom row first) to Vec4V, top row first
+static Vec4V* ConvertReadbackToVec4V(const uint8* data, uint32 w, uint32 h, GLenum type)
+{
+	Vec4V* image = new Vec4V[w*h];
+	for (uint32 j = 0; j < h; j++) {
+		for (uint32 i = 0; i < w; i++) {
+			const uint32 src = (i + (h - 1 - j)*w)*4;
+			float* dst = (float*)&image[i + j*w];
+			for (uint32 k = 0; k < 4; k++) {
+				switch (type) {
+				case GL_UNSIGNED_BYTE: dst[k] = (float)data[src + k]/255.0f; break;
+				case GL_FLOAT:         dst[k] = ((const float*)data)[src + k]; break;
+				case GL_UNSIGNED_INT:  dst[k] = (float)((const uint32*)data)[src + k]; break;
+				case GL_INT:           dst[k] = (float)((const int*)data)[src + k]; break;
+				default:               dst[k] = 0.0f; break;
+				}
+			}
+		}
+	}
+	return image;
+}
+
+#define DDS_FILE_HEADER_DWORDS (1 + 31 + 5) // magic, DDS_HEADER, DDS_HEADER_DXT10
+
+static void BuildDDSFileHeader(uint32 header[DDS_FILE_HEADER_DWORDS], uint32 w, uint32 h, uint32 d, uint32 arraySize, bool isCubemap, uint32 mipCount, DDS_DXGI_FORMAT format)
+{
+	const uint32 bs = GetDX10FormatBlockSize(format);
+	const uint32 bitsPerPixel = GetDX10FormatBitsPerPixel(format);
+	memset(header, 0, DDS_FILE_HEADER_DWORDS*sizeof(uint32));
+	header[0] = 0x20534444; // "DDS "
+	header[1] = 124; // dwSize
+	header[2] = 0x1 | 0x2 | 0x4 | 0x1000; // DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT
+	header[2] |= bs > 1 ? 0x80000 : 0x8; // DDSD_LINEARSIZE or DDSD_PITCH
+	if (mipCount > 1)
+		header[2] |= 0x20000; // DDSD_MIPMAPCOUNT
+	header[3] = h;
+	header[4] = w;
+	header[5] = bs > 1 ? ((w + bs - 1)/bs)*((h + bs - 1)/bs)*(bitsPerPixel*bs*bs/8) : w*bitsPerPixel/8; // linear size or pitch
+	header[7] = mipCount;
+	header[19] = 32; // ddspf.dwSize
+	header[20] = 0x4; // DDPF_FOURCC
+	header[21] = 0x30315844; // "DX10"
+	header[27] = 0x1000; // DDSCAPS_TEXTURE
+	if (mipCount > 1)
+		header[27] |= 0x400008; // DDSCAPS_MIPMAP | DDSCAPS_COMPLEX
+	if (d > 1) {
+		header[2] |= 0x800000; // DDSD_DEPTH
+		header[6] = d;
+		header[27] |= 0x8; // DDSCAPS_COMPLEX
+		header[28] |= 0x200000; // DDSCAPS2_VOLUME
+	}
+	if (isCubemap) {
+		header[27] |= 0x8; // DDSCAPS_COMPLEX
+		header[28] |= 0xFE00; // DDSCAPS2_CUBEMAP and all faces
+		header[34] = 0x4; // DDS_RESOURCE_MISC_TEXTURECUBE
+	}
+	header[32] = (uint32)format;
+	header[33] = d > 1 ? 4 : 3; // D3D10_RESOURCE_DIMENSION_TEXTURE3D or TEXTURE2D
+	header[35] = arraySize; // in cubes for cubemaps
+}
+
+class DDSFileInfo
+{
+public:
+	DDSFileInfo() : m_w(0), m_h(0), m_d(1), m_arraySize(1), m_isCubemap(false), m_mipCount(1), m_format(DDS_DXGI_FORMAT_UNKNOWN), m_dataOffset(0) {}
+	uint32 m_w;
+	uint32 m_h;
+	uint32 m_d;
+	uint32 m_arraySize; // in cubes for cubemaps
+	bool m_isCubemap;
+	uint32 m_mipCount;
+	DDS_DXGI_FORMAT m_format;
+	uint32 m_dataOffset;
+};
+
+// DX10 extended headers, or legacy DXT1/3/5 - other legacy pixel formats need to be resaved with a DX10 header
+static bool ParseDDSFileHeader(DDSFileInfo& info, const uint8* data, size_t size)
+{
+	const uint32* header = (const uint32*)data;
+	if (size < 128 || header[0] != 0x20534444 || header[1] != 124 || (header[20] & 0x4) == 0) // "DDS ", dwSize, DDPF_FOURCC
+		return false;
+	info.m_w = header[4];
+	info.m_h = header[3];
+	info.m_d = 1;
+	info.m_arraySize = 1;
+	info.m_isCubemap = (header[28] & 0x200) != 0; // DDSCAPS2_CUBEMAP
+	info.m_mipCount = (header[2] & 0x20000) ? Max(1U, header[7]) : 1; // DDSD_MIPMAPCOUNT
+	info.m_dataOffset = 128;
+	switch (header[21]) {
+	case 0x31545844: info.m_format = DDS_DXGI_FORMAT_BC1_UNORM; break; // "DXT1"
+	case 0x33545844: info.m_format = DDS_DXGI_FORMAT_BC2_UNORM; break; // "DXT3"
+	case 0x35545844: info.m_format = DDS_DXGI_FORMAT_BC3_UNORM; break; // "DXT5"
+	case 0x30315844: // "DX10"
+		if (size < DDS_FILE_HEADER_DWORDS*sizeof(uint32))
+			return false;
+		info.m_format = (DDS_DXGI_FORMAT)header[32];
+		info.m_d = header[33] == 4 ? Max(1U, header[6]) : 1; // D3D10_RESOURCE_DIMENSION_TEXTURE3D
+		info.m_isCubemap = (header[34] & 0x4) != 0; // DDS_RESOURCE_MISC_TEXTURECUBE
+		info.m_arraySize = Max(1U, header[35]);
+		info.m_dataOffset = DDS_FILE_HEADER_DWORDS*sizeof(uint32);
+		break;
+	default:
+		return false;
+	}
+	return info.m_w > 0 && info.m_h > 0;
+}
+
+static bool IsDDSPath(const char* path)
+{
+	const char* ext = strrchr(path, '.');
+	return ext && stricmp(ext, ".dds") == 0;
+}
+
+static bool ReadDDSFileInfo(DDSFileInfo& info, const char* path)
+{
+	uint32 header[DDS_FILE_HEADER_DWORDS];
+	FILE* file = fopen(path, "rb");
+	if (file == nullptr)
+		return false;
+	const size_t size = fread(header, 1, sizeof(header), file);
+	fclose(file);
+	return ParseDDSFileHeader(info, (const uint8*)header, size);
+}
+
+static bool SaveCaptureRaw(const char* path, const uint8* data, uint32 w, uint32 h, uint32 bytesPerPixel, bool ddsHeader, DDS_DXGI_FORMAT format)
+{
+	FILE* file = fopen(path, "wb");
+	if (file == nullptr)
+		return false;
+	if (ddsHeader) {
+		uint32 header[DDS_FILE_HEADER_DWORDS];
+		BuildDDSFileHeader(header, w, h, 1, 1, false, 1, format);
+		fwrite(header, sizeof(header), 1, file);
+	}
+	for (uint32 j = 0; j < h; j++) // top row first
+		fwrite(data + (h - 1 - j)*w*bytesPerPixel, w*bytesPerPixel, 1, file);
+	fclose(file);
+	return true;
+}
+
+static bool SaveCaptureEXR(const char* path, const Vec4V* image, uint32 w, uint32 h) // uncompressed RGBA32F scanlines
+{
+	FILE* file = fopen(path, "wb");
+	if (file == nullptr)
+		return false;
+	std::vector<uint8> header;
+	const auto put = [&header](const void* p, size_t size) { header.insert(header.end(), (const uint8*)p, (const uint8*)p + size); };
+	const auto putString = [&put](const char* str) { put(str, strlen(str) + 1); };
+	const auto putInt = [&put](int value) { put(&value, sizeof(value)); };
+	const auto putAttribute = [&](const char* name, const char* type, int size) { putString(name); putString(type); putInt(size); };
+	putInt(20000630); // magic
+	putInt(2); // version, single part scanline
+	const char* channels[] = {"A", "B", "G", "R"}; // must be sorted
+	putAttribute("channels", "chlist", icountof(channels)*18 + 1);
+	for (int c = 0; c < icountof(channels); c++) {
+		const uint8 linearAndReserved[4] = {0,0,0,0};
+		putString(channels[c]);
+		putInt(2); // FLOAT
+		put(linearAndReserved, sizeof(linearAndReserved));
+		putInt(1); // x sampling
+		putInt(1); // y sampling
+	}
+	header.push_back(0);
+	putAttribute("compression", "compression", 1);
+	header.push_back(0); // NO_COMPRESSION
+	const int window[4] = {0, 0, (int)w - 1, (int)h - 1};
+	putAttribute("dataWindow", "box2i", sizeof(window));
+	put(window, sizeof(window));
+	putAttribute("displayWindow", "box2i", sizeof(window));
+	put(window, sizeof(window));
+	putAttribute("lineOrder", "lineOrder", 1);
+	header.push_back(0); // INCREASING_Y
+	const float one = 1.0f;
+	const float center[2] = {0.0f, 0.0f};
+	putAttribute("pixelAspectRatio", "float", sizeof(one));
+	put(&one, sizeof(one));
+	putAttribute("screenWindowCenter", "v2f", sizeof(center));
+	put(center, sizeof(center));
+	putAttribute("screenWindowWidth", "float", sizeof(one));
+	put(&one, sizeof(one));
+	header.push_back(0); // end of header
+	const uint32 lineSize = w*icountof(channels)*sizeof(float);
+	uint64 offset = header.size() + h*sizeof(uint64);
+	for (uint32 j = 0; j < h; j++) {
+		put(&offset, sizeof(offset));
+		offset += 2*sizeof(int) + lineSize;
+	}
+	fwrite(header.data(), header.size(), 1, file);
+	std::vector<float> line(w*icountof(channels));
+	for (uint32 j = 0; j < h; j++) {
+		const int lineHeader[2] = {(int)j, (int)lineSize};
+		for (uint32 c = 0; c < 4; c++)
+			for (uint32 i = 0; i < w; i++)
+				line[i + c*w] = ((const float*)&image[i + j*w])[3 - c]; // ABGR
+		fwrite(lineHeader, sizeof(lineHeader), 1, file);
+		fwrite(line.data(), lineSize, 1, file);
+	}
+	fclose(file);
+	return true;
+}
+
+// queues a readback from the bound GL_READ_FRAMEBUFFER and read buffer, written to path on a worker thread. the file
+// type comes from the extension - .raw and .dds keep the native texel format (rows top first), .exr is RGBA32F and
+// anything else goes through SaveImage
+static void QueueCapture(const std::string& path, uint32 w, uint32 h, DDS_DXGI_FORMAT format)
+{
+	const char* ext = strrchr(path.c_str(), '.');
+	const bool dds = ext && stricmp(ext, ".dds") == 0;
+	const bool raw = ext && stricmp(ext, ".raw") == 0;
+	const bool exr = ext && stricmp(ext, ".exr") == 0;
+	const TextureFormatInfo info(format);
+	GLenum readFormat = GL_RGBA;
+	GLenum readType = GL_FLOAT;
+	uint32 bytesPerPixel = 16;
+	if (dds || raw) {
+		readFormat = info.m_format;
+		readType = info.m_type;
+		bytesPerPixel = GetDX10FormatBitsPerPixel(format)/8;
+	} else if (info.m_samplerType == TextureFormatInfo::SAMPLER_TYPE_UNSIGNED_INT) {
+		readFormat = GL_RGBA_INTEGER;
+		readType = GL_UNSIGNED_INT;
+	} else if (info.m_samplerType == TextureFormatInfo::SAMPLER_TYPE_SIGNED_INT) {
+		readFormat = GL_RGBA_INTEGER;
+		readType = GL_INT;
+	}
+	GetCaptureQueue().Read(w, h, readFormat, readType, bytesPerPixel, [path, format, readType, bytesPerPixel, dds, raw, exr](const uint8* data, uint32 width, uint32 height) {
+		bool ok = true;
+		if (dds || raw)
+			ok = SaveCaptureRaw(path.c_str(), data, width, height, bytesPerPixel, dds, format);
+		else {
+			Vec4V* image = ConvertReadbackToVec4V(data, width, height, readType);
+			if (exr)
+				ok = SaveCaptureEXR(path.c_str(), image, width, height);
+			else
+				SaveImage(path.c_str(), image, width, height);
+			delete[] image;
+		}
+		if (!ok)
+			fprintf(stderr, "failed to write capture \"%s\"\n", path.c_str());
+	});
+}
+
+// e.g. //$BUFFER: name=variance, relative_width=0.25, relative_height=0.25, format=R32G32B32_FLOAT, filter=OFF
+class ShaderToyBuffer
+{
+public:
+	enum
+	{
+		KEYBOARD_INPUT_TEXTURE_WIDTH = 256,
+		KEYBOARD_INPUT_TEXTURE_HEIGHT = 3, // y=0..2 (0=down,1=pressed,2=toggled)
+
+		KEYBOARD2_INPUT_TEXTURE_WIDTH = 256,
+		KEYBOARD2_INPUT_TEXTURE_HEIGHT = 10,
+	};
+
+	class Desc
+	{
+	public:
+		Desc()
+			: m_hash(0)
+			, m_name("")
+			, m_path("")
+			, m_resolutionX(0)
+			, m_resolutionY(0)
+			, m_resolutionZ(0)
+			, m_relativeResX(0.0f)
+			, m_relativeResY(0.0f)
+			, m_numLayers(0)
+			, m_mipLevels(0)
+			, m_isCubemap(false)
+			, m_format(DDS_DXGI_FORMAT_UNKNOWN)
+			, m_filter(false)
+			, m_wrap(false)
+			, m_persistent(false)
+			, m_mipFilter(MipGenerator::FILTER_BOX)
+			, m_atlasX(0)
+			, m_atlasY(0)
+			, m_autoMips(false)
+			, m_autoMipsDefault(false)
+		{}
+
+		bool IsImmutable() const
+		{
+			return Max(m_relativeResX, m_relativeResY) <= 0.0f;
+		}
+
+		// true if a texture allocated for one desc can be used for the other (everything except name, path, persistence, image layout and automips)
+		bool IsStorageCompatible(const Desc& other) const
+		{
+			return
+				m_resolutionX  == other.m_resolutionX  &&
+				m_resolutionY  == other.m_resolutionY  &&
+				m_resolutionZ  == other.m_resolutionZ  &&
+				m_relativeResX == other.m_relativeResX &&
+				m_relativeResY == other.m_relativeResY &&
+				m_numLayers    == other.m_numLayers    &&
+				m_mipLevels    == other.m_mipLevels    &&
+				m_isCubemap    == other.m_isCubemap    &&
+				m_format       == other.m_format       &&
+				m_filter       == other.m_filter       &&
+				m_wrap         == other.m_wrap;
+		}
+
+		void CalculateHash()
+		{
+			ForceAssert(m_hash == 0);
+			uint64 hash = 0;
+			hash = Crc64(m_name.c_str(), m_name.size(), hash);
+			hash = Crc64(m_path.c_str(), m_path.size(), hash);
+			hash = Crc64(m_resolutionX, hash);
+			hash = Crc64(m_resolutionY, hash);
+			hash = Crc64(m_resolutionZ, hash);
+			hash = Crc64(m_relativeResX, hash);
+			hash = Crc64(m_relativeResY, hash);
+			hash = Crc64(m_numLayers, hash);
+			hash = Crc64(m_mipLevels, hash);
+			hash = Crc64(m_isCubemap, hash);
+			hash = Crc64(m_format, hash);
+			hash = Crc64(m_filter, hash);
+			hash = Crc64(m_wrap, hash);
+			hash = Crc64(m_persistent, hash);
+			hash = Crc64(m_mipFilter, hash);
+			hash = Crc64(m_atlasX, hash);
+			hash = Crc64(m_atlasY, hash);
+			hash = Crc64(m_autoMips, hash);
+			m_hash = hash;
+		}
+
+		void Print(const char* indent = "") const
+		{
+			printf("%sm_hash = 0x%08x%08x\n", indent, (uint32)(m_hash >> 32), (uint32)m_hash);
+			printf("%sm_name = \"%s\"\n", indent, m_name.c_str());
+			printf("%sm_path = \"%s\"\n", indent, m_path.c_str());
+			printf("%sm_resolutionX = %u\n", indent, m_resolutionX);
+			printf("%sm_resolutionY = %u\n", indent, m_resolutionY);
+			printf("%sm_resolutionZ = %u\n", indent, m_resolutionZ);
+			printf("%sm_relativeResX = %f\n", indent, m_relativeResX);
+			printf("%sm_relativeResY = %f\n", indent, m_relativeResY);
+			printf("%sm_numLayers = %u\n", indent, m_numLayers);
+			printf("%sm_mipLevels = %u\n", indent, m_mipLevels);
+			printf("%sm_isCubemap = %s\n", indent, m_isCubemap ? "TRUE" : "FALSE");
+			printf("%sm_format = %s\n", indent, GetDX10FormatStr(m_format, true));
+			printf("%sm_filter = %s\n", indent, m_filter ? "TRUE" : "FALSE");
+			printf("%sm_wrap = %s\n", indent, m_wrap ? "TRUE" : "FALSE");
+			printf("%sm_persistent = %s\n", indent, m_persistent ? "TRUE" : "FALSE");
+			printf("%sm_mipFilter = %s\n", indent, MipGenerator::GetFilterStr(m_mipFilter));
+			printf("%sm_atlas = %ux%u\n", indent, m_atlasX, m_atlasY);
+			printf("%sm_autoMips = %s\n", indent, m_autoMips ? "TRUE" : "FALSE");
+		}
+
+		uint64 m_hash;
+		std::string m_name;
+		std::string m_path;
+		uint32 m_resolutionX; // specified resolution
+		uint32 m_resolutionY;
+		uint32 m_resolutionZ;
+		float m_relativeResX; // if >0, xy resolution will be relative to main viewport
+		float m_relativeResY;
+		uint32 m_numLayers;
+		uint32 m_mipLevels;
+		bool m_isCubemap; // 6 faces per layer
+		DDS_DXGI_FORMAT m_format;
+		bool m_filter;
+		bool m_wrap;
+		bool m_persistent; // never alias this buffer's storage, even if its contents look dead between passes
+		MipGenerator::eFilter m_mipFilter; // for mips generated from image files
+		uint32 m_atlasX; // tile columns and rows of array or volume image files, 0 to guess (see DecodeImages)
+		uint32 m_atlasY;
+		bool m_autoMips; // mips are regenerated after each pass which writes mip 0
+		bool m_autoMipsDefault; // automips wasn't specified on a render target with mips - it's on unless a pass writes mip > 0 itself (see ResolveAutoMips)
+	};
+
+	static ShaderToyBuffer* Add(int passIndex, const char* name, const NameValuePairs* nvp = nullptr)
+	{
+		TRACE_SCOPE_DETAIL("ShaderToyBuffer::Add", name);
+		const char* bufferDescParams[] = {
+			"path",
+			"width",
+			"height",
+			"depth",
+			"relative_width",
+			"relative_height",
+			"layers",
+			"mips",
+			"format",
+			"filter",
+			"wrap",
+			"persistent",
+			"mipfilter",
+			"cubemap",
+			"atlas",
+			"automips",
+		};
+		Desc desc;
+		desc.m_name = name;
+		if (strcmp(name, "[KEYBOARD]") == 0) {
+			desc.m_path = "";
+			desc.m_resolutionX = KEYBOARD_INPUT_TEXTURE_WIDTH;
+			desc.m_resolutionY = KEYBOARD_INPUT_TEXTURE_HEIGHT;
+			desc.m_resolutionZ = 1;
+			desc.m_relativeResX = 0.0f;
+			desc.m_relativeResY = 0.0f;
+			desc.m_numLayers = 1;
+			desc.m_mipLevels = 1;
+			desc.m_isCubemap = false;
+			desc.m_format = DDS_DXGI_FORMAT_R8_UNORM;
+			desc.m_filter = false;
+			desc.m_wrap = false;
+		} else if (strcmp(name, "[KEYBOARD2]") == 0) {
+			desc.m_path = "";
+			desc.m_resolutionX = KEYBOARD2_INPUT_TEXTURE_WIDTH;
+			desc.m_resolutionY = KEYBOARD2_INPUT_TEXTURE_HEIGHT;
+			desc.m_resolutionZ = 1;
+			desc.m_relativeResX = 0.0f;
+			desc.m_relativeResY = 0.0f;
+			desc.m_numLayers = 1;
+			desc.m_mipLevels = 1;
+			desc.m_isCubemap = false;
+			desc.m_format = DDS_DXGI_FORMAT_R32_UINT;
+			desc.m_filter = false;
+			desc.m_wrap = false;
+		} else {
+			desc.m_path = GetPortablePath(nvp->GetStringValue("path", ""));
+			desc.m_resolutionX = nvp->GetUIntValue("width");
+			desc.m_resolutionY = nvp->GetUIntValue("height");
+			desc.m_resolutionZ = nvp->GetUIntValue("depth", 1);
+			desc.m_relativeResX = nvp->GetFloatValue("relative_width");
+			desc.m_relativeResY = nvp->GetFloatValue("relative_height");
+			desc.m_numLayers = nvp->GetUIntValue("layers", 1);
+			desc.m_mipLevels = nvp->GetUIntValue("mips", 1);
+			desc.m_isCubemap = nvp->GetBoolValue("cubemap");
+			desc.m_format = GetDX10FormatFromString(nvp->GetStringValue("format", "UNKNOWN"));
+			desc.m_filter = nvp->GetBoolValue("filter", !desc.m_path.empty());
+			desc.m_wrap = nvp->GetBoolValue("wrap");
+			desc.m_persistent = nvp->GetBoolValue("persistent");
+			desc.m_mipFilter = MipGenerator::GetFilterFromString(nvp->GetStringValue("mipfilter", "BOX"));
+			if (sscanf(nvp->GetStringValue("atlas", ""), "%ux%u", &desc.m_atlasX, &desc.m_atlasY) != 2)
+				desc.m_atlasX = desc.m_atlasY = 0;
+			desc.m_autoMipsDefault = !nvp->HasValue("automips") && desc.m_path.empty() && desc.m_mipLevels > 1;
+			desc.m_autoMips = nvp->GetBoolValue("automips", desc.m_autoMipsDefault);
+			if (desc.m_autoMips && !nvp->HasValue("mips"))
+				desc.m_mipLevels = 32; // full chain, clamped to the resolution in Update
+			DDSFileInfo dds;
+			if (IsDDSPath(desc.m_path.c_str()) && ReadDDSFileInfo(dds, desc.m_path.c_str())) { // layout and format come from the file
+				desc.m_resolutionZ = dds.m_d;
+				desc.m_numLayers = dds.m_arraySize;
+				desc.m_isCubemap = dds.m_isCubemap;
+				desc.m_format = dds.m_format;
+				if (!nvp->HasValue("mips"))
+					desc.m_mipLevels = dds.m_mipCount;
+			}
+		}
+
+		// defaults
+		if (desc.m_relativeResX <= 0.0f && desc.m_resolutionX == 0 && desc.m_path.empty())
+			desc.m_relativeResX = 1.0f;
+		if (desc.m_relativeResY <= 0.0f && desc.m_resolutionY == 0 && desc.m_path.empty())
+			desc.m_relativeResY = 1.0f;
+		if (desc.m_mipLevels == 0)
+			desc.m_mipLevels = 1;
+		if (desc.m_format == DDS_DXGI_FORMAT_UNKNOWN)
+			desc.m_format = desc.m_path.empty() ? DDS_DXGI_FORMAT_R32G32B32A32_FLOAT : DDS_DXGI_FORMAT_R8G8B8A8_UNORM;
+	#if 1 // my laptop (GeForce 940MX)
+		uint32 maxTextureRes2D = 16384;
+		uint32 maxTextureRes3D = 2048;
+		uint32 maxTextureLayers = 2048;
+	#else // my work desktop (RTX 2080)
+		uint32 maxTextureRes2D = 32768;
+		uint32 maxTextureRes3D = 16384;
+		uint32 maxTextureLayers = 2048;
+	#endif
+		if (1) { // query opengl implementation
+			glGetIntegerv(GL_MAX_TEXTURE_SIZE, (GLint*)&maxTextureRes2D);
+			glGetIntegerv(GL_MAX_3D_TEXTURE_SIZE, (GLint*)&maxTextureRes3D);
+			glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, (GLint*)&maxTextureLayers);
+			static bool once = true;
+			if (once) {
+				once = false;
+				printf("GL_MAX_TEXTURE_SIZE = %u\n", maxTextureRes2D);
+				printf("GL_MAX_3D_TEXTURE_SIZE = %u\n", maxTextureRes3D);
+				printf("GL_MAX_ARRAY_TEXTURE_LAYERS = %u\n", maxTextureLayers);
+			}
+		}
+		if (desc.m_resolutionZ > 1) {
+			if (Max(desc.m_resolutionX, desc.m_resolutionY, desc.m_resolutionZ) > maxTextureRes3D) {
+				printf("warning: 3D texture \"%s\" resolution %ux%ux%u exceeded maximum %u, clamping ..\n", name, desc.m_resolutionX, desc.m_resolutionY, desc.m_resolutionZ, maxTextureRes3D);
+				desc.m_resolutionX = Min(desc.m_resolutionX, maxTextureRes3D);
+				desc.m_resolutionY = Min(desc.m_resolutionY, maxTextureRes3D);
+				desc.m_resolutionZ = Min(desc.m_resolutionZ, maxTextureRes3D);
+			}
+			if (desc.m_numLayers > 1) {
+				printf("warning: 3D texture \"%s\" specified with %u layers, cannot have layers ..\n", name, desc.m_numLayers);
+				desc.m_numLayers = 1;
+			}
+		} else if (Max(desc.m_resolutionX, desc.m_resolutionY) > maxTextureRes2D) {
+			printf("warning: 2D texture \"%s\" resolution %ux%u exceeded maximum %u, clamping ..\n", name, desc.m_resolutionX, desc.m_resolutionY, maxTextureRes2D);
+			desc.m_resolutionX = Min(desc.m_resolutionX, maxTextureRes2D);
+			desc.m_resolutionY = Min(desc.m_resolutionY, maxTextureRes2D);
+		}
+		if (desc.m_isCubemap) {
+			if (desc.m_resolutionZ > 1) {
+				printf("warning: 3D texture \"%s\" specified as cubemap, cannot be both ..\n", name);
+				desc.m_isCubemap = false;
+			} else if (!desc.IsImmutable()) {
+				printf("warning: cubemap \"%s\" specified with relative resolution, cubemaps need fixed square faces ..\n", name);
+				desc.m_isCubemap = false;
+			} else if (desc.m_path.empty() && desc.m_resolutionX != desc.m_resolutionY) {
+				printf("warning: cubemap \"%s\" specified with %ux%u faces, making them square ..\n", name, desc.m_resolutionX, desc.m_resolutionY);
+				desc.m_resolutionX = desc.m_resolutionY = Max(desc.m_resolutionX, desc.m_resolutionY);
+			} else if (!desc.m_path.empty() && desc.m_numLayers > 1 && !IsDDSPath(desc.m_path.c_str())) {
+				printf("warning: cubemap \"%s\" specified with %u layers, cubemap arrays can only be loaded from DDS files ..\n", name, desc.m_numLayers);
+				desc.m_numLayers = 1;
+			}
+		}
+		if (desc.m_resolutionZ > 1 && TextureFormatInfo(desc.m_format).m_compressed) {
+			printf("warning: 3D texture \"%s\" specified with compressed format %s, using R8G8B8A8_UNORM ..\n", name, GetDX10FormatStr(desc.m_format, true));
+			desc.m_format = DDS_DXGI_FORMAT_R8G8B8A8_UNORM;
+		}
+		if (desc.m_numLayers > maxTextureLayers) {
+			printf("warning: texture \"%s\" specified with %u layers exceeded maximum %u, clamping ..\n", name, desc.m_numLayers, maxTextureLayers);
+			desc.m_numLayers = maxTextureLayers;
+		}
+		if (desc.m_autoMips) {
+			if (!desc.m_path.empty()) {
+				printf("warning: texture \"%s\" loaded from an image specified with automips, mips are generated when it loads ..\n", name);
+				desc.m_autoMips = false;
+			} else if (TextureFormatInfo(desc.m_format).m_samplerType != TextureFormatInfo::SAMPLER_TYPE_FLOAT) {
+				if (!desc.m_autoMipsDefault) {
+					printf("warning: integer texture \"%s\" specified with automips, cannot generate mips ..\n", name);
+					desc.m_mipLevels = 1;
+				}
+				desc.m_autoMips = false;
+				desc.m_autoMipsDefault = false;
+			}
+		}
+		if (desc.m_path.empty()) {
+			ForceAssert((desc.m_relativeResX == 0.0f && desc.m_resolutionX > 0) || (desc.m_relativeResX > 0.0f && desc.m_resolutionX == 0)); 
+			ForceAssert((desc.m_relativeResY == 0.0f && desc.m_resolutionY > 0) || (desc.m_relativeResY > 0.0f && desc.m_resolutionY == 0)); 
+		} else {
+			ForceAssert(desc.m_relativeResX == 0.0f && desc.m_relativeResY == 0.0f);
+			// texture gets its xy resolution from the image file, depth and layers select how it's cut up (see DecodeImages)
+		}
+
+		ShaderToyBuffer* buffer = Find(name);
+		std::vector<std::string> imagePaths;
+		GetImagePaths(imagePaths, desc);
+		const bool loadImage = !desc.m_path.empty() && FileExists(imagePaths[0].c_str());
+		const uint32 maxMipLevels = desc.m_mipLevels;
+		if (!desc.m_path.empty()) {
+			if (!loadImage)
+				desc.m_path = "[DEFAULT]";
+			desc.m_resolutionX = 4; // tiny black squares, replaced when the image has loaded (see LoadImageJob)
+			desc.m_resolutionY = 4;
+		}
+		desc.CalculateHash();
+		if (buffer) {
+			if (desc.m_hash != buffer->m_desc.m_hash && nvp && nvp->size() > 1) {
+				// let's see if there are actually any buffer description params - nvp might just contain other params (e.g. layer=xxx for outputs)
+				bool hasBufferDescParams = false;
+				for (int i = 0; i < icountof(bufferDescParams); i++) {
+					if (nvp->HasValue(bufferDescParams[i])) {
+						hasBufferDescParams = true;
+						break;
+					}
+				}
+				if (hasBufferDescParams) {
+					printf("warning: buffer hash mismatch for \"%s\" in pass %i!\n", name, passIndex);
+					printf("existing buffer was:\n");
+					buffer->m_desc.Print("\t");
+					printf("new buffer is:\n");
+					desc.Print("\t");
+				}
+			}
+		} else {
+			buffer = new ShaderToyBuffer();
+			buffer->m_desc = desc;
+			buffer->m_res[0] = 0;
+			buffer->m_res[1] = 0;
+			buffer->m_res[2] = 0;
+			buffer->m_textureIDs[0] = 0;
+			buffer->m_textureIDs[1] = 0;
+			buffer->m_front = 0;
+			buffer->m_doubleBuffered = false;
+			buffer->m_aliasOf = nullptr;
+			buffer->m_target = GL_NONE;
+			if (!desc.m_path.empty()) { // placeholder has the same target as the loaded texture, so shaders see the right sampler type
+				Vec4V* image = new Vec4V[4*4];
+				memset(image, 0, 4*4*sizeof(Vec4V));
+				MipChain mips;
+				const bool isVolume = desc.m_resolutionZ > 1;
+				const uint32 numImages = isVolume ? desc.m_resolutionZ : desc.m_numLayers*(desc.m_isCubemap ? 6 : 1);
+				for (uint32 i = 0; i < numImages; i++)
+					BuildMips(mips, image, 4, 4, isVolume ? 1 : Min(3U, desc.m_mipLevels), desc.m_format, desc.m_mipFilter);
+				if (isVolume)
+					mips.MakeVolume();
+				buffer->Update(&mips);
+				delete[] image;
+			} else
+				buffer->Update();
+			GetMap()[name] = buffer;
+			if (loadImage) {
+				std::shared_ptr<PendingLoad> load = std::make_shared<PendingLoad>();
+				buffer->m_pendingLoad = load;
+				if (GetNumPendingLoads()++ == 0)
+					GetPendingLoadsStartTime() = ProgressDisplay::GetCurrentPerformanceTime();
+				JobSystem::Submit([desc, maxMipLevels, load]() { LoadImageJob(desc, maxMipLevels, load); });
+			}
+		}
+		return buffer;
+	}
+
+	// converted texel data, contiguous and ordered as in a DDS file (each image with all its mips, volume slices within
+	// each mip) - either owned or pointing into a mapped DDS file
+	class MipChain
+	{
+	public:
+		MipChain() : m_w(0), m_h(0), m_d(1), m_numImages(0), m_mappedOffset(0) {}
+		const uint8* GetData() const { return m_mapped ? m_mapped->m_data + m_mappedOffset : m_data.data(); }
+		uint32 GetNumMips() const { return m_numImages ? (uint32)m_sizes.size()/m_numImages : 0; }
+
+		size_t GetSizeInBytes() const
+		{
+			size_t size = 0;
+			for (uint32 i = 0; i < m_sizes.size(); i++)
+				size += m_sizes[i];
+			return size;
+		}
+
+		bool MakeVolume() // turns the images (one mip each) into the slices of a volume, mips are generated on the GPU
+		{
+			for (uint32 i = 0; i < m_sizes.size(); i++)
+				if (m_sizes[i] == 0)
+					return false;
+			m_d = m_numImages;
+			m_numImages = 1;
+			m_sizes.assign(1, (uint32)m_data.size());
+			return true;
+		}
+
+		uint32 m_w;
+		uint32 m_h;
+		uint32 m_d; // slices of a volume
+		uint32 m_numImages; // layers (times 6 for cubemaps)
+		std::vector<uint32> m_sizes; // per image and mip, 0 if the conversion failed
+		std::vector<uint8> m_data;
+		std::shared_ptr<MappedFile> m_mapped;
+		size_t m_mappedOffset;
+	};
+
+	// image files are decoded, mipped and converted on a JobSystem worker, while passes render with the placeholder
+	class PendingLoad
+	{
+	public:
+		PendingLoad() : m_done(false) {}
+		std::atomic<bool> m_done;
+		MipChain m_mips; // no mips if the image failed to load
+	};
+
+	// the converted mips are baked to _processed/<image>_<desc hash>.dds, tagged with a key covering the desc, the
+	// source file contents and BAKED_TEXTURE_VERSION. when the key matches the file is memory mapped and uploaded as is -
+	// no decode, mip generation or format conversion (which is most of the cost for BC formats)
+	static std::string GetBakedTexturePath(const char* path, uint64 descHash)
+	{
+		return GetProcessedPath(PathExt(path, "_%08x%08x.dds", (uint32)(descHash >> 32), (uint32)descHash));
+	}
+
+	enum { BAKED_TEXTURE_TAG = 0x4B425453 }; // 'STBK' in DDS_HEADER::dwReserved1[0], the key follows in [1] and [2]
+	enum { BAKED_TEXTURE_VERSION = 1 }; // in DDS_HEADER::dwReserved1[3] - bump when decoding, mip filtering, format conversion or the baked layout changes
+
+	static uint32 GetMipSizeInBytes(uint32 w, uint32 h, uint32 mipIndex, DDS_DXGI_FORMAT format)
+	{
+		const uint32 bs = GetDX10FormatBlockSize(format);
+		const uint32 blockSizeInBytes = (GetDX10FormatBitsPerPixel(format)*bs*bs)/8;
+		const uint32 mw = Max(1U, w >> mipIndex);
+		const uint32 mh = Max(1U, h >> mipIndex);
+		return ((mw + bs - 1)/bs)*((mh + bs - 1)/bs)*blockSizeInBytes;
+	}
+
+	// points the mip chain at the texel data of a mapped DDS file
+	static bool MapDDSFile(MipChain& mips, const std::shared_ptr<MappedFile>& file, const DDSFileInfo& info)
+	{
+		mips.m_w = info.m_w;
+		mips.m_h = info.m_h;
+		mips.m_d = info.m_d;
+		mips.m_numImages = info.m_arraySize*(info.m_isCubemap ? 6 : 1);
+		mips.m_sizes.resize(mips.m_numImages*info.m_mipCount);
+		for (uint32 imageIndex = 0; imageIndex < mips.m_numImages; imageIndex++)
+			for (uint32 mipIndex = 0; mipIndex < info.m_mipCount; mipIndex++)
+				mips.m_sizes[imageIndex*info.m_mipCount + mipIndex] = GetMipSizeInBytes(info.m_w, info.m_h, mipIndex, info.m_format)*Max(1U, info.m_d >> mipIndex);
+		if (file->m_size < info.m_dataOffset + mips.GetSizeInBytes()) { // truncated
+			mips.m_sizes.clear();
+			mips.m_numImages = 0;
+			return false;
+		}
+		mips.m_mapped = file;
+		mips.m_mappedOffset = info.m_dataOffset;
+		return true;
+	}
+
+	static bool LoadBakedTexture(MipChain& mips, const char* bakedPath, uint64 key, DDS_DXGI_FORMAT format)
+	{
+		std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>();
+		DDSFileInfo info;
+		if (!file->Open(bakedPath) || !ParseDDSFileHeader(info, file->m_data, file->m_size) || info.m_dataOffset != DDS_FILE_HEADER_DWORDS*sizeof(uint32))
+			return false;
+		const uint32* header = (const uint32*)file->m_data;
+		if (header[8] != BAKED_TEXTURE_TAG || header[9] != (uint32)key || header[10] != (uint32)(key >> 32) || header[11] != BAKED_TEXTURE_VERSION || info.m_format != format)
+			return false; // stale
+		return MapDDSFile(mips, file, info);
+	}
+
+	// deletes the bakes in dir written by an older BAKED_TEXTURE_VERSION, which would otherwise sit next to their
+	// replacements forever. only the first bake into each directory pays for the scan
+	static void RemoveStaleBakedTextures(const char* dir)
+	{
+		static std::mutex mutex;
+		static std::set<std::string> scanned;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (!scanned.insert(dir).second)
+				return;
+		}
+		std::vector<std::string> files;
+		GetDirectoryEntries(&files, nullptr, dir);
+		uint32 numRemoved = 0;
+		for (uint32 i = 0; i < files.size(); i++) {
+			if (!IsDDSPath(files[i].c_str()))
+				continue;
+			uint32 header[12];
+			FILE* file = fopen(files[i].c_str(), "rb");
+			const bool stale = file && fread(header, sizeof(header), 1, file) == 1 && header[8] == BAKED_TEXTURE_TAG && header[11] != BAKED_TEXTURE_VERSION;
+			if (file)
+				fclose(file);
+			if (stale && remove(files[i].c_str()) == 0)
+				numRemoved++;
+		}
+		if (numRemoved > 0)
+			printf("removed %u stale baked textures from %s\n", numRemoved, dir);
+	}
+
+	static void SaveBakedTexture(const MipChain& mips, const char* bakedPath, uint64 key, DDS_DXGI_FORMAT format, bool isCubemap)
+	{
+		for (uint32 i = 0; i < mips.m_sizes.size(); i++)
+			if (mips.m_sizes[i] == 0)
+				return; // conversion failed, don't bake it
+		std::string dir = bakedPath;
+		const size_t slash = dir.find_last_of("\\/");
+		dir.resize(slash != std::string::npos ? slash : 0);
+		if (!dir.empty())
+			CreateDirectoryIfMissing(dir.c_str());
+		RemoveStaleBakedTextures(dir.empty() ? "." : dir.c_str());
+		// written under a name of its own and renamed when complete, so a crash or another process baking the same
+		// texture never leaves a partial file at bakedPath
+		const std::string tempPath = varString("%s.%llx.tmp", bakedPath, (unsigned long long)(ProgressDisplay::GetCurrentPerformanceTime() ^ std::hash<std::thread::id>()(std::this_thread::get_id())));
+		FILE* file = fopen(tempPath.c_str(), "wb");
+		if (file == nullptr) {
+			fprintf(stderr, "failed to write baked texture \"%s\"\n", bakedPath);
+			return;
+		}
+		uint32 header[DDS_FILE_HEADER_DWORDS];
+		BuildDDSFileHeader(header, mips.m_w, mips.m_h, mips.m_d, mips.m_numImages/(isCubemap ? 6 : 1), isCubemap, mips.GetNumMips(), format);
+		header[8] = BAKED_TEXTURE_TAG;
+		header[9] = (uint32)key;
+		header[10] = (uint32)(key >> 32);
+		header[11] = BAKED_TEXTURE_VERSION;
+		bool ok = fwrite(header, sizeof(header), 1, file) == 1;
+		ok = ok && fwrite(mips.GetData(), mips.m_data.size(), 1, file) == 1;
+		ok = (fclose(file) == 0) && ok;
+		if (ok && RenameFile(tempPath.c_str(), bakedPath))
+			g_NumTexturesBaked++;
+		else {
+			fprintf(stderr, "failed to write baked texture \"%s\"\n", bakedPath);
+			remove(tempPath.c_str());
+		}
+	}
+
+	// a cubemap can be six files - the path contains %s, which is replaced with px,nx,py,ny,pz,nz
+	static void GetImagePaths(std::vector<std::string>& paths, const Desc& desc)
+	{
+		const size_t faces = desc.m_isCubemap ? desc.m_path.find("%s") : std::string::npos;
+		if (faces != std::string::npos) {
+			const char* faceNames[] = {"px", "nx", "py", "ny", "pz", "nz"};
+			for (int face = 0; face < icountof(faceNames); face++)
+				paths.push_back(std::string(desc.m_path).replace(faces, 2, faceNames[face]));
+		} else
+			paths.push_back(desc.m_path);
+	}
+
+	static void LoadImageJob(const Desc& desc, uint32 maxMipLevels, std::shared_ptr<PendingLoad> load)
+	{
+		TRACE_SCOPE_DETAIL("LoadImageJob", desc.m_path.c_str());
+		if (IsDDSPath(desc.m_path.c_str())) { // already converted (desc format and layout came from its header), upload as is
+			std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>();
+			DDSFileInfo info;
+			if (file->Open(desc.m_path.c_str()) && ParseDDSFileHeader(info, file->m_data, file->m_size) && info.m_format == desc.m_format)
+				MapDDSFile(load->m_mips, file, info);
+			load->m_done = true;
+			return;
+		}
+		std::vector<std::string> paths;
+		GetImagePaths(paths, desc);
+		uint64 key = Crc64((uint32)BAKED_TEXTURE_VERSION, Crc64(desc.m_hash, 0));
+		std::string bakedPath;
+		if (g_TextureBakeCache) {
+			bool sourcesMapped = true;
+			for (uint32 i = 0; i < paths.size() && sourcesMapped; i++) {
+				MappedFile source;
+				sourcesMapped = source.Open(paths[i].c_str());
+				if (sourcesMapped)
+					key = Crc64(source.m_data, source.m_size, key);
+			}
+			if (sourcesMapped) {
+				bakedPath = GetBakedTexturePath(paths[0].c_str(), desc.m_hash);
+				if (!g_TextureBakeRebuild && LoadBakedTexture(load->m_mips, bakedPath.c_str(), key, desc.m_format)) {
+					g_NumBakedTexturesLoaded++;
+					load->m_done = true;
+					return;
+				}
+			}
+		}
+		if (DecodeImages(load->m_mips, desc, paths, maxMipLevels) && !bakedPath.empty())
+			SaveBakedTexture(load->m_mips, bakedPath.c_str(), key, desc.m_format, desc.m_isCubemap);
+		load->m_done = true;
+	}
+
+	// decodes the image files and cuts them into tiles - cubemap faces, array layers or volume slices:
+	// cubemap: six files, a 1x6 or 6x1 strip (+x,-x,+y,-y,+z,-z), or a 4x3 or 3x4 cross
+	// array/volume: an atlas of 'layers' or 'depth' tiles, in 'atlas=CxR' columns and rows (default a strip if the
+	//   image is one, otherwise a near square grid), ordered left to right and top to bottom
+	static bool DecodeImages(MipChain& mips, const Desc& desc, const std::vector<std::string>& paths, uint32 maxMipLevels)
+	{
+		std::vector<Vec4V*> images;
+		uint32 w = 0;
+		uint32 h = 0;
+		bool ok = true;
+		for (uint32 i = 0; i < paths.size() && ok; i++) {
+			int iw = 0;
+			int ih = 0;
+			Vec4V* image = LoadImage_Vec4V(paths[i].c_str(), iw, ih);
+			ok = image != nullptr && (images.empty() || ((uint32)iw == w && (uint32)ih == h));
+			if (image)
+				images.push_back(image);
+			w = (uint32)iw;
+			h = (uint32)ih;
+		}
+		class Tile
+		{
+		public:
+			Tile(uint32 image, uint32 x, uint32 y, bool rotate180 = false) : m_image(image), m_x(x), m_y(y), m_rotate180(rotate180) {}
+			uint32 m_image;
+			uint32 m_x; // in tiles
+			uint32 m_y;
+			bool m_rotate180; // -z face of a vertical cross
+		};
+		std::vector<Tile> tiles;
+		uint32 tileW = w;
+		uint32 tileH = h;
+		if (!ok)
+			fprintf(stderr, "failed to load image \"%s\"\n", desc.m_path.c_str());
+		else if (images.size() == 6 && w == h) {
+			for (uint32 face = 0; face < 6; face++)
+				tiles.push_back(Tile(face, 0, 0));
+		} else if (desc.m_isCubemap) {
+			const uint32 crossX[] = {2, 0, 1, 1, 1, 3};
+			const uint32 crossY[] = {1, 1, 0, 2, 1, 1};
+			if (h == w*6 || w == h*6) { // strip
+				tileW = tileH = Min(w, h);
+				for (uint32 face = 0; face < 6; face++)
+					tiles.push_back(h > w ? Tile(0, 0, face) : Tile(0, face, 0));
+			} else if (w*3 == h*4 || w*4 == h*3) { // cross
+				const bool vertical = h > w;
+				tileW = tileH = w/(vertical ? 3 : 4);
+				for (uint32 face = 0; face < 6; face++)
+					tiles.push_back(vertical && face == 5 ? Tile(0, 1, 3, true) : Tile(0, crossX[face], crossY[face]));
+			} else
+				fprintf(stderr, "cubemap image \"%s\" (%ux%u) is not a strip or cross of square faces\n", desc.m_path.c_str(), w, h);
+		} else {
+			const uint32 numTiles = Max(desc.m_resolutionZ, desc.m_numLayers);
+			uint32 cols = desc.m_atlasX;
+			uint32 rows = desc.m_atlasY;
+			if (cols*rows == 0) {
+				if (w == h*numTiles || h == w*numTiles) {
+					cols = w > h ? numTiles : 1;
+					rows = w > h ? 1 : numTiles;
+				} else {
+					cols = (uint32)Ceiling(sqrtf((float)numTiles));
+					rows = (numTiles + cols - 1)/cols;
+				}
+			}
+			if (cols*rows >= numTiles && w%cols == 0 && h%rows == 0) {
+				tileW = w/cols;
+				tileH = h/rows;
+				for (uint32 i = 0; i < numTiles; i++)
+					tiles.push_back(Tile(0, i%cols, i/cols));
+			} else
+				fprintf(stderr, "image \"%s\" (%ux%u) can't be split into %u tiles of %ux%u\n", desc.m_path.c_str(), w, h, numTiles, cols, rows);
+		}
+		const bool isVolume = desc.m_resolutionZ > 1;
+		const uint32 mipLevels = isVolume ? 1 : Min(Log2FloorInt(Max(tileW, tileH)) + 1U, maxMipLevels);
+		Vec4V* tile = tiles.size() > 1 ? new Vec4V[tileW*tileH] : nullptr;
+		for (uint32 i = 0; i < tiles.size(); i++) {
+			const Tile& t = tiles[i];
+			const Vec4V* src = images[t.m_image];
+			if (tile) {
+				for (uint32 y = 0; y < tileH; y++) {
+					for (uint32 x = 0; x < tileW; x++) {
+						const uint32 sx = t.m_rotate180 ? tileW - 1 - x : x;
+						const uint32 sy = t.m_rotate180 ? tileH - 1 - y : y;
+						tile[x + y*tileW] = src[t.m_x*tileW + sx + (t.m_y*tileH + sy)*w];
+					}
+				}
+			}
+			BuildMips(mips, tile ? tile : src, tileW, tileH, mipLevels, desc.m_format, desc.m_mipFilter);
+		}
+		delete[] tile;
+		for (uint32 i = 0; i < images.size(); i++)
+			delete[] images[i];
+		if (isVolume && !tiles.empty() && !mips.MakeVolume())
+			tiles.clear();
+		if (tiles.empty()) {
+			mips = MipChain();
+			return false;
+		}
+		return true;
+	}
+
+	// downsamples and converts an image to the texture format, appending it to the chain
+	static void BuildMips(MipChain& mips, const Vec4V* image, uint32 w, uint32 h, uint32 mipLevels, DDS_DXGI_FORMAT format, MipGenerator::eFilter mipFilter)
+	{
+		const bool sRGB =
+			format == DDS_DXGI_FORMAT_R8G8B8A8_UNORM_SRGB ||
+			format == DDS_DXGI_FORMAT_B8G8R8A8_UNORM_SRGB ||
+			format == DDS_DXGI_FORMAT_B8G8R8X8_UNORM_SRGB ||
+			format == DDS_DXGI_FORMAT_BC1_UNORM_SRGB      ||
+			format == DDS_DXGI_FORMAT_BC2_UNORM_SRGB      ||
+			format == DDS_DXGI_FORMAT_BC3_UNORM_SRGB      ||
+			format == DDS_DXGI_FORMAT_BC7_UNORM_SRGB;
+		std::vector<Vec4V*> levels;
+		MipGenerator::Generate(levels, image, w, h, mipLevels, mipFilter, sRGB);
+		mips.m_w = w;
+		mips.m_h = h;
+		mips.m_numImages++;
+		size_t offset = mips.m_data.size();
+		size_t totalSize = offset;
+		for (uint32 mipIndex = 0; mipIndex < mipLevels; mipIndex++)
+			totalSize += GetMipSizeInBytes(w, h, mipIndex, format);
+		mips.m_data.resize(totalSize);
+		for (uint32 mipIndex = 0; mipIndex < mipLevels; mipIndex++) {
+			const uint32 mw = Max(1U, w >> mipIndex);
+			const uint32 mh = Max(1U, h >> mipIndex);
+			uint32 size = GetMipSizeInBytes(w, h, mipIndex, format);
+			if (!ForceAssertVerify(ConvertPixelsToDX10Format(mips.m_data.data() + offset, format, levels[mipIndex], mw, mh, sRGB)))
+				size = 0;
+			mips.m_sizes.push_back(size);
+			offset += size;
+		}
+		mips.m_data.resize(offset);
+		MipGenerator::Free(levels);
+	}
+
+	// uploads the mips of the bound texture through a pixel buffer, so the driver can copy them asynchronously. mips
+	// missing from the chain (volumes) are generated from the top level
+	static void UploadMips(const MipChain& mips, GLenum target, uint32 mipLevels, const TextureFormatInfo& info)
+	{
+		static GLuint pixelBufferID = 0;
+		const size_t totalSize = mips.GetSizeInBytes();
+		if (pixelBufferID == 0)
+			glGenBuffers(1, &pixelBufferID);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBufferID);
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, totalSize, nullptr, GL_STREAM_DRAW); // orphan, previous uploads may still be reading it
+		uint8* dst = (uint8*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, totalSize, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+		if (dst) {
+			memcpy(dst, mips.GetData(), totalSize); // straight from the mapped file for baked textures
+			glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+		} else
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0); // upload from client memory
+		const uint32 numMips = mips.GetNumMips();
+		size_t offset = 0;
+		for (uint32 imageIndex = 0; imageIndex < mips.m_numImages; imageIndex++) {
+			for (uint32 mipIndex = 0; mipIndex < numMips; mipIndex++) {
+				const uint32 mw = Max(1U, mips.m_w >> mipIndex);
+				const uint32 mh = Max(1U, mips.m_h >> mipIndex);
+				const uint32 md = Max(1U, mips.m_d >> mipIndex);
+				const GLsizei size = (GLsizei)mips.m_sizes[imageIndex*numMips + mipIndex];
+				const void* pixels = dst ? (const void*)offset : (const void*)(mips.GetData() + offset);
+				if (size > 0 && mipIndex < mipLevels) {
+					if (target == GL_TEXTURE_2D || target == GL_TEXTURE_CUBE_MAP) {
+						const GLenum imageTarget = target == GL_TEXTURE_CUBE_MAP ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + imageIndex : target;
+						if (info.m_compressed)
+							glCompressedTexSubImage2D(imageTarget, mipIndex, 0, 0, mw, mh, info.m_internalFormat, size, pixels);
+						else
+							glTexSubImage2D(imageTarget, mipIndex, 0, 0, mw, mh, info.m_format, info.m_type, pixels);
+					} else { // the whole volume, or one layer (layer-face for cubemap arrays) of an array
+						const uint32 z = target == GL_TEXTURE_3D ? 0 : imageIndex;
+						const uint32 depth = target == GL_TEXTURE_3D ? md : 1;
+						if (info.m_compressed)
+							glCompressedTexSubImage3D(target, mipIndex, 0, 0, z, mw, mh, depth, info.m_internalFormat, size, pixels);
+						else
+							glTexSubImage3D(target, mipIndex, 0, 0, z, mw, mh, depth, info.m_format, info.m_type, pixels);
+					}
+				}
+				offset += size;
+			}
+		}
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0); // restore
+		if (numMips < mipLevels && !info.m_compressed)
+			glGenerateMipmap(target);
+	}
+
+	void FinishPendingLoad() // replaces the placeholder texture
+	{
+		TRACE_SCOPE_DETAIL("FinishPendingLoad", m_desc.m_name.c_str());
+		std::shared_ptr<PendingLoad> load = m_pendingLoad;
+		m_pendingLoad = nullptr;
+		const MipChain& mips = load->m_mips;
+		if (mips.GetNumMips() == 0)
+			fprintf(stderr, "failed to load image \"%s\", keeping placeholder\n", m_desc.m_path.c_str());
+		else {
+			glDeleteTextures(1, &m_textureIDs[0]);
+			m_textureIDs[0] = 0;
+			m_desc.m_resolutionX = mips.m_w;
+			m_desc.m_resolutionY = mips.m_h;
+			m_desc.m_resolutionZ = mips.m_d;
+			m_desc.m_numLayers = mips.m_numImages/(m_desc.m_isCubemap ? 6 : 1);
+			if (mips.m_d == 1)
+				m_desc.m_mipLevels = mips.GetNumMips(); // volumes keep the requested mips, see UploadMips
+			Update(&load->m_mips);
+		}
+		if (--GetNumPendingLoads() == 0)
+			printf("textures loaded in %.3f secs (%u from the bake cache)\n", ProgressDisplay::GetTimeInSeconds(GetPendingLoadsStartTime()), (uint32)g_NumBakedTexturesLoaded);
+	}
+
+	static void WaitForPendingLoads() // for offline rendering, which mustn't see placeholders
+	{
+		std::map<std::string,ShaderToyBuffer*>& m = GetMap();
+		for (auto it = m.begin(); it != m.end(); ++it) {
+			if (it->second->m_pendingLoad) {
+				while (!it->second->m_pendingLoad->m_done)
+					std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				it->second->FinishPendingLoad();
+			}
+		}
+	}
+
+	static uint32& GetNumPendingLoads()
+	{
+		static uint32 numPendingLoads = 0;
+		return numPendingLoads;
+	}
+
+	static uint64& GetPendingLoadsStartTime()
+	{
+		static uint64 startTime = 0;
+		return startTime;
+	}
+
+	void Update(const MipChain* mips = nullptr) // mips are only used when the texture is (re)created
+	{
+		if (m_aliasOf) { // storage belongs to another buffer
+			m_aliasOf->Update();
+			CopyStorageInfo(m_aliasOf);
+			return;
+		}
+		if (m_pendingLoad && m_pendingLoad->m_done) {
+			FinishPendingLoad(); // calls back into Update with the mips
+			return;
+		}
+		const uint32 w = m_desc.m_relativeResX <= 0.0f ? m_desc.m_resolutionX : (uint32)Ceiling(m_desc.m_relativeResX*(float)GetRenderWidth());
+		const uint32 h = m_desc.m_relativeResY <= 0.0f ? m_desc.m_resolutionY : (uint32)Ceiling(m_desc.m_relativeResY*(float)GetRenderHeight());
+		const uint32 d = m_desc.m_resolutionZ;
+		const bool resChanged = m_res[0] != w || m_res[1] != h;
+		const uint32 numSides = m_doubleBuffered ? 2 : 1;
+		if (resChanged || m_textureIDs[numSides - 1] == 0) { // resolution changed (because window size or render scale changed), or needs setup, or back texture was just requested
+			m_res[0] = w;
+			m_res[1] = h;
+			m_res[2] = d;
+			if (m_desc.m_resolutionZ > 1)
+				m_target = GL_TEXTURE_3D;
+			else if (m_desc.m_isCubemap)
+				m_target = m_desc.m_numLayers > 1 ? GL_TEXTURE_CUBE_MAP_ARRAY : GL_TEXTURE_CUBE_MAP;
+			else
+				m_target = m_desc.m_numLayers > 1 ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D;
+			m_mipLevels = Min(Log2FloorInt(Max(w, h, d)) + 1U, m_desc.m_mipLevels); // actual mip levels
+			const bool isArrayOr3D = m_desc.m_resolutionZ > 1 || m_desc.m_numLayers > 1;
+			const TextureFormatInfo info(m_desc.m_format);
+			for (uint32 side = 0; side < numSides; side++) {
+				GLuint& textureID = m_textureIDs[side];
+				if (!resChanged && textureID != 0)
+					continue; // already allocated
+				if (textureID == 0) {
+					glGenTextures(1, &textureID);
+					glBindTexture(m_target, textureID);
+					glTexParameteri(m_target, GL_TEXTURE_MAG_FILTER, m_desc.m_filter ? GL_LINEAR : GL_NEAREST);
+					glTexParameteri(m_target, GL_TEXTURE_WRAP_S, m_desc.m_wrap ? GL_REPEAT : GL_CLAMP_TO_EDGE);
+					glTexParameteri(m_target, GL_TEXTURE_WRAP_T, m_desc.m_wrap ? GL_REPEAT : GL_CLAMP_TO_EDGE);
+					if (m_target == GL_TEXTURE_3D)
+						glTexParameteri(m_target, GL_TEXTURE_WRAP_R, m_desc.m_wrap ? GL_REPEAT : GL_CLAMP_TO_EDGE);
+					if (m_desc.m_isCubemap)
+						glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS); // global state, but nothing wants seams
+				} else
+					glBindTexture(m_target, textureID);
+				glTexParameteri(m_target, GL_TEXTURE_MIN_FILTER, m_desc.m_filter ? (m_mipLevels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR) : GL_NEAREST);
+				glTexParameteri(m_target, GL_TEXTURE_MAX_LEVEL, m_mipLevels - 1); // relative resolution textures can change mip count
+				if (m_desc.IsImmutable()) {
+					const uint32 numLayersOrSlices = m_desc.m_resolutionZ > 1 ? d : m_desc.m_numLayers*(m_desc.m_isCubemap ? 6 : 1);
+					if (isArrayOr3D)
+						glTexStorage3D(m_target, m_mipLevels, info.m_internalFormat, w, h, numLayersOrSlices);
+					else
+						glTexStorage2D(m_target, m_mipLevels, info.m_internalFormat, w, h); // 2D or cubemap
+					if (mips)
+						UploadMips(*mips, m_target, m_mipLevels, info);
+				} else {
+					const GLint border = 0;
+					for (uint32 mipIndex = 0; mipIndex < m_mipLevels; mipIndex++) {
+						const uint32 mw = Max(1U, w >> mipIndex);
+						const uint32 mh = Max(1U, h >> mipIndex);
+						const uint32 md = Max(1U, d >> mipIndex);
+						const uint32 numLayersOrSlices = m_desc.m_resolutionZ > 1 ? md : m_desc.m_numLayers*(m_desc.m_isCubemap ? 6 : 1);
+						if (isArrayOr3D)
+							glTexImage3D(m_target, mipIndex, info.m_internalFormat, mw, mh, numLayersOrSlices, border, info.m_format, info.m_type, nullptr);
+						else if (m_target == GL_TEXTURE_CUBE_MAP) {
+							for (uint32 face = 0; face < 6; face++)
+								glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, mipIndex, info.m_internalFormat, mw, mh, border, info.m_format, info.m_type, nullptr);
+						} else
+							glTexImage2D(m_target, mipIndex, info.m_internalFormat, mw, mh, border, info.m_format, info.m_type, nullptr);
+					}
+				}
+				glBindTexture(m_target, 0); // restore
+			}
+		}
+
+		// update keyboard texture
+		if (m_desc.m_name == std::string("[KEYBOARD]")) {
+			const uint32 w = KEYBOARD_INPUT_TEXTURE_WIDTH;
+			const uint32 h = KEYBOARD_INPUT_TEXTURE_HEIGHT;
+			static uint8 keyToggled[(w + 7)>>3];
+			static bool keyOnce = true;
+			if (keyOnce) {
+				keyOnce = false;
+				memset(keyToggled, 0, sizeof(keyToggled));
+			}
+			for (uint32 i = 0; i < w; i++) {
+				if (g_Keyboard.IsKeyPressed(i, Keyboard::MODIFIER_ANY))
+					keyToggled[i>>3] ^= BIT(i&7);
+			}
+			static uint8* keyboardInputData = nullptr;
+			if (keyboardInputData == nullptr)
+				keyboardInputData = new uint8[w*h];
+			memset(keyboardInputData, 0, w*h*sizeof(uint8));
+			for (uint32 i = 0; i < w; i++) {
+				if (g_Keyboard.IsKeyDown(i, Keyboard::MODIFIER_ANY))
+					keyboardInputData[i + 0*w] = 255;
+				if (g_Keyboard.IsKeyPressed(i, Keyboard::MODIFIER_ANY))
+					keyboardInputData[i + 1*w] = 255;
+				if (keyToggled[i>>3] & BIT(i&7))
+					keyboardInputData[i + 2*w] = 255;
+			}
+			const TextureFormatInfo info(DDS_DXGI_FORMAT_R8_UNORM);
+			glBindTexture(GL_TEXTURE_2D, GetTextureID());
+			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, w, h, info.m_format, info.m_type, keyboardInputData);
+			glBindTexture(GL_TEXTURE_2D, 0);
+		} else if (m_desc.m_name == std::string("[KEYBOARD2]")) {
+			const uint32 w = KEYBOARD2_INPUT_TEXTURE_WIDTH;
+			const uint32 h = KEYBOARD2_INPUT_TEXTURE_HEIGHT;
+			static uint32* keyboardInputData = nullptr;
+			if (keyboardInputData == nullptr) {
+				keyboardInputData = new uint32[w*h];
+				memset(keyboardInputData, 0, w*h*sizeof(uint32));
+			}
+			for (uint32 i = 0; i < w; i++) {
+				for (uint32 modifiers = 0; modifiers < 8; modifiers++) {
+					StaticAssert(BIT(0) == Keyboard::MODIFIER_SHIFT); // make sure Keyboard::MODIFIERS matches the layout here
+					StaticAssert(BIT(1) == Keyboard::MODIFIER_CONTROL);
+					StaticAssert(BIT(2) == Keyboard::MODIFIER_ALT);
+					if (g_Keyboard.IsKeyPressed(i, modifiers))
+						keyboardInputData[i + (KEYBOARD2_ROW_COUNTER_NO_MODIFIERS + modifiers)*w]++;
+				}
+				uint32 state = KEYBOARD2_STATE_UP;
+				if (g_Keyboard.IsKeyPressed(i, Keyboard::MODIFIER_ANY)) {
+					keyboardInputData[i + KEYBOARD2_ROW_COUNTER_ANY_MODIFIERS*w]++;
+					state = KEYBOARD2_STATE_PRESSED;
+				} else if (g_Keyboard.IsKeyReleased(i))
+					state = KEYBOARD2_STATE_RELEASED;
+				else if (g_Keyboard.IsKeyDown(i, Keyboard::MODIFIER_ANY))
+					state = KEYBOARD2_STATE_DOWN;
+				keyboardInputData[i + KEYBOARD2_ROW_STATE*w] = state;
+			}
+			const TextureFormatInfo info(DDS_DXGI_FORMAT_R32_UINT);
+			glBindTexture(GL_TEXTURE_2D, GetTextureID());
+			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, w, h, info.m_format, info.m_type, keyboardInputData);
+			glBindTexture(GL_TEXTURE_2D, 0);
+		}
+	}
+
+	static void UpdateAll()
+	{
+		TRACE_SCOPE("ShaderToyBuffer::UpdateAll");
+		std::map<std::string,ShaderToyBuffer*>& m = GetMap();
+		for (auto it = m.begin(); it != m.end(); ++it)
+			it->second->Update();
+	}
+
+	// queues a non-blocking readback of one layer (or slice) and mip - see QueueCapture. the GPU isn't waited on, the
+	// readback completes in a later frame (see ReadbackQueue::Poll in RenderAll) and the file is written by a worker
+	bool Capture(uint32 layer, uint32 mipIndex, const char* path) const
+	{
+		const uint32 numLayersOrSlices = m_desc.m_resolutionZ > 1 ? Max(1U, m_res[2] >> mipIndex) : m_desc.m_numLayers*(m_desc.m_isCubemap ? 6 : 1);
+		if (TextureFormatInfo(m_desc.m_format).m_compressed || mipIndex >= m_mipLevels || layer >= numLayersOrSlices) {
+			fprintf(stderr, "can't capture buffer \"%s\" layer %u mip %u\n", m_desc.m_name.c_str(), layer, mipIndex);
+			return false;
+		}
+		static GLuint readFramebufferID = 0;
+		if (readFramebufferID == 0)
+			glGenFramebuffers(1, &readFramebufferID);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, readFramebufferID);
+		if (m_target == GL_TEXTURE_2D)
+			glFramebufferTexture(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GetTextureID(), mipIndex);
+		else
+			glFramebufferTextureLayer(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GetTextureID(), mipIndex, layer);
+		glReadBuffer(GL_COLOR_ATTACHMENT0);
+	#if SUPPORT_IMAGES
+		glMemoryBarrier(GL_FRAMEBUFFER_BARRIER_BIT | GL_PIXEL_BUFFER_BARRIER_BIT); // the buffer may have been written with imageStore
+	#endif // SUPPORT_IMAGES
+		QueueCapture(path, Max(1U, m_res[0] >> mipIndex), Max(1U, m_res[1] >> mipIndex), m_desc.m_format);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, g_DefaultFramebufferID); // restore
+		return true;
+	}
+
+	void GenerateMips(GLuint textureID) const // from mip 0, see Desc::m_autoMips
+	{
+		if (m_mipLevels > 1) {
+			glBindTexture(m_target, textureID);
+			glGenerateMipmap(m_target);
+			glBindTexture(m_target, 0); // restore
+		}
+	}
+
+	static std::map<std::string,ShaderToyBuffer*>& GetMap()
+	{
+		static std::map<std::string,ShaderToyBuffer*> m;
+		return m;
+	}
+
+	static ShaderToyBuffer* Find(const char* name)
+	{
+		std::map<std::string,ShaderToyBuffer*>& m = GetMap();
+		const auto f = m.find(name);
+		if (f != m.end())
+			return f->second;
+		else
+			return nullptr;
+	}
+
+	GLuint GetTextureID() const { return m_aliasOf ? m_aliasOf->GetTextureID() : m_textureIDs[m_front]; } // what readers see
+	GLuint GetBackTextureID() const { return m_textureIDs[m_front^1]; } // what a pass which also reads this buffer renders to
+
+	void SetDoubleBuffered()
+	{
+		if (!m_doubleBuffered) {
+			m_doubleBuffered = true;
+			Update(); // allocates the back texture
+		}
+	}
+
+	void Swap()
+	{
+		if (m_doubleBuffered)
+			m_front ^= 1;
+	}
+
+	// releases this buffer's texture and shares the owner's instead (owner must have a storage compatible desc)
+	void AliasTo(ShaderToyBuffer* owner)
+	{
+		ForceAssert(owner != this && owner->m_aliasOf == nullptr && !m_doubleBuffered && !owner->m_doubleBuffered);
+		ForceAssert(m_desc.IsStorageCompatible(owner->m_desc));
+		if (m_textureIDs[0]) {
+			glDeleteTextures(1, &m_textureIDs[0]);
+			m_textureIDs[0] = 0;
+		}
+		m_aliasOf = owner;
+		CopyStorageInfo(owner);
+	}
+
+	void CopyStorageInfo(const ShaderToyBuffer* owner)
+	{
+		m_res[0] = owner->m_res[0];
+		m_res[1] = owner->m_res[1];
+		m_res[2] = owner->m_res[2];
+		m_mipLevels = owner->m_mipLevels;
+		m_target = owner->m_target;
+	}
+
+	uint64 GetTextureSizeInBytes() const // size of one texture with the current resolution, including mips
+	{
+		const uint32 bs = GetDX10FormatBlockSize(m_desc.m_format);
+		const uint32 blockSizeInBytes = (GetDX10FormatBitsPerPixel(m_desc.m_format)*bs*bs)/8;
+		uint64 size = 0;
+		for (uint32 mipIndex = 0; mipIndex < m_mipLevels; mipIndex++) {
+			const uint32 mw = Max(1U, m_res[0] >> mipIndex);
+			const uint32 mh = Max(1U, m_res[1] >> mipIndex);
+			const uint32 md = Max(1U, m_res[2] >> mipIndex);
+			const uint32 numLayersOrSlices = m_desc.m_resolutionZ > 1 ? md : m_desc.m_numLayers*(m_desc.m_isCubemap ? 6 : 1);
+			size += (uint64)((mw + bs - 1)/bs)*(uint64)((mh + bs - 1)/bs)*numLayersOrSlices*blockSizeInBytes;
+		}
+		return size;
+	}
+
+	uint64 GetAllocatedSizeInBytes() const { return m_aliasOf ? 0 : GetTextureSizeInBytes()*(m_doubleBuffered ? 2 : 1); }
+
+	Desc m_desc;
+	uint32 m_res[3];
+	uint32 m_mipLevels; // actual mip levels
+	GLuint m_textureIDs[2]; // front/back, [1] only exists if m_doubleBuffered
+	uint32 m_front;
+	bool m_doubleBuffered; // set when a pass reads and writes this buffer, so it never samples its own render target
+	ShaderToyBuffer* m_aliasOf; // if set, this buffer has no texture of its own (see ShaderToyRenderPass::AliasTransientBuffers)
+	GLenum m_target;
+	std::shared_ptr<PendingLoad> m_pendingLoad; // image still being decoded, the texture is a placeholder until then
+};
+
+// std140 layouts - must match the uniform blocks in shaders_common/shadertoy_common.glsl
+class ShaderToyFrameUniforms
+{
+public:
+	float iResolution[3];
+	float iTime;
+	float iMouse[4];
+	float iDate[4];
+	float iTimeDelta;
+	int iFrame;
+	float iFrameRate;
+	float iSampleRate;
+	float iChannelTime[SHADERTOY_MAX_INPUT_CHANNELS][4]; // std140 array stride is 16 bytes, only [0] is used
+	int iResetFrame;
+};
+
+class ShaderToyPassUniforms
+{
+public:
+	float iOutputResolution[4];
+	float iChannelResolution[SHADERTOY_MAX_INPUT_CHANNELS][4];
+};
+
+StaticAssert(sizeof(ShaderToyFrameUniforms) == 64 + SHADERTOY_MAX_INPUT_CHANNELS*16 + 4);
+StaticAssert(sizeof(ShaderToyPassUniforms) == 16 + SHADERTOY_MAX_INPUT_CHANNELS*16);
+
+// one persistently mapped buffer holding NUM_FRAMES regions, each region is the frame block followed by one block per pass.
+// the region for frame N is not rewritten until the fence from frame N - NUM_FRAMES has signalled
+class ShaderToyUniformBuffer
+{
+public:
+	enum { NUM_FRAMES = 3 };
+
+	static void BeginFrame(uint32 numPassSlots)
+	{
+		State& st = Get();
+		if (st.m_bufferID == 0 || numPassSlots > st.m_numPassSlots) {
+			Release();
+			GLint align = 256;
+			glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &align);
+			st.m_frameBlockSize = AlignUp((uint32)sizeof(ShaderToyFrameUniforms), (uint32)align);
+			st.m_passBlockSize = AlignUp((uint32)sizeof(ShaderToyPassUniforms), (uint32)align);
+			st.m_numPassSlots = Max(numPassSlots, 1U);
+			st.m_regionSize = st.m_frameBlockSize + st.m_numPassSlots*st.m_passBlockSize;
+			const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+			glGenBuffers(1, &st.m_bufferID);
+			glBindBuffer(GL_UNIFORM_BUFFER, st.m_bufferID);
+			glBufferStorage(GL_UNIFORM_BUFFER, NUM_FRAMES*st.m_regionSize, nullptr, flags);
+			st.m_mapped = (uint8*)glMapBufferRange(GL_UNIFORM_BUFFER, 0, NUM_FRAMES*st.m_regionSize, flags);
+			glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		}
+		st.m_region = (st.m_region + 1)%NUM_FRAMES;
+		GLsync& fence = st.m_fences[st.m_region];
+		if (fence) {
+			while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED) {}
+			glDeleteSync(fence);
+			fence = nullptr;
+		}
+
+		ShaderToyFrameUniforms frame;
+		memset(&frame, 0, sizeof(frame));
+		const float mouseScaleX = (float)GetRenderWidth()/(float)g_ViewportWidth; // mouse is in window pixels
+		const float mouseScaleY = (float)GetRenderHeight()/(float)g_ViewportHeight;
+		frame.iResolution[0] = (float)GetRenderWidth();
+		frame.iResolution[1] = (float)GetRenderHeight();
+		frame.iResolution[2] = 1.0f; // pixel aspect
+		frame.iTime = g_Time;
+		frame.iMouse[0] = mouseScaleX*(float)g_MouseDragCurr[0];
+		frame.iMouse[1] = mouseScaleY*(float)g_MouseDragCurr[1];
+		frame.iMouse[2] = mouseScaleX*(float)g_MouseDragStart[0];
+		frame.iMouse[3] = mouseScaleY*(float)g_MouseDragStart[1];
+		const time_t now = time(nullptr);
+		const struct tm* date = localtime(&now);
+		if (date) {
+			frame.iDate[0] = (float)(date->tm_year + 1900);
+			frame.iDate[1] = (float)date->tm_mon; // [0..11] like ShaderToy
+			frame.iDate[2] = (float)date->tm_mday;
+			frame.iDate[3] = (float)(date->tm_hour*3600 + date->tm_min*60 + date->tm_sec);
+		}
+		frame.iTimeDelta = g_TimeDelta;
+		frame.iFrame = (int)g_Frame;
+		frame.iFrameRate = 60.0f; // whatev.
+		frame.iSampleRate = 44100.0f;
+		frame.iResetFrame = (int)g_ResetFrame;
+		const uint32 offset = st.m_region*st.m_regionSize;
+		memcpy(st.m_mapped + offset, &frame, sizeof(frame));
+		glBindBufferRange(GL_UNIFORM_BUFFER, SHADERTOY_FRAME_UNIFORMS_BINDING, st.m_bufferID, offset, sizeof(frame));
+	}
+
+	static void SetPass(uint32 passSlot, const ShaderToyPassUniforms& pass)
+	{
+		State& st = Get();
+		ForceAssert(passSlot < st.m_numPassSlots);
+		const uint32 offset = st.m_region*st.m_regionSize + st.m_frameBlockSize + passSlot*st.m_passBlockSize;
+		memcpy(st.m_mapped + offset, &pass, sizeof(pass));
+		glBindBufferRange(GL_UNIFORM_BUFFER, SHADERTOY_PASS_UNIFORMS_BINDING, st.m_bufferID, offset, sizeof(pass));
+	}
+
+	static void EndFrame()
+	{
+		State& st = Get();
+		st.m_fences[st.m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+
+	static void Release()
+	{
+		State& st = Get();
+		for (uint32 i = 0; i < NUM_FRAMES; i++) {
+			if (st.m_fences[i]) {
+				glClientWaitSync(st.m_fences[i], GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+				glDeleteSync(st.m_fences[i]);
+				st.m_fences[i] = nullptr;
+			}
+		}
+		if (st.m_bufferID) {
+			glBindBuffer(GL_UNIFORM_BUFFER, st.m_bufferID);
+			glUnmapBuffer(GL_UNIFORM_BUFFER);
+			glBindBuffer(GL_UNIFORM_BUFFER, 0);
+			glDeleteBuffers(1, &st.m_bufferID);
+			st.m_bufferID = 0;
+			st.m_mapped = nullptr;
+		}
+	}
+
+private:
+	class State
+	{
+	public:
+		State() : m_bufferID(0), m_mapped(nullptr), m_frameBlockSize(0), m_passBlockSize(0), m_numPassSlots(0), m_regionSize(0), m_region(0) { memset(m_fences, 0, sizeof(m_fences)); }
+		GLuint m_bufferID;
+		uint8* m_mapped;
+		uint32 m_frameBlockSize;
+		uint32 m_passBlockSize;
+		uint32 m_numPassSlots;
+		uint32 m_regionSize;
+		uint32 m_region;
+		GLsync m_fences[NUM_FRAMES];
+	};
+
+	static uint32 AlignUp(uint32 x, uint32 align) { return ((x + align - 1)/align)*align; }
+
+	static State& Get()
+	{
+		static State st;
+		return st;
+	}
+};
+
+// GPU time between Begin and End, read back a few frames later so it never stalls the CPU. uses timestamp pairs
+// rather than GL_TIME_ELAPSED, so timers can nest. each measurement carries a tag (e.g. the amount of work done)
+class GPUTimer
+{
+public:
+	enum { NUM_QUERIES = 4 }; // measurements in flight, Begin skips measuring if they're all still pending
+
+	GPUTimer() : m_next(0), m_pending(0), m_measuring(false), m_lastMs(0.0f), m_lastTag(0), m_numResults(0), m_lastBeginNs(0), m_lastEndNs(0), m_statisticTarget(GL_NONE), m_lastCount(0)
+	{
+		memset(m_queryIDs, 0, sizeof(m_queryIDs));
+		memset(m_statisticQueryIDs, 0, sizeof(m_statisticQueryIDs));
+		memset(m_tags, 0, sizeof(m_tags));
+	}
+
+	// statisticTarget is e.g. GL_FRAGMENT_SHADER_INVOCATIONS_ARB - must be the same every time, and only one timer
+	// can count a given statistic at once (timestamps nest, statistics queries don't)
+	void Begin(uint32 tag = 0, GLenum statisticTarget = GL_NONE)
+	{
+		if (m_queryIDs[0][0] == 0)
+			glGenQueries(2*NUM_QUERIES, &m_queryIDs[0][0]);
+		if (statisticTarget != GL_NONE && m_statisticQueryIDs[0] == 0) {
+			glGenQueries(NUM_QUERIES, m_statisticQueryIDs);
+			m_statisticTarget = statisticTarget;
+		}
+		Poll();
+		m_measuring = m_pending < NUM_QUERIES;
+		if (m_measuring) {
+			m_tags[m_next] = tag;
+			glQueryCounter(m_queryIDs[m_next][0], GL_TIMESTAMP);
+			if (m_statisticTarget != GL_NONE)
+				glBeginQuery(m_statisticTarget, m_statisticQueryIDs[m_next]);
+		}
+	}
+
+	void End()
+	{
+		if (m_measuring) {
+			if (m_statisticTarget != GL_NONE)
+				glEndQuery(m_statisticTarget);
+			glQueryCounter(m_queryIDs[m_next][1], GL_TIMESTAMP);
+			m_next = (m_next + 1)%NUM_QUERIES;
+			m_pending++;
+			m_measuring = false;
+		}
+	}
+
+	bool Poll() // true if a new measurement arrived
+	{
+		bool updated = false;
+		while (m_pending > 0) {
+			const uint32 oldest = (m_next + NUM_QUERIES - m_pending)%NUM_QUERIES;
+			GLint available = 0;
+			glGetQueryObjectiv(m_queryIDs[oldest][1], GL_QUERY_RESULT_AVAILABLE, &available);
+			if (!available)
+				break;
+			GLuint64 t0 = 0;
+			GLuint64 t1 = 0;
+			glGetQueryObjectui64v(m_queryIDs[oldest][0], GL_QUERY_RESULT, &t0);
+			glGetQueryObjectui64v(m_queryIDs[oldest][1], GL_QUERY_RESULT, &t1);
+			m_lastMs = (float)(t1 - t0)/1000000.0f;
+			m_lastBeginNs = t0;
+			m_lastEndNs = t1;
+			m_lastTag = m_tags[oldest];
+			if (m_statisticTarget != GL_NONE)
+				glGetQueryObjectui64v(m_statisticQueryIDs[oldest], GL_QUERY_RESULT, &m_lastCount); // ended before the timestamp, so it's available too
+			m_numResults++;
+			m_pending--;
+			updated = true;
+		}
+		return updated;
+	}
+
+	float GetLastMs() const { return m_lastMs; }
+	uint32 GetLastTag() const { return m_lastTag; }
+	uint32 GetNumResults() const { return m_numResults; }
+	uint64 GetLastCount() const { return m_lastCount; }
+	uint64 GetLastBeginNs() const { return m_lastBeginNs; } // GL_TIMESTAMP clock
+	uint64 GetLastEndNs() const { return m_lastEndNs; }
+
+private:
+	GLuint m_queryIDs[NUM_QUERIES][2]; // begin/end timestamps
+	GLuint m_statisticQueryIDs[NUM_QUERIES];
+	uint32 m_tags[NUM_QUERIES];
+	uint32 m_next;
+	uint32 m_pending;
+	bool m_measuring;
+	float m_lastMs;
+	uint32 m_lastTag;
+	uint32 m_numResults;
+	GLuint64 m_lastBeginNs;
+	GLuint64 m_lastEndNs;
+	GLenum m_statisticTarget;
+	GLuint64 m_lastCount;
+};
+
+// average/min/max over the last NUM_SAMPLES values, for the -profile overlay
+class RollingStats
+{
+public:
+	enum { NUM_SAMPLES = 120 };
+
+	RollingStats() : m_next(0), m_numSamples(0) {}
+
+	void Add(double value)
+	{
+		m_samples[m_next] = value;
+		m_next = (m_next + 1)%NUM_SAMPLES;
+		m_numSamples = Min(m_numSamples + 1, (uint32)NUM_SAMPLES);
+	}
+
+	uint32 GetNumSamples() const { return m_numSamples; }
+
+	double GetAverage() const
+	{
+		double sum = 0.0;
+		for (uint32 i = 0; i < m_numSamples; i++)
+			sum += m_samples[i];
+		return m_numSamples > 0 ? sum/(double)m_numSamples : 0.0;
+	}
+
+	double GetMin() const
+	{
+		double result = m_numSamples > 0 ? m_samples[0] : 0.0;
+		for (uint32 i = 1; i < m_numSamples; i++)
+			result = Min(m_samples[i], result);
+		return result;
+	}
+
+	double GetMax() const
+	{
+		double result = m_numSamples > 0 ? m_samples[0] : 0.0;
+		for (uint32 i = 1; i < m_numSamples; i++)
+			result = Max(m_samples[i], result);
+		return result;
+	}
+
+private:
+	double m_samples[NUM_SAMPLES];
+	uint32 m_next;
+	uint32 m_numSamples;
+};
+
+// fixed-width text drawn over the final image with font\console_raster_6x8.png (16 glyphs per row from ' ' on the second row,
+// 12x16 pixel cells with the 6x8 glyph at offset 7,6). works in core and compatibility profiles
+class TextOverlay
+{
+public:
+	enum { GLYPH_W = 6, GLYPH_H = 8, SCALE = 2 };
+
+	static void Print(uint32 column, uint32 row, const char* text)
+	{
+		std::vector<float>& vertices = GetVertices();
+		for (uint32 i = 0; text[i]; i++) {
+			const uint32 c = (uint8)text[i];
+			if (c <= ' ' || c >= 0x7f) // nothing to draw, but spaces still get the background from the shader below
+				continue;
+			const float x0 = (float)((column + i)*GLYPH_W*SCALE);
+			const float y0 = (float)(row*GLYPH_H*SCALE);
+			const float u0 = (float)(7 + 12*(c%16));
+			const float v0 = (float)(6 + 16*(c/16 - 1));
+			const float quad[6][4] = {
+				{x0,                  y0,                  u0,           v0          },
+				{x0 + GLYPH_W*SCALE, y0,                  u0 + GLYPH_W, v0          },
+				{x0 + GLYPH_W*SCALE, y0 + GLYPH_H*SCALE, u0 + GLYPH_W, v0 + GLYPH_H},
+				{x0,                  y0,                  u0,           v0          },
+				{x0 + GLYPH_W*SCALE, y0 + GLYPH_H*SCALE, u0 + GLYPH_W, v0 + GLYPH_H},
+				{x0,                  y0 + GLYPH_H*SCALE, u0,           v0 + GLYPH_H},
+			};
+			vertices.insert(vertices.end(), &quad[0][0], &quad[0][0] + sizeof(quad)/sizeof(float));
+		}
+	}
+
+	// draws a dark background behind the given rows, then the text printed since the last call
+	static void Render(uint32 viewportWidth, uint32 viewportHeight, uint32 numColumns, uint32 numRows)
+	{
+		std::vector<float>& vertices = GetVertices();
+		static GLuint programID = 0;
+		static GLuint textureID = 0;
+		static GLuint vertexArrayID = 0;
+		static GLuint vertexBufferID = 0;
+		static GLint viewportSizeLocation = -1;
+		static bool failed = false;
+		if (programID == 0 && !failed) {
+			failed = !Init(programID, textureID);
+			if (!failed) {
+				viewportSizeLocation = glGetUniformLocation(programID, "viewportSize");
+				glGenVertexArrays(1, &vertexArrayID);
+				glGenBuffers(1, &vertexBufferID);
+				glBindVertexArray(vertexArrayID);
+				glBindBuffer(GL_ARRAY_BUFFER, vertexBufferID);
+				glEnableVertexAttribArray(0);
+				glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4*sizeof(float), nullptr);
+				glBindVertexArray(0);
+				glBindBuffer(GL_ARRAY_BUFFER, 0);
+			}
+		}
+		if (failed) {
+			vertices.clear();
+			return;
+		}
+		const float w = (float)(numColumns*GLYPH_W*SCALE);
+		const float h = (float)(numRows*GLYPH_H*SCALE);
+		const float background[6][4] = { // v=-1 is a texel outside the font, see the fragment shader
+			{0.0f, 0.0f, 0.0f, -1.0f}, {w, 0.0f, 0.0f, -1.0f}, {w, h, 0.0f, -1.0f},
+			{0.0f, 0.0f, 0.0f, -1.0f}, {w, h, 0.0f, -1.0f}, {0.0f, h, 0.0f, -1.0f},
+		};
+		vertices.insert(vertices.begin(), &background[0][0], &background[0][0] + sizeof(background)/sizeof(float));
+		glBindFramebuffer(GL_FRAMEBUFFER, g_DefaultFramebufferID);
+		glViewport(0, 0, viewportWidth, viewportHeight);
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		glUseProgram(programID);
+		glUniform2f(viewportSizeLocation, (float)viewportWidth, (float)viewportHeight);
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, textureID);
+		glBindVertexArray(vertexArrayID);
+		glBindBuffer(GL_ARRAY_BUFFER, vertexBufferID);
+		glBufferData(GL_ARRAY_BUFFER, vertices.size()*sizeof(float), vertices.data(), GL_STREAM_DRAW);
+		glDrawArrays(GL_TRIANGLES, 0, (GLsizei)(vertices.size()/4));
+		glBindBuffer(GL_ARRAY_BUFFER, 0); // restore
+		glBindVertexArray(0); // restore
+		glBindTexture(GL_TEXTURE_2D, 0); // restore
+		glUseProgram(0); // restore
+		glDisable(GL_BLEND); // restore
+		vertices.clear();
+	}
+
+private:
+	static std::vector<float>& GetVertices() // x,y in pixels from the top left, u,v in font texels
+	{
+		static std::vector<float> vertices;
+		return vertices;
+	}
+
+	static bool Init(GLuint& programID, GLuint& textureID)
+	{
+		const char* fontPath = "font/console_raster_6x8.png";
+		int w = 0;
+		int h = 0;
+		Vec4V* image = FileExists(fontPath) ? LoadImage_Vec4V(fontPath, w, h) : nullptr;
+		if (image == nullptr) {
+			fprintf(stderr, "failed to load %s, text overlay disabled\n", fontPath);
+			return false;
+		}
+		std::vector<uint8> pixels(w*h);
+		for (int i = 0; i < w*h; i++)
+			pixels[i] = image[i].xf() > 0.5f ? 255 : 0;
+		delete[] image;
+		glGenTextures(1, &textureID);
+		glBindTexture(GL_TEXTURE_2D, textureID);
+		glTexStorage2D(GL_TEXTURE_2D, 1, GL_R8, w, h);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, w, h, GL_RED, GL_UNSIGNED_BYTE, pixels.data());
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4); // restore
+		glBindTexture(GL_TEXTURE_2D, 0);
+
+		const char* vsCode =
+			"#version 440\n"
+			"layout(location = 0) in vec4 vertex;\n"
+			"uniform vec2 viewportSize;\n"
+			"out vec2 texel;\n"
+			"void main() {\n"
+			"	texel = vertex.zw;\n"
+			"	gl_Position = vec4(2.0*vertex.x/viewportSize.x - 1.0, 1.0 - 2.0*vertex.y/viewportSize.y, 0.0, 1.0);\n"
+			"}\n";
+		const char* fsCode =
+			"#version 440\n"
+			"uniform sampler2D font;\n"
+			"in vec2 texel;\n"
+			"out vec4 color;\n"
+			"void main() {\n"
+			"	float a = texel.y >= 0.0 ? texelFetch(font, ivec2(floor(texel)), 0).r : 0.0;\n"
+			"	color = vec4(a, a, a, texel.y >= 0.0 ? a : 0.6);\n"
+			"}\n";
+		const char* codes[2] = {vsCode, fsCode};
+		const GLenum targets[2] = {GL_VERTEX_SHADER, GL_FRAGMENT_SHADER};
+		programID = glCreateProgram();
+		for (uint32 i = 0; i < 2; i++) {
+			const GLuint shaderID = glCreateShader(targets[i]);
+			glShaderSource(shaderID, 1, &codes[i], nullptr);
+			glCompileShader(shaderID);
+			GLint status = 0;
+			glGetShaderiv(shaderID, GL_COMPILE_STATUS, &status);
+			if (status != GL_TRUE) {
+				char infoLog[1024] = "";
+				glGetShaderInfoLog(shaderID, sizeof(infoLog), nullptr, infoLog);
+				fprintf(stderr, "text overlay shader failed to compile: %s\n", infoLog);
+				return false;
+			}
+			glAttachShader(programID, shaderID);
+			glDeleteShader(shaderID); // deleted with the program
+		}
+		glLinkProgram(programID);
+		GLint status = 0;
+		glGetProgramiv(programID, GL_LINK_STATUS, &status);
+		if (status != GL_TRUE) {
+			fprintf(stderr, "text overlay program failed to link\n");
+			return false;
+		}
+		return true;
+	}
+};
+
+// -dynres=ms: steps g_RenderScale down while the GPU frame time is over budget, and back up once the predicted time at
+// the next step fits with some headroom. steps are coarse and need a run of frames to agree, so buffers aren't
+// reallocated every frame - and results measured at another scale (GPUTimer tags) are ignored
+class DynamicResolution
+{
+public:
+	enum
+	{
+		MIN_SAMPLES = 4, // after a step, before deciding anything
+		DOWN_FRAMES = 8, // over budget this many frames in a row to step down
+		UP_FRAMES = 60, // slower to step up, so a brief dip doesn't reallocate twice
+	};
+
+	DynamicResolution() : m_budgetMs(0.0f), m_minScale(0.5f), m_step(0.1f), m_level(0), m_ms(0.0f), m_numSamples(0), m_overFrames(0), m_underFrames(0) {}
+
+	bool IsEnabled() const { return m_budgetMs > 0.0f; }
+	float GetMs() const { return m_ms; }
+	float GetBudgetMs() const { return m_budgetMs; }
+
+	void SetBudget(float budgetMs, float minScale)
+	{
+		m_budgetMs = budgetMs;
+		m_minScale = Clamp(minScale, 0.1f, 1.0f);
+	}
+
+	void Update() // before the frame, results are a few frames old
+	{
+		if (!IsEnabled() || !m_timer.Poll() || m_timer.GetLastTag() != m_level)
+			return;
+		const float ms = m_timer.GetLastMs();
+		m_ms = m_numSamples == 0 ? ms : m_ms + (ms - m_ms)*0.25f;
+		if (++m_numSamples < MIN_SAMPLES)
+			return;
+		const float upRatio = m_level > 0 ? GetScale(m_level - 1)/GetScale(m_level) : 0.0f;
+		if (m_ms > m_budgetMs) {
+			m_underFrames = 0;
+			if (++m_overFrames >= DOWN_FRAMES && GetScale(m_level + 1) >= m_minScale - 0.001f)
+				SetLevel(m_level + 1);
+		} else if (m_level > 0 && m_ms*upRatio*upRatio < 0.85f*m_budgetMs) { // pixel count goes with the square
+			m_overFrames = 0;
+			if (++m_underFrames >= UP_FRAMES)
+				SetLevel(m_level - 1);
+		} else {
+			m_overFrames = 0;
+			m_underFrames = 0;
+		}
+	}
+
+	void BeginFrame() { if (IsEnabled()) m_timer.Begin(m_level); }
+	void EndFrame() { if (IsEnabled()) m_timer.End(); }
+
+private:
+	float GetScale(uint32 level) const { return 1.0f - m_step*(float)level; }
+
+	void SetLevel(uint32 level)
+	{
+		m_level = level;
+		m_numSamples = 0;
+		m_overFrames = 0;
+		m_underFrames = 0;
+		g_RenderScale = GetScale(level);
+		g_ResetFrame = g_Frame; // relative-sized buffers are reallocated with undefined contents, accumulating shaders restart on iResetFrame
+		printf("render scale %.2f (%ux%u), gpu %.2f ms, budget %.2f ms\n", g_RenderScale, GetRenderWidth(), GetRenderHeight(), m_ms, m_budgetMs);
+	}
+
+	float m_budgetMs; // 0=disabled
+	float m_minScale;
+	float m_step;
+	uint32 m_level; // scale is 1 - level*step
+	float m_ms; // smoothed gpu frame time at the current level
+	uint32 m_numSamples;
+	uint32 m_overFrames;
+	uint32 m_underFrames;
+	GPUTimer m_timer;
+};
+
+static DynamicResolution g_DynamicResolution;
+
+class ShaderToyRenderPass
+{
+public:
+	enum
+	{
+		MAX_INPUTS = SHADERTOY_MAX_INPUT_CHANNELS,
+		MAX_IMAGES = 8,
+		MAX_PASSES = 256,
+	};
+
+	class PassInput
+	{
+	public:
+		PassInput() : m_buffer(nullptr) {}
+		ShaderToyBuffer* m_buffer;
+	};
+
+	class PassOutput
+	{
+	public:
+		PassOutput() : m_buffer(nullptr), m_layerOrSliceIndex(0), m_mipIndex(0), m_pingPong(false) {}
+		ShaderToyBuffer* m_buffer;
+		uint32 m_layerOrSliceIndex;
+		uint32 m_mipIndex;
+		bool m_pingPong; // render to the buffer's back texture and swap afterwards, see SetupPingPongBuffers
+	};
+
+#if SUPPORT_IMAGES
+	class PassImage
+	{
+	public:
+		PassImage() : m_buffer(nullptr), m_layered(false), m_layerOrSliceIndex(0), m_mipIndex(0), m_access(GL_NONE), m_internalFormat(GL_NONE) {}
+		std::string m_name;
+		ShaderToyBuffer* m_buffer;
+		bool m_layered; // if true, ignore m_layerOrSliceIndex and bind the entire mip level as an array or 3D
+		uint32 m_layerOrSliceIndex;
+		uint32 m_mipIndex;
+		GLenum m_access;
+		GLenum m_internalFormat;
+	};
+#endif // SUPPORT_IMAGES
+
+	// cached locations for the samplers and sliders, built once after the program links (built-in uniforms are in ShaderToyUniformBuffer)
+	class PassUniforms
+	{
+	public:
+		void Init(uint32 passIndex, GLuint programID)
+		{
+			for (uint32 i = 0; i < MAX_INPUTS; i++)
+				m_iChannel[i].Init(programID, varString("iChannel%u", i));
+			m_iPass.Init(programID, "iPass");
+			m_iPassCount.Init(programID, "iPassCount");
+			m_iSample.Init(programID, "iSample");
+			m_iPrevSampleFrame.Init(programID, "iPrevSampleFrame");
+		#if USE_GUI
+			GUISlider::InitUniformsForPass(passIndex, programID, m_sliders, m_sliderChanged);
+		#endif // USE_GUI
+		}
+
+		ProgramUniform m_iChannel[MAX_INPUTS];
+		ProgramUniform m_iPass; // plain uniforms rather than ShaderToyPassUniforms, they change between iterations
+		ProgramUniform m_iPassCount;
+		ProgramUniform m_iSample;
+		ProgramUniform m_iPrevSampleFrame;
+	#if USE_GUI
+		std::vector<ProgramUniform> m_sliders; // indexed by slider
+		ProgramUniform m_sliderChanged;
+	#endif // USE_GUI
+	};
+
+	// one buffer access by a pass, used to build the dependency graph
+	class PassAccess
+	{
+	public:
+		enum eType
+		{
+			ACCESS_TEXTURE,     // $INPUT, sampled
+			ACCESS_IMAGE_READ,  // $IMAGE with read access
+			ACCESS_IMAGE_WRITE, // $IMAGE with write access (incoherent - needs a barrier before anything else sees it)
+			ACCESS_FRAMEBUFFER, // $OUTPUT
+		};
+
+		PassAccess(const ShaderToyBuffer* buffer, eType type) : m_buffer(buffer), m_type(type) {}
+
+		bool IsWrite() const { return m_type == ACCESS_IMAGE_WRITE || m_type == ACCESS_FRAMEBUFFER; }
+
+		GLbitfield GetBarrierBit() const // barrier needed before this access can see earlier image writes
+		{
+			switch (m_type) {
+			case ACCESS_TEXTURE:     return GL_TEXTURE_FETCH_BARRIER_BIT;
+			case ACCESS_IMAGE_READ:  return GL_SHADER_IMAGE_ACCESS_BARRIER_BIT;
+			case ACCESS_IMAGE_WRITE: return GL_SHADER_IMAGE_ACCESS_BARRIER_BIT;
+			case ACCESS_FRAMEBUFFER: return GL_FRAMEBUFFER_BARRIER_BIT;
+			}
+			return 0;
+		}
+
+		const char* GetTypeStr() const
+		{
+			switch (m_type) {
+			case ACCESS_TEXTURE:     return "texture";
+			case ACCESS_IMAGE_READ:  return "image";
+			case ACCESS_IMAGE_WRITE: return "image";
+			case ACCESS_FRAMEBUFFER: return "framebuffer";
+			}
+			return "?";
+		}
+
+		const ShaderToyBuffer* m_buffer;
+		eType m_type;
+	};
+
+	ShaderToyRenderPass(uint32 passIndex, GLuint programID)
+		: m_passIndex(passIndex)
+		, m_programID(programID)
+		, m_memoryBarrierBits(0)
+		, m_isCompute(false)
+		, m_dispatchBuffer(nullptr)
+		, m_iterations(1)
+		, m_minIterations(1)
+		, m_maxIterations(1)
+		, m_iterationBudgetMs(0.0f)
+		, m_msPerIteration(0.0f)
+		, m_iterationBarrierBits(0)
+		, m_numSamples(0)
+		, m_sampleFrame(-1)
+		, m_prevSampleFrame(-1)
+		, m_sampleInProgress(false)
+		, m_timeSliceMs(0.0f)
+		, m_nextTile(0)
+		, m_msPerTile(0.0f)
+		, m_profileSamples(0)
+	{
+		m_outputFramebufferIDs[0] = 0;
+		m_outputFramebufferIDs[1] = 0;
+		for (uint32 i = 0; i < 3; i++) {
+			m_localSize[i] = 1;
+			m_dispatchSize[i] = 1;
+		}
+		for (uint32 i = 0; i < 2; i++) {
+			m_tiles[i] = 1;
+			m_tileRes[i] = 0;
+		}
+	}
+
+	const char* GetFileName() const
+	{
+		return GetPathFileName(m_path.c_str());
+	}
+
+	void GetAccesses(std::vector<PassAccess>& accesses) const
+	{
+		for (uint32 i = 0; i < m_inputs.size(); i++)
+			if (m_inputs[i].m_buffer)
+				accesses.push_back(PassAccess(m_inputs[i].m_buffer, PassAccess::ACCESS_TEXTURE));
+	#if SUPPORT_IMAGES
+		for (uint32 i = 0; i < m_images.size(); i++) {
+			const PassImage& image = m_images[i];
+			if (image.m_buffer) {
+				if (image.m_access == GL_READ_ONLY || image.m_access == GL_READ_WRITE)
+					accesses.push_back(PassAccess(image.m_buffer, PassAccess::ACCESS_IMAGE_READ));
+				if (image.m_access == GL_WRITE_ONLY || image.m_access == GL_READ_WRITE)
+					accesses.push_back(PassAccess(image.m_buffer, PassAccess::ACCESS_IMAGE_WRITE));
+			}
+		}
+	#endif // SUPPORT_IMAGES
+		for (uint32 i = 0; i < m_outputs.size(); i++)
+			if (m_outputs[i].m_buffer)
+				accesses.push_back(PassAccess(m_outputs[i].m_buffer, PassAccess::ACCESS_FRAMEBUFFER));
+	}
+
+	void AddBuffer(char* s)
+	{
+		SkipLeadingWhitespace(s);
+		if (*s++ == ':') {
+			char* trailingComment = strstr(s, "//");
+			if (trailingComment)
+				*trailingComment = '\0';
+			const NameValuePairs nvp(s);
+			const char* name = GetName(&nvp);
+			if (name)
+				ShaderToyBuffer::Add(m_passIndex, name, &nvp);
+			else
+				printf("error: pass %u buffer description expected to start with name!\n", m_passIndex);
+		} else
+			printf("error: pass %u buffer not processed, missing ':'!\n", m_passIndex);
+	}
+
+	void AddInput(char* s)
+	{
+		// for ShaderToy support, we need to allow for specified input indices (maybe .. i dunno .. don't want to think about it too much)
+		// for sanity's sake, please declare inputs with specified indices FIRST, before any inputs with unspecified indices
+		const bool allowSpecificInputIndex = true;
+		uint32 inputIndex = 0;
+		if (allowSpecificInputIndex) {
+			if (isdigit(*s)) {
+				inputIndex = (uint32)atoi(s);
+				while (isdigit(*s))
+					s++;
+				if (inputIndex >= m_inputs.size())
+					m_inputs.resize(inputIndex + 1);
+				else if (m_inputs[inputIndex].m_buffer) {
+					printf("error: pass %u input specified index %u, but this input is already bound to a buffer!\n", m_passIndex, inputIndex);
+					return;
+				}
+			} else { // unspecified input index - find the first one available
+				inputIndex = (uint32)m_inputs.size();
+				for (uint32 i = 0; i < m_inputs.size(); i++) {
+					if (m_inputs[i].m_buffer == nullptr) {
+						inputIndex = i;
+						break;
+					}
+				}
+				if (inputIndex == m_inputs.size())
+					m_inputs.resize(inputIndex + 1);
+			}
+		} else {
+			while (isdigit(*s))
+				s++;
+		}
+		SkipLeadingWhitespace(s);
+		if (*s++ == ':') {
+			char* trailingComment = strstr(s, "//");
+			if (trailingComment)
+				*trailingComment = '\0';
+			const NameValuePairs nvp(s);
+			const char* name = GetName(&nvp);
+			if (name) {
+				if (ShaderToyBuffer::Find(name) == nullptr && nvp.size() <= 1 && name[0] != '[')
+					printf("warning: pass %u input buffer (\"%s\") has not been defined yet!\n", m_passIndex, name);
+				if (allowSpecificInputIndex)
+					m_inputs[inputIndex].m_buffer = ShaderToyBuffer::Add(m_passIndex, name, &nvp);
+				else {
+					m_inputs.resize(m_inputs.size() + 1);
+					m_inputs.back().m_buffer = ShaderToyBuffer::Add(m_passIndex, name, &nvp);
+				}
+			} else
+				printf("error: pass %u input description expected to start with name!\n", m_passIndex);
+		} else
+			printf("error: pass %u input not processed, missing ':'!\n", m_passIndex);
+	}
+
+	void AddOutput(char* s)
+	{
+		uint32 outputIndex = 0;
+		if (isdigit(*s)) {
+			outputIndex = (uint32)atoi(s);
+			while (isdigit(*s))
+				s++;
+		}
+		static uint32 maxDrawBuffers = 0;
+		if (maxDrawBuffers == 0)  {
+			uint32 maxColorAttachments = 0;
+			glGetIntegerv(GL_MAX_COLOR_ATTACHMENTS, (GLint*)&maxColorAttachments);
+			printf("GL_MAX_COLOR_ATTACHMENTS = %u\n", maxColorAttachments);
+			glGetIntegerv(GL_MAX_DRAW_BUFFERS, (GLint*)&maxDrawBuffers);
+			printf("GL_MAX_DRAW_BUFFERS = %u\n", maxDrawBuffers);
+		}
+		if (outputIndex < maxDrawBuffers) {
+			SkipLeadingWhitespace(s);
+			if (*s++ == ':') {
+				if (m_outputs.size() < outputIndex + 1)
+					m_outputs.resize(outputIndex + 1);
+				PassOutput& output = m_outputs[outputIndex];
+				if (output.m_buffer == nullptr) {
+					char* trailingComment = strstr(s, "//");
+					if (trailingComment)
+						*trailingComment = '\0';
+					const NameValuePairs nvp(s);
+					const char* name = GetName(&nvp);
+					if (name) {
+						output.m_buffer = ShaderToyBuffer::Add(m_passIndex, name, &nvp);
+						output.m_layerOrSliceIndex = nvp.GetUIntValue("layer");
+						output.m_mipIndex = nvp.GetUIntValue("mip");
+					} else
+						printf("error: pass %u output %u description expected to start with name!\n", m_passIndex, outputIndex);
+				} else
+					printf("error: pass %u output %u already bound to a buffer!\n", m_passIndex, outputIndex);
+			} else
+				printf("error: pass %u output %u not processed, missing ':'!\n", m_passIndex, outputIndex);
+		} else
+			printf("error: pass %u output %u not processed, max output index is %u!\n", m_passIndex, outputIndex, maxDrawBuffers - 1);
+	}
+
+#if SUPPORT_IMAGES
+	// e.g. //$COMPUTE: local_size=8x8, dispatch=lightmapvis - dispatches enough groups to cover the buffer's resolution
+	// (or a fixed thread count, e.g. dispatch=256x256) and calls mainCompute(gl_GlobalInvocationID). results go
+	// through $IMAGEs, there are no $OUTPUTs. threads beyond the dispatch size are not culled (so that barrier() is
+	// legal), compare against iOutputResolution
+	void SetCompute(char* s)
+	{
+		SkipLeadingWhitespace(s);
+		if (*s++ == ':') {
+			char* trailingComment = strstr(s, "//");
+			if (trailingComment)
+				*trailingComment = '\0';
+			const NameValuePairs nvp(s);
+			m_isCompute = true;
+			sscanf(nvp.GetStringValue("local_size", "8x8"), "%ux%ux%u", &m_localSize[0], &m_localSize[1], &m_localSize[2]);
+			const char* dispatch = nvp.GetStringValue("dispatch", "");
+			if (isdigit(*dispatch))
+				sscanf(dispatch, "%ux%ux%u", &m_dispatchSize[0], &m_dispatchSize[1], &m_dispatchSize[2]);
+			else
+				m_dispatchBufferName = dispatch; // resolved once all the metadata has been processed
+		} else
+			printf("error: pass %u compute not processed, missing ':'!\n", m_passIndex);
+	}
+
+	// e.g. //$ITERATIONS:16 - renders the pass 16 times per frame, with iPass = 0..15 and iPassCount = 16. ping-pong
+	// outputs swap after each iteration, so every iteration reads the previous one's result. accumulating passes should
+	// seed and weight by iSample (iFrame*iPassCount + iPass here) rather than iFrame, or every iteration repeats one sample
+	// e.g. //$ITERATIONS: budget_ms=4, max=256 - as many iterations as fit in 4ms of GPU time, measured by a GPUTimer
+	// over the previous frames. the count adapts as the cost changes (e.g. window resize), so the frame rate holds
+	void SetIterations(char* s)
+	{
+		SkipLeadingWhitespace(s);
+		if (*s++ == ':') {
+			char* trailingComment = strstr(s, "//");
+			if (trailingComment)
+				*trailingComment = '\0';
+			SkipLeadingWhitespace(s);
+			if (isdigit(*s)) {
+				m_iterations = Max(1, atoi(s));
+				m_minIterations = m_maxIterations = m_iterations;
+			} else {
+				const NameValuePairs nvp(s);
+				m_iterationBudgetMs = nvp.GetFloatValue("budget_ms");
+				m_minIterations = Max(1U, nvp.GetUIntValue("min", 1));
+				m_maxIterations = Max(m_minIterations, nvp.GetUIntValue("max", 256));
+				m_iterations = m_minIterations;
+			}
+		} else
+			printf("error: pass %u iterations not processed, missing ':'!\n", m_passIndex);
+	}
+
+	void SetTiles(char* s) // e.g. "$TILES: 4x4"
+	{
+		SkipLeadingWhitespace(s);
+		if (*s++ == ':') {
+			uint32 x = 0, y = 0;
+			if (sscanf(s, " %ux%u", &x, &y) == 2 && x > 0 && y > 0) {
+				m_tiles[0] = x;
+				m_tiles[1] = y;
+			} else
+				printf("error: pass %u tiles not processed, expected WxH!\n", m_passIndex);
+		} else
+			printf("error: pass %u tiles not processed, missing ':'!\n", m_passIndex);
+	}
+
+	void SetTimeSlice(char* s) // e.g. "$TIME_SLICE: 4" (ms per frame)
+	{
+		SkipLeadingWhitespace(s);
+		if (*s++ == ':')
+			m_timeSliceMs = Max(0.0f, (float)atof(s));
+		else
+			printf("error: pass %u time slice not processed, missing ':'!\n", m_passIndex);
+	}
+
+	bool IsTiled() const { return m_tiles[0]*m_tiles[1] > 1; }
+
+	bool HasUniformOutputSize() const // the tile grid comes from output 0, so the others have to match it
+	{
+		const PassOutput& first = m_outputs[0];
+		for (uint32 i = 1; i < m_outputs.size(); i++) {
+			const PassOutput& output = m_outputs[i];
+			if (output.m_buffer == nullptr ||
+				output.m_mipIndex != first.m_mipIndex ||
+				output.m_buffer->m_desc.m_resolutionX != first.m_buffer->m_desc.m_resolutionX ||
+				output.m_buffer->m_desc.m_resolutionY != first.m_buffer->m_desc.m_resolutionY ||
+				output.m_buffer->m_desc.m_relativeResX != first.m_buffer->m_desc.m_relativeResX ||
+				output.m_buffer->m_desc.m_relativeResY != first.m_buffer->m_desc.m_relativeResY)
+				return false;
+		}
+		return true;
+	}
+
+	uint32 GetNumIterations()
+	{
+		if (m_iterationBudgetMs > 0.0f && m_iterationTimer.Poll() && m_iterationTimer.GetLastTag() > 0) {
+			const float ms = Max(0.001f, m_iterationTimer.GetLastMs()/(float)m_iterationTimer.GetLastTag());
+			m_msPerIteration = m_msPerIteration > 0.0f ? m_msPerIteration*0.75f + ms*0.25f : ms; // smoothed, or the count oscillates
+			m_iterations = Clamp((uint32)(m_iterationBudgetMs/m_msPerIteration), m_minIterations, m_maxIterations);
+		}
+		return m_iterations;
+	}
+
+	void GetDispatchSize(uint32 threads[3]) const
+	{
+		for (uint32 i = 0; i < 3; i++)
+			threads[i] = m_dispatchSize[i];
+		if (m_dispatchBuffer) {
+			threads[0] = m_dispatchBuffer->m_res[0];
+			threads[1] = m_dispatchBuffer->m_res[1];
+			threads[2] = m_dispatchBuffer->m_desc.m_resolutionZ > 1 ? m_dispatchBuffer->m_res[2] : m_dispatchBuffer->m_desc.m_numLayers;
+		}
+	}
+
+	void AddImage(char* s)
+	{
+		SkipLeadingWhitespace(s);
+		if (*s++ == ':') {
+			char* trailingComment = strstr(s, "//");
+			if (trailingComment)
+				*trailingComment = '\0';
+			const NameValuePairs nvp(s);
+			const char* name = GetName(&nvp);
+			if (name) {
+				const char* bufferName = nvp.GetStringValue("buffer", name);
+				if (ShaderToyBuffer::Find(bufferName) == nullptr && nvp.size() <= 1 && bufferName[0] != '[')
+					printf("warning: pass %u image buffer (\"%s\") has not been defined yet!\n", m_passIndex, bufferName);
+				ShaderToyBuffer* buffer = ShaderToyBuffer::Add(m_passIndex, bufferName, &nvp);
+				m_images.resize(m_images.size() + 1);
+				PassImage& image = m_images.back();
+				image.m_name = name;
+				image.m_buffer = buffer;
+				image.m_layered = nvp.GetBoolValue("layered");
+				image.m_layerOrSliceIndex = nvp.GetUIntValue("layer");
+				image.m_mipIndex = nvp.GetUIntValue("mip");
+				if (nvp.HasValue("read") || nvp.HasValue("write")) {
+					const bool readAccess = nvp.GetBoolValue("read");
+					const bool writeAccess = nvp.GetBoolValue("write");
+					if (readAccess && writeAccess)
+						image.m_access = GL_READ_WRITE;
+					else if (readAccess)
+						image.m_access = GL_READ_ONLY;
+					else if (writeAccess)
+						image.m_access = GL_WRITE_ONLY;
+				} else
+					image.m_access = GL_READ_WRITE; // default
+				image.m_internalFormat = TextureFormatInfo(buffer->m_desc.m_format).m_internalFormat;
+			} else
+				printf("error: pass %u image description expected to start with name!\n", m_passIndex);
+		} else
+			printf("error: pass %u image not processed, missing ':'!\n", m_passIndex);
+	}
+#endif // SUPPORT_IMAGES
+
+	class PassRef
+	{
+	public:
+		PassRef(const char* path, float data = 0.0f) : m_path(path), m_data(data) {}
+		std::string m_path;
+		float m_data;
+	};
+
+	// parses the pass metadata and prepares its program request, see LoadShaders for the remaining steps
+	static ShaderToyRenderPass* LoadPass(
+		uint32 passIndex,
+		const PassRef& ref,
+		const std::vector<std::string>& sourceHeader,
+		ShaderProgramRequest& request)
+	{
+		const char* path = ref.m_path.c_str();
+		printf("loading pass \"%s\" ..\n", path);
+		ShaderToyRenderPass* pass = nullptr;
+		FILE* file = fopen(path, "r");
+		if (file) {
+			pass = new ShaderToyRenderPass(passIndex, 0);
+			pass->m_path = path;
+
+			// process metadata
+			char line[SHADER_CODE_MAX_LINE_SIZE];
+			while (rage_fgetline(line, sizeof(line), file)) {
+				const std::string lineCopy = line;
+				char* s = line;
+				SkipLeadingWhitespace(s);
+				if (!if_strskip(s, "//"))
+					continue;
+				SkipLeadingWhitespace(s);
+				if      (if_strskip(s, "$BUFFER")) pass->AddBuffer(s);
+				else if (if_strskip(s, "$INPUT" )) pass->AddInput(s);
+				else if (if_strskip(s, "$OUTPUT")) pass->AddOutput(s);
+				else if (if_strskip(s, "$ITERATIONS")) pass->SetIterations(s);
+				else if (if_strskip(s, "$TILES")) pass->SetTiles(s);
+				else if (if_strskip(s, "$TIME_SLICE")) pass->SetTimeSlice(s);
+			#if SUPPORT_IMAGES
+				else if (if_strskip(s, "$IMAGE" )) pass->AddImage(s);					
+				else if (if_strskip(s, "$COMPUTE")) pass->SetCompute(s);
+			#endif // SUPPORT_IMAGES
+			}
+		#if SUPPORT_IMAGES
+			for (uint32 i = 0; i < pass->m_images.size(); i++)
+				if (pass->m_images[i].m_access != GL_READ_ONLY)
+					pass->m_iterationBarrierBits = GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT;
+		#endif // SUPPORT_IMAGES
+			if (pass->m_timeSliceMs > 0.0f && !pass->IsTiled()) {
+				pass->m_tiles[0] = 8; // default grid
+				pass->m_tiles[1] = 8;
+			}
+			if (pass->IsTiled()) {
+				if (pass->m_isCompute || pass->m_outputs.empty() || pass->m_outputs[0].m_buffer == nullptr) {
+					printf("warning: pass %u (%s) can't be tiled, it needs an $OUTPUT buffer and a fragment shader\n", pass->m_passIndex, pass->GetFileName());
+					pass->m_tiles[0] = pass->m_tiles[1] = 1;
+					pass->m_timeSliceMs = 0.0f;
+				} else if (!pass->HasUniformOutputSize()) {
+					printf("warning: pass %u (%s) can't be tiled, its outputs have different sizes\n", pass->m_passIndex, pass->GetFileName());
+					pass->m_tiles[0] = pass->m_tiles[1] = 1;
+					pass->m_timeSliceMs = 0.0f;
+				} else if (pass->m_maxIterations > 1) {
+					printf("warning: pass %u (%s) is tiled, ignoring $ITERATIONS\n", pass->m_passIndex, pass->GetFileName());
+					pass->m_iterations = pass->m_minIterations = pass->m_maxIterations = 1;
+					pass->m_iterationBudgetMs = 0.0f;
+				}
+			}
+			if (pass->m_isCompute) {
+				if (!pass->m_dispatchBufferName.empty()) {
+					pass->m_dispatchBuffer = ShaderToyBuffer::Find(pass->m_dispatchBufferName.c_str());
+					if (pass->m_dispatchBuffer == nullptr)
+						printf("error: pass %u dispatch buffer (\"%s\") has not been defined!\n", passIndex, pass->m_dispatchBufferName.c_str());
+				}
+				if (!pass->m_outputs.empty()) {
+					printf("warning: compute pass %u has outputs, compute passes write through images ..\n", passIndex);
+					pass->m_outputs.clear();
+				}
+			}
+			std::vector<std::string> sourceHeaderPlusInputSamplers;
+			sourceHeaderPlusInputSamplers.push_back("");
+			sourceHeaderPlusInputSamplers.push_back("//<=== BEGIN SAMPLERS ===>");
+			for (uint32 inputIndex = 0; inputIndex < pass->m_inputs.size(); inputIndex++) {
+				const PassInput& input = pass->m_inputs[inputIndex];
+				const ShaderToyBuffer* buffer = input.m_buffer;
+				if (buffer) {
+					const std::string samplerTypeStr = GetOpenGLSamplerTypeStr(buffer->m_target, buffer->m_desc.m_format);
+					char channelName[256];
+					strcpy(channelName, buffer->m_desc.m_name.c_str());
+					for (char* s1 = channelName; *s1; s1++) {
+						if (!isalnum(*s1))
+							*s1 = '_';
+					}
+					sourceHeaderPlusInputSamplers.push_back(varString("uniform %s iChannel%u;", samplerTypeStr.c_str(), inputIndex));
+					sourceHeaderPlusInputSamplers.push_back(varString("#define %s iChannel%u", channelName, inputIndex));
+				}
+			}
+		#if SUPPORT_IMAGES
+			for (uint32 imageIndex = 0; imageIndex < pass->m_images.size(); imageIndex++) {
+				const PassImage& image = pass->m_images[imageIndex];
+				const ShaderToyBuffer* buffer = image.m_buffer;
+				if (buffer) {
+					const bool isShadow = false;
+					const bool isImage = true;
+					const std::string samplerTypeStr = GetOpenGLSamplerTypeStr(buffer->m_target, buffer->m_desc.m_format, isShadow, isImage, image.m_layered);
+					char imageName[256];
+					strcpy(imageName, image.m_name.c_str());
+					for (char* s1 = imageName; *s1; s1++) {
+						if (!isalnum(*s1))
+							*s1 = '_';
+					}
+					sourceHeaderPlusInputSamplers.push_back(varString("layout(binding=%u,%s) uniform %s iImageChannel%u;", imageIndex, TextureFormatInfo(buffer->m_desc.m_format).m_formatQualifier, samplerTypeStr.c_str(), imageIndex));
+					sourceHeaderPlusInputSamplers.push_back(varString("#define %s_IMAGE iImageChannel%u", imageName, imageIndex));
+				}
+			}
+		#endif // SUPPORT_IMAGES
+			sourceHeaderPlusInputSamplers.push_back("//<=== END SAMPLERS ===>");
+			sourceHeaderPlusInputSamplers.push_back("");
+			pass->m_samplerHeader = sourceHeaderPlusInputSamplers; // kept for hot reload, when the common header might have changed
+			for (uint32 i = 0; i < sourceHeader.size(); i++)
+				sourceHeaderPlusInputSamplers.push_back(sourceHeader[i]);
+
+			const bool alwaysEmit4ComponentVector = true; // pretty sure compiler will optimize out any unused components .. but you can change this if you want
+			std::vector<std::string> sourceFooter; // this links the shadertoy main function (mainImage) to the GLSL main function
+			std::string params = "";
+			sourceFooter.push_back("");
+			sourceFooter.push_back("//<=== BEGIN FOOTER ===>");
+			if (pass->m_isCompute) {
+				sourceFooter.push_back(varString("layout(local_size_x=%u, local_size_y=%u, local_size_z=%u) in;", pass->m_localSize[0], pass->m_localSize[1], pass->m_localSize[2]));
+				params = "gl_GlobalInvocationID";
+			} else if (pass->m_outputs.size() > 0) {
+				for (uint32 i = 0; i < pass->m_outputs.size(); i++) {
+					const ShaderToyBuffer* buffer = pass->m_outputs[i].m_buffer;
+					if (buffer) {
+						char layoutStr[64] = "";
+						const char* typeStr = TextureFormatInfo(buffer->m_desc.m_format).m_formatType;
+						if (alwaysEmit4ComponentVector) {
+							if (strcmp(typeStr, "float") == 0 ||
+								strcmp(typeStr, "vec2") == 0 ||
+								strcmp(typeStr, "vec3") == 0)
+								typeStr = "vec4";
+							if (strcmp(typeStr, "int") == 0 ||
+								strcmp(typeStr, "ivec2") == 0 ||
+								strcmp(typeStr, "ivec3") == 0)
+								typeStr = "ivec4";
+							if (strcmp(typeStr, "uint") == 0 ||
+								strcmp(typeStr, "uvec2") == 0 ||
+								strcmp(typeStr, "uvec3") == 0)
+								typeStr = "uvec4";
+						}
+						char paramName[64] = "fragOut";
+						if (pass->m_outputs.size() > 1) {
+							sprintf(layoutStr, "layout(location=%u) ", i);
+							strcatf(paramName, "%u", i);
+						}
+						params += varString("%s%s", params.empty() ? "" : ", ", paramName);
+						sourceFooter.push_back(varString("%sout %s %s;", layoutStr, typeStr, paramName));
+					}
+				}
+			} else {
+				const char* typeStr = "vec4";
+				const char paramName[64] = "fragOut";
+				params = paramName;
+				sourceFooter.push_back(varString("out %s %s;", typeStr, paramName));
+			}
+			sourceFooter.push_back("");
+			sourceFooter.push_back("void main()");
+			sourceFooter.push_back("{");
+			if (pass->m_isCompute)
+				sourceFooter.push_back(varString("\tmainCompute(%s);", params.c_str()));
+			else
+				sourceFooter.push_back(varString("\tmainImage(%s, gl_FragCoord.xy);", params.c_str()));
+			sourceFooter.push_back("}");
+			sourceFooter.push_back("//<=== END FOOTER ===>");
+			pass->m_sourceFooter = sourceFooter;
+			if (!PrepareShaderProgram(request, path, &sourceHeaderPlusInputSamplers, &sourceFooter, pass->m_isCompute ? GL_COMPUTE_SHADER : GL_FRAGMENT_SHADER)) {
+				delete pass;
+				pass = nullptr;
+			}
+			fclose(file);
+		}
+		return pass;
+	}
+
+	static ShaderToyRenderPass* FinishPass(ShaderToyRenderPass* pass, ShaderProgramRequest& request)
+	{
+		if (pass) {
+			pass->m_programID = FinishShaderProgram(request);
+			pass->m_sourceFiles.swap(request.m_sourceFiles);
+			if (pass->m_programID != 0) {
+				pass->m_uniforms.Init(pass->m_passIndex, pass->m_programID);
+				GetPasses().push_back(pass);
+			} else {
+				delete pass;
+				pass = nullptr;
+			}
+		}
+		return pass;
+	}
+
+	// builds the source header shared by every pass (shadertoy uniforms + COMMON.glsl) and finds the passes. no GL calls,
+	// $BUFFER lines in COMMON.glsl are left to the caller (lines [firstCommonLineIndex, endCommonLineIndex) of sourceHeader)
+	static void LoadCommon(const char* dir, std::vector<std::string>& sourceHeader, uint32& firstCommonLineIndex, uint32& endCommonLineIndex, std::vector<PassRef>& passRefs)
+	{
+		// this includes all the shadertoy uniforms as well as the common file
+		sourceHeader.push_back("//<=== BEGIN HEADER ===>");
+		LoadFileIntoStrings(sourceHeader, "shaders_common/shadertoy_common.h");
+		LoadFileIntoStrings(sourceHeader, "shaders_common/shadertoy_common.glsl");
+	#if USE_GUI
+		if (g_GUIEnabled) {
+			sourceHeader.push_back("#define SLIDER_VAR(type,name,init,rangemin,rangemax) uniform type name = type(init)\n");
+			sourceHeader.push_back("#define SLIDER_CHANGED g_GUISliderChanged\n");
+			sourceHeader.push_back("uniform bool g_GUISliderChanged = false;\n");
+		}
+	#endif // USE_GUI
+		sourceHeader.push_back("//<=== END HEADER ===>");
+		sourceHeader.push_back("");
+		sourceHeader.push_back("//<=== BEGIN COMMON ===>");
+		firstCommonLineIndex = (uint32)sourceHeader.size();
+		LoadFileIntoStrings(sourceHeader, varString("%s/COMMON.glsl", dir));
+		endCommonLineIndex = (uint32)sourceHeader.size();
+		for (uint32 i = firstCommonLineIndex; i < endCommonLineIndex; i++) {
+			char temp[SHADER_CODE_MAX_LINE_SIZE];
+			strcpy(temp, sourceHeader[i].c_str());
+			char* s = temp;
+			SkipLeadingWhitespace(s);
+			if (!if_strskip(s, "//"))
+				continue;
+			SkipLeadingWhitespace(s);
+			if (if_strskip(s, "$PASS")) {
+				SkipLeadingWhitespace(s);
+				if (*s++ == ':') {
+					char* trailingComment = strstr(s, "//");
+					if (trailingComment)
+						*trailingComment = '\0';
+					const NameValuePairs nvp(s);
+					const char* name = GetName(&nvp);
+					if (name) {
+						const float data = nvp.GetFloatValue("data");
+						passRefs.push_back(PassRef(varString("%s/%s", dir, name).c_str(), data));
+					} else
+						printf("error: pass description expected to start with path!\n");
+				} else
+					printf("error: pass not processed, missing ':'!\n");
+			}
+		}
+		sourceHeader.push_back("//<=== END COMMON ===>");
+		sourceHeader.push_back("");
+
+		if (passRefs.size() == 0) { // no passes specified in COMMON.glsl .. try hardcoded "PASS_0.glsl", "PASS_1.glsl", etc.
+			for (uint32 passIndex = 0; passIndex < MAX_PASSES; passIndex++) {
+				const varString path("%s/PASS_%u.glsl", dir, passIndex);
+				if (FileExists(path.c_str()))
+					passRefs.push_back(PassRef(path.c_str()));
+				else
+					break;
+			}
+		}
+	}
+
+	static void LoadShaders(const char* dir = "shaders")
+	{
+		TRACE_SCOPE_DETAIL("LoadShaders", dir);
+		const uint64 loadTime = ProgressDisplay::GetCurrentPerformanceTime();
+		ShaderPreprocessor::ClearFileCache(); // pick up any edits since the last load
+		std::vector<std::string> sourceHeader;
+		std::vector<PassRef> passRefs;
+		uint32 firstCommonLineIndex = 0;
+		uint32 endCommonLineIndex = 0;
+		LoadCommon(dir, sourceHeader, firstCommonLineIndex, endCommonLineIndex, passRefs);
+		const varString commonPath("%s/COMMON.glsl", dir);
+		for (uint32 i = firstCommonLineIndex; i < endCommonLineIndex; i++) { // add buffers specified in common ..
+			char temp[SHADER_CODE_MAX_LINE_SIZE];
+			strcpy(temp, sourceHeader[i].c_str());
+			char* s = temp;
+			SkipLeadingWhitespace(s);
+			if (!if_strskip(s, "//"))
+				continue;
+			SkipLeadingWhitespace(s);
+			if (if_strskip(s, "$BUFFER")) {
+				SkipLeadingWhitespace(s);
+				if (*s++ == ':') {
+					char* trailingComment = strstr(s, "//");
+					if (trailingComment)
+						*trailingComment = '\0';
+					const NameValuePairs nvp(s);
+					const char* name = GetName(&nvp);
+					if (name)
+						ShaderToyBuffer::Add(-1, name, &nvp);
+					else
+						printf("error: buffer description expected to start with name!\n");
+				} else
+					printf("error: buffer not processed, missing ':'!\n");
+			}
+		}
+	#if USE_GUI
+		if (g_GUIEnabled) {
+			GUISlider::SetCurrentPassIndexForShaderLoad(-1);
+			for (uint32 i = firstCommonLineIndex; i < endCommonLineIndex; i++)
+				GUISlider::AddSlider(commonPath, i - firstCommonLineIndex, sourceHeader[i].c_str());
+		}
+	#endif // USE_GUI
+
+		// ==================================================================================================
+		// TODO -- LoadPass should not store the pass - it should store the *reference* to the pass and only
+		// load (and store) the pass if the path is unique. we want to be able to handle multiple refs to the
+		// same pass in memory, each ref has its own 'data'
+		// ==================================================================================================
+		g_ProgramBinaryCacheHits = 0;
+		g_ProgramBinaryCacheMisses = 0;
+		GLuint commonVertexShaderID = 0;
+		LoadShader(commonVertexShaderID, "shaders_common/shadertoy_vertex.glsl", nullptr, GL_VERTEX_SHADER, VERTEX_SHADER_VERSION_STR);
+		std::vector<ShaderToyRenderPass*> loading(passRefs.size(), nullptr);
+		std::vector<ShaderProgramRequest> requests(passRefs.size());
+		for (uint32 passIndex = 0; passIndex < passRefs.size(); passIndex++) // metadata creates buffers, so this stays on the main thread
+			loading[passIndex] = LoadPass(passIndex, passRefs[passIndex], sourceHeader, requests[passIndex]);
+
+		const uint64 preprocessTime = ProgressDisplay::GetCurrentPerformanceTime();
+		JobSystem::ParallelFor((uint32)passRefs.size(), [&](uint32 passIndex) {
+			if (loading[passIndex])
+				PreprocessShaderProgram(requests[passIndex]);
+		});
+		const float preprocessSecs = ProgressDisplay::GetTimeInSeconds(preprocessTime);
+
+		// with parallel compile, every pass is submitted before any results are collected so the driver compiles them
+		// concurrently - otherwise each pass is submitted and finished in turn
+		for (uint32 passIndex = 0; passIndex < passRefs.size(); passIndex++) {
+			if (loading[passIndex]) {
+			#if USE_GUI
+				GUISlider::SetCurrentPassIndexForShaderLoad(passIndex);
+				RegisterSliderLines(requests[passIndex].m_sliderLines);
+			#endif // USE_GUI
+				SubmitShaderProgram(requests[passIndex], commonVertexShaderID);
+				if (!g_ParallelShaderCompile)
+					loading[passIndex] = FinishPass(loading[passIndex], requests[passIndex]);
+			}
+		}
+		for (uint32 passIndex = 0; passIndex < passRefs.size(); passIndex++) {
+			if (g_ParallelShaderCompile) {
+				while (loading[passIndex] && !requests[passIndex].IsReady())
+					std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				loading[passIndex] = FinishPass(loading[passIndex], requests[passIndex]);
+			}
+			if (loading[passIndex])
+				printf("loaded pass \"%s\"\n", passRefs[passIndex].m_path.c_str());
+			else
+				printf("failed to load pass \"%s\"!\n", passRefs[passIndex].m_path.c_str());
+		}
+		// cold start is all misses, warm start is all hits - run twice to compare, and with -serial_compile to see the parallel compile gain
+		printf("loaded %u passes in %.3f secs (preprocess %.3f secs, %u programs from binary cache, %u compiled%s, %s)\n",
+			(uint32)GetPasses().size(),
+			ProgressDisplay::GetTimeInSeconds(loadTime),
+			preprocessSecs,
+			g_ProgramBinaryCacheHits,
+			g_ProgramBinaryCacheMisses,
+			g_ProgramBinaryCache ? "" : ", cache disabled",
+			g_ParallelShaderCompile ? "parallel compile" : "serial compile");
+		SetupPingPongBuffers();
+		AliasTransientBuffers();
+		BuildDependencyGraph();
+		ResolveAutoMips();
+
+		HotReloadState& hr = GetHotReloadState();
+		hr.m_dir = dir;
+		hr.m_commonVertexShaderID = commonVertexShaderID;
+		std::vector<std::string> commonFiles;
+		GetCommonSourceFiles(dir, commonFiles);
+		for (uint32 i = 0; i < commonFiles.size(); i++)
+			hr.m_watcher.Watch(commonFiles[i]);
+		for (uint32 i = 0; i < GetPasses().size(); i++)
+			for (uint32 j = 0; j < GetPasses()[i]->m_sourceFiles.size(); j++)
+				hr.m_watcher.Watch(GetPasses()[i]->m_sourceFiles[j]);
+
+		if (0) { // dump pass info
+			std::vector<ShaderToyRenderPass*>& passes = GetPasses();
+			for (uint32 i = 0; i < passes.size(); i++) {
+				const ShaderToyRenderPass* pass = passes[i];
+				printf("\n");
+				for (uint32 j = 0; j < pass->m_inputs.size(); j++) {
+					const ShaderToyRenderPass::PassInput& input = pass->m_inputs[j];
+					if (input.m_buffer)
+						printf("PASS_%u - INPUT%u: %s\n", i, j, input.m_buffer->m_desc.m_name.c_str());
+				}
+				for (uint32 j = 0; j < pass->m_outputs.size(); j++) {
+					const ShaderToyRenderPass::PassOutput& output = pass->m_outputs[j];
+					if (output.m_buffer)
+						printf("PASS_%u - OUTPUT%u: %s (layer=%u)\n", i, j, output.m_buffer->m_desc.m_name.c_str(), output.m_layerOrSliceIndex);
+				}
+			}
+		}
+	}
+
+	class HotReloadState
+	{
+	public:
+		HotReloadState() : m_commonVertexShaderID(0) {}
+		std::string m_dir;
+		GLuint m_commonVertexShaderID;
+		FileWatcher m_watcher;
+	};
+
+	static HotReloadState& GetHotReloadState()
+	{
+		static HotReloadState hr;
+		return hr;
+	}
+
+	static void GetCommonSourceFiles(const char* dir, std::vector<std::string>& files) // a change to any of these affects every pass
+	{
+		files.push_back("shaders_common/shadertoy_common.h");
+		files.push_back("shaders_common/shadertoy_common.glsl");
+		files.push_back("shaders_common/shadertoy_vertex.glsl");
+		files.push_back(varString("%s/COMMON.glsl", dir));
+	}
+
+	// recompiles the passes whose source files changed. the old program stays in use until the new one links, and
+	// buffers are left alone so accumulated results survive the edit. only shader code is reloaded - changes to pass
+	// metadata ($INPUT, $OUTPUT etc.) or to the $PASS/$BUFFER lines in COMMON.glsl still need a restart, and new
+	// SLIDER_VARs don't get added to the GUI
+	static void ReloadChangedPasses()
+	{
+		HotReloadState& hr = GetHotReloadState();
+		std::vector<std::string> changed;
+		hr.m_watcher.Poll(changed);
+		if (changed.empty())
+			return;
+		std::vector<std::string> commonFiles;
+		GetCommonSourceFiles(hr.m_dir.c_str(), commonFiles);
+		bool allPasses = false;
+		bool vertexShaderChanged = false;
+		for (uint32 i = 0; i < changed.size(); i++) {
+			printf("file changed: %s\n", changed[i].c_str());
+			if (std::find(commonFiles.begin(), commonFiles.end(), changed[i]) != commonFiles.end())
+				allPasses = true;
+			if (changed[i] == commonFiles[2])
+				vertexShaderChanged = true;
+		}
+		const std::vector<ShaderToyRenderPass*>& passes = GetPasses();
+		std::vector<ShaderToyRenderPass*> reload;
+		for (uint32 i = 0; i < passes.size(); i++) {
+			bool affected = allPasses;
+			for (uint32 j = 0; j < changed.size() && !affected; j++)
+				affected = std::find(passes[i]->m_sourceFiles.begin(), passes[i]->m_sourceFiles.end(), changed[j]) != passes[i]->m_sourceFiles.end();
+			if (affected)
+				reload.push_back(passes[i]);
+		}
+		if (reload.empty())
+			return;
+
+		const uint64 reloadTime = ProgressDisplay::GetCurrentPerformanceTime();
+		g_HotReloading = true;
+		ShaderPreprocessor::ClearFileCache();
+		if (vertexShaderChanged) {
+			std::string code;
+			const std::string processedPath = GetShaderProcessedPathForSource(commonFiles[2].c_str(), nullptr, GL_VERTEX_SHADER);
+			PreprocessShader(code, processedPath.c_str(), commonFiles[2].c_str(), GL_VERTEX_SHADER, VERTEX_SHADER_VERSION_STR);
+			GLuint vertexShaderID = 0;
+			if (CompileShader(vertexShaderID, code, processedPath.c_str(), GL_VERTEX_SHADER)) {
+				glDeleteShader(hr.m_commonVertexShaderID); // only flagged, programs still using it keep it alive
+				hr.m_commonVertexShaderID = vertexShaderID;
+			}
+		}
+		std::vector<std::string> sourceHeader;
+		std::vector<PassRef> passRefs;
+		uint32 firstCommonLineIndex = 0;
+		uint32 endCommonLineIndex = 0;
+		LoadCommon(hr.m_dir.c_str(), sourceHeader, firstCommonLineIndex, endCommonLineIndex, passRefs);
+		std::vector<ShaderProgramRequest> requests(reload.size());
+		for (uint32 i = 0; i < reload.size(); i++) {
+			std::vector<std::string> header = reload[i]->m_samplerHeader;
+			header.insert(header.end(), sourceHeader.begin(), sourceHeader.end());
+			std::vector<std::string> footer = reload[i]->m_sourceFooter;
+			PrepareShaderProgram(requests[i], reload[i]->m_path.c_str(), &header, &footer, reload[i]->m_isCompute ? GL_COMPUTE_SHADER : GL_FRAGMENT_SHADER);
+		}
+		JobSystem::ParallelFor((uint32)reload.size(), [&](uint32 i) { PreprocessShaderProgram(requests[i]); });
+		for (uint32 i = 0; i < reload.size(); i++)
+			SubmitShaderProgram(requests[i], hr.m_commonVertexShaderID);
+		uint32 numReloaded = 0;
+		for (uint32 i = 0; i < reload.size(); i++) {
+			ShaderToyRenderPass* pass = reload[i];
+			while (!requests[i].IsReady())
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			const GLuint programID = FinishShaderProgram(requests[i]);
+			if (requests[i].m_linked) {
+				const GLuint oldProgramID = pass->m_programID;
+				pass->m_programID = programID;
+				pass->m_uniforms.Init(pass->m_passIndex, programID);
+				pass->m_sourceFiles.swap(requests[i].m_sourceFiles);
+				for (uint32 j = 0; j < pass->m_sourceFiles.size(); j++)
+					hr.m_watcher.Watch(pass->m_sourceFiles[j]); // might have new includes
+				glDeleteProgram(oldProgramID);
+				g_ProgramUniformLocations.erase(oldProgramID);
+				g_ShaderToProcessedPath[GL_SHADER].erase(oldProgramID);
+				numReloaded++;
+			} else {
+				if (programID)
+					glDeleteProgram(programID);
+				printf("pass %u (%s) failed to reload, keeping the previous program\n", pass->m_passIndex, pass->GetFileName());
+			}
+		}
+		g_HotReloading = false;
+		printf("reloaded %u of %u affected passes in %.3f secs\n", numReloaded, (uint32)reload.size(), ProgressDisplay::GetTimeInSeconds(reloadTime));
+	}
+
+	// -preprocess_bench: times preprocessing every pass in each dir without a GL context, serially with a cold file
+	// cache (like the old loader), then on the JobSystem with a cold and a warm cache. pass samplers and footers
+	// depend on GL buffers so they are left out, the bulk of the source is COMMON.glsl and the includes anyway
+	static void PreprocessBenchmark(const std::vector<std::string>& dirs, uint32 iterations)
+	{
+		printf("preprocess benchmark, %u iterations, %u job threads + main thread\n", iterations, JobSystem::GetNumThreads());
+		for (uint32 d = 0; d < dirs.size(); d++) {
+			std::vector<std::string> sourceHeader;
+			std::vector<PassRef> passRefs;
+			uint32 firstCommonLineIndex = 0;
+			uint32 endCommonLineIndex = 0;
+			LoadCommon(dirs[d].c_str(), sourceHeader, firstCommonLineIndex, endCommonLineIndex, passRefs);
+			const uint32 numPasses = (uint32)passRefs.size();
+			std::vector<std::string> code(numPasses);
+			std::vector<std::vector<ShaderPreprocessor::SliderLine> > sliderLines(numPasses);
+			auto preprocess = [&](uint32 i) {
+				sliderLines[i].clear();
+				PreprocessShader(code[i], nullptr, passRefs[i].m_path.c_str(), GL_FRAGMENT_SHADER, FRAGMENT_SHADER_VERSION_STR, nullptr, &sourceHeader, nullptr, &sliderLines[i]);
+			};
+			float baseline = 0.0f;
+			float serialCold = 0.0f;
+			float parallelCold = 0.0f;
+			float parallelWarm = 0.0f;
+			for (uint32 iter = 0; iter < iterations; iter++) {
+				uint64 t = ProgressDisplay::GetCurrentPerformanceTime();
+				for (uint32 i = 0; i < numPasses; i++) { // what the old loader did per pass, header then include expansion
+					std::string c = varString("%s\n#define _SHADERTOY_PLAYER_VERSION_ 1\n", FRAGMENT_SHADER_VERSION_STR);
+					for (uint32 j = 0; j < sourceHeader.size(); j++)
+						c += varString("%s\n", sourceHeader[j].c_str());
+					std::map<std::string,bool> included;
+					LoadShaderCodeInternal(c, passRefs[i].m_path.c_str(), included, nullptr);
+				}
+				baseline += ProgressDisplay::GetTimeInSeconds(t);
+
+				ShaderPreprocessor::ClearFileCache();
+				t = ProgressDisplay::GetCurrentPerformanceTime();
+				for (uint32 i = 0; i < numPasses; i++)
+					preprocess(i);
+				serialCold += ProgressDisplay::GetTimeInSeconds(t);
+
+				ShaderPreprocessor::ClearFileCache();
+				t = ProgressDisplay::GetCurrentPerformanceTime();
+				JobSystem::ParallelFor(numPasses, preprocess);
+				parallelCold += ProgressDisplay::GetTimeInSeconds(t);
+
+				t = ProgressDisplay::GetCurrentPerformanceTime();
+				JobSystem::ParallelFor(numPasses, preprocess);
+				parallelWarm += ProgressDisplay::GetTimeInSeconds(t);
+			}
+			size_t totalBytes = 0;
+			for (uint32 i = 0; i < numPasses; i++)
+				totalBytes += code[i].size();
+			const float ms = 1000.0f/(float)Max(1U, iterations);
+			printf("  %s: %u passes, %.1fKB source, %u files\n", dirs[d].c_str(), numPasses, (float)totalBytes/1024.0f, ShaderPreprocessor::GetNumCachedFiles());
+			printf("    baseline (old loader) %8.3fms\n", baseline*ms);
+			printf("    serial (cold)         %8.3fms (%.2fx)\n", serialCold*ms, baseline/Max(serialCold, 1e-9f));
+			printf("    parallel (cold)       %8.3fms (%.2fx)\n", parallelCold*ms, baseline/Max(parallelCold, 1e-9f));
+			printf("    parallel (warm)       %8.3fms (%.2fx)\n", parallelWarm*ms, baseline/Max(parallelWarm, 1e-9f));
+		}
+	}
+
+	// a pass which samples the buffer it renders to is a feedback loop (undefined behavior), so any buffer which is
+	// both an $INPUT and an $OUTPUT of the same pass gets a front/back texture pair. every pass which renders to such a
+	// buffer renders to the back texture and then swaps, so readers always sample the most recent complete result.
+	// note that pixels a ping-pong pass discards are left with stale contents - write the previous value instead.
+	static void SetupPingPongBuffers()
+	{
+		const std::vector<ShaderToyRenderPass*>& passes = GetPasses();
+		for (uint32 i = 0; i < passes.size(); i++) {
+			const ShaderToyRenderPass* pass = passes[i];
+			for (uint32 j = 0; j < pass->m_outputs.size(); j++) {
+				ShaderToyBuffer* buffer = pass->m_outputs[j].m_buffer;
+				for (uint32 k = 0; k < pass->m_inputs.size(); k++) {
+					if (buffer && pass->m_inputs[k].m_buffer == buffer && !buffer->m_doubleBuffered) {
+						printf("buffer \"%s\" is read and written by pass %u (%s), using ping-pong textures\n", buffer->m_desc.m_name.c_str(), pass->m_passIndex, pass->GetFileName());
+						buffer->SetDoubleBuffered();
+					}
+				}
+				if (buffer && pass->IsTiled() && !buffer->m_doubleBuffered) { // readers see the front texture while tiles go to the back
+					printf("buffer \"%s\" is tiled by pass %u (%s), using ping-pong textures\n", buffer->m_desc.m_name.c_str(), pass->m_passIndex, pass->GetFileName());
+					buffer->SetDoubleBuffered();
+				}
+			}
+		}
+		for (uint32 i = 0; i < passes.size(); i++) {
+			ShaderToyRenderPass* pass = passes[i];
+			uint32 numPingPongOutputs = 0;
+			for (uint32 j = 0; j < pass->m_outputs.size(); j++) {
+				PassOutput& output = pass->m_outputs[j];
+				output.m_pingPong = output.m_buffer && output.m_buffer->m_doubleBuffered;
+				if (output.m_pingPong)
+					numPingPongOutputs++;
+			}
+			if (numPingPongOutputs > 1)
+				printf("warning: pass %u (%s) has %u ping-pong outputs, they must not be written separately by other passes!\n", pass->m_passIndex, pass->GetFileName(), numPingPongOutputs);
+		}
+	}
+
+	// a buffer is transient if every frame it is fully rendered by an $OUTPUT before anything reads it, so its contents
+	// are dead outside the passes [first write, last access]. transient buffers with storage compatible descs and
+	// disjoint live ranges share one texture. no barriers are needed for this since only framebuffer writes and texture
+	// fetches are involved, which are ordered between draws. pass outputs which discard pixels rely on the previous
+	// contents and should mark the buffer with persistent=TRUE.
+	static void AliasTransientBuffers(bool report = true)
+	{
+		class BufferLifetime
+		{
+		public:
+			BufferLifetime() : m_first(-1), m_last(-1), m_firstIsWrite(false), m_imageAccess(false), m_partialWrite(false), m_persistentReason(nullptr), m_owner(nullptr), m_groupLast(-1) {}
+			int m_first; // index into GetPasses()
+			int m_last;
+			bool m_firstIsWrite; // first access of the frame is a framebuffer write (and not also a read)
+			bool m_imageAccess;
+			bool m_partialWrite; // rendered to a single layer or mip
+			const char* m_persistentReason; // null if transient
+			ShaderToyBuffer* m_owner; // alias group owner
+			int m_groupLast; // last pass using the group's storage, only valid for owners
+		};
+		const std::vector<ShaderToyRenderPass*>& passes = GetPasses();
+		const std::map<std::string,ShaderToyBuffer*>& m = ShaderToyBuffer::GetMap();
+		std::map<const ShaderToyBuffer*,BufferLifetime> lifetimes;
+		for (uint32 i = 0; i < passes.size(); i++) {
+			std::vector<PassAccess> accesses;
+			passes[i]->GetAccesses(accesses);
+			for (uint32 j = 0; j < accesses.size(); j++) {
+				BufferLifetime& lt = lifetimes[accesses[j].m_buffer];
+				if (lt.m_first == -1) {
+					lt.m_first = (int)i;
+					lt.m_firstIsWrite = true;
+				}
+				if (lt.m_first == (int)i && accesses[j].m_type != PassAccess::ACCESS_FRAMEBUFFER)
+					lt.m_firstIsWrite = false;
+				if (accesses[j].m_type == PassAccess::ACCESS_IMAGE_READ || accesses[j].m_type == PassAccess::ACCESS_IMAGE_WRITE)
+					lt.m_imageAccess = true;
+				lt.m_last = (int)i;
+			}
+			for (uint32 j = 0; j < passes[i]->m_outputs.size(); j++) {
+				const PassOutput& output = passes[i]->m_outputs[j];
+				if (output.m_buffer && (output.m_layerOrSliceIndex > 0 || output.m_mipIndex > 0))
+					lifetimes[output.m_buffer].m_partialWrite = true;
+			}
+		}
+
+		uint64 totalBefore = 0;
+		std::vector<ShaderToyBuffer*> transients;
+		for (auto it = m.begin(); it != m.end(); ++it) {
+			ShaderToyBuffer* buffer = it->second;
+			BufferLifetime& lt = lifetimes[buffer];
+			const ShaderToyBuffer::Desc& desc = buffer->m_desc;
+			totalBefore += buffer->GetAllocatedSizeInBytes();
+			if (buffer->m_aliasOf)                                  lt.m_persistentReason = "already aliased";
+			else if (desc.m_name[0] == '[')                         lt.m_persistentReason = "built-in";
+			else if (!desc.m_path.empty())                          lt.m_persistentReason = "file";
+			else if (desc.m_persistent)                             lt.m_persistentReason = "persistent=TRUE";
+			else if (g_CapturedBuffers.find(desc.m_name) != g_CapturedBuffers.end()) lt.m_persistentReason = "captured";
+			else if (lt.m_first == -1)                              lt.m_persistentReason = "unused";
+			else if (buffer->m_doubleBuffered)                      lt.m_persistentReason = "ping-pong";
+			else if (lt.m_imageAccess)                              lt.m_persistentReason = "image access";
+			else if (desc.m_numLayers > 1 || desc.m_resolutionZ > 1 || desc.m_mipLevels > 1 || lt.m_partialWrite)
+			                                                        lt.m_persistentReason = "layers/mips";
+			else if (!lt.m_firstIsWrite)                            lt.m_persistentReason = "read before written";
+			else {
+				lt.m_persistentReason = nullptr;
+				transients.push_back(buffer);
+			}
+		}
+
+		// greedy interval packing - visit transients in order of first write and reuse the first compatible group which is dead by then
+		std::sort(transients.begin(), transients.end(), [&lifetimes](const ShaderToyBuffer* a, const ShaderToyBuffer* b) { return lifetimes[a].m_first < lifetimes[b].m_first; });
+		std::vector<ShaderToyBuffer*> owners;
+		for (uint32 i = 0; i < transients.size(); i++) {
+			ShaderToyBuffer* buffer = transients[i];
+			BufferLifetime& lt = lifetimes[buffer];
+			for (uint32 j = 0; j < owners.size(); j++) {
+				BufferLifetime& ownerLt = lifetimes[owners[j]];
+				if (ownerLt.m_groupLast < lt.m_first && buffer->m_desc.IsStorageCompatible(owners[j]->m_desc)) {
+					buffer->AliasTo(owners[j]);
+					lt.m_owner = owners[j];
+					ownerLt.m_groupLast = lt.m_last;
+					break;
+				}
+			}
+			if (lt.m_owner == nullptr) {
+				owners.push_back(buffer);
+				lt.m_owner = buffer;
+				lt.m_groupLast = lt.m_last;
+			}
+		}
+
+		if (report) {
+			uint64 totalAfter = 0;
+			uint32 numAliased = 0;
+			printf("buffer memory:\n");
+			for (auto it = m.begin(); it != m.end(); ++it) {
+				const ShaderToyBuffer* buffer = it->second;
+				const BufferLifetime& lt = lifetimes[buffer];
+				std::string usage;
+				if (lt.m_persistentReason)
+					usage = varString("persistent (%s)", lt.m_persistentReason);
+				else {
+					usage = varString("transient passes %u..%u", passes[lt.m_first]->m_passIndex, passes[lt.m_last]->m_passIndex);
+					if (lt.m_owner != buffer) {
+						usage += varString(", aliased to \"%s\"", lt.m_owner->m_desc.m_name.c_str());
+						numAliased++;
+					}
+				}
+				const uint64 size = buffer->GetTextureSizeInBytes()*(buffer->m_doubleBuffered ? 2 : 1);
+				printf("  %-24s %5ux%-5u %-32s %9.2fMB  %s\n", buffer->m_desc.m_name.c_str(), buffer->m_res[0], buffer->m_res[1], GetDX10FormatStr(buffer->m_desc.m_format, true), (double)size/(1024.0*1024.0), usage.c_str());
+				totalAfter += buffer->GetAllocatedSizeInBytes();
+			}
+			printf("total buffer memory %.2fMB before aliasing, %.2fMB after (%u buffers aliased onto %u textures)\n", (double)totalBefore/(1024.0*1024.0), (double)totalAfter/(1024.0*1024.0), numAliased, (uint32)owners.size());
+		}
+	}
+
+	static std::string GetMemoryBarrierBitsStr(GLbitfield bits)
+	{
+		std::string str = "";
+		if (bits & GL_TEXTURE_FETCH_BARRIER_BIT)       str += "|TEXTURE_FETCH";
+		if (bits & GL_SHADER_IMAGE_ACCESS_BARRIER_BIT) str += "|SHADER_IMAGE_ACCESS";
+		if (bits & GL_FRAMEBUFFER_BARRIER_BIT)         str += "|FRAMEBUFFER";
+		if (bits & GL_TEXTURE_UPDATE_BARRIER_BIT)      str += "|TEXTURE_UPDATE";
+		return str.empty() ? "NONE" : str.substr(1);
+	}
+
+	// works out which passes consume which buffers, and the minimal glMemoryBarrier before each pass.
+	// only image stores are incoherent - framebuffer writes are already visible to later draws - so a
+	// barrier is emitted only before the first later access of an image-written buffer, with just the bits
+	// that access type needs. the pass list is walked twice so image writes late in the frame are seen by
+	// passes early in the next frame.
+	static void BuildDependencyGraph(bool report = true)
+	{
+		class PendingWrite
+		{
+		public:
+			PendingWrite() : m_bits(0), m_passIndex(0) {}
+			GLbitfield m_bits; // barrier bits not yet issued since the image write
+			uint32 m_passIndex; // pass which did the write
+		};
+		const GLbitfield allBits = GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT;
+		const std::vector<ShaderToyRenderPass*>& passes = GetPasses();
+		std::map<const ShaderToyBuffer*,PendingWrite> pending;
+		std::vector<std::string> barrierSources(passes.size());
+		for (uint32 iter = 0; iter < 2; iter++) {
+			for (uint32 i = 0; i < passes.size(); i++) {
+				ShaderToyRenderPass* pass = passes[i];
+				std::vector<PassAccess> accesses;
+				pass->GetAccesses(accesses);
+				GLbitfield bits = 0;
+				barrierSources[i] = "";
+				for (uint32 j = 0; j < accesses.size(); j++) {
+					const auto f = pending.find(accesses[j].m_buffer);
+					if (f != pending.end() && (f->second.m_bits & accesses[j].GetBarrierBit())) {
+						bits |= accesses[j].GetBarrierBit();
+						barrierSources[i] += varString(" %s(pass %u)", accesses[j].m_buffer->m_desc.m_name.c_str(), f->second.m_passIndex);
+					}
+				}
+				pass->m_memoryBarrierBits = bits;
+				if (bits) {
+					for (auto it = pending.begin(); it != pending.end(); ) {
+						it->second.m_bits &= ~bits;
+						if (it->second.m_bits == 0)
+							it = pending.erase(it);
+						else
+							++it;
+					}
+				}
+				for (uint32 j = 0; j < accesses.size(); j++) {
+					if (accesses[j].m_type == PassAccess::ACCESS_IMAGE_WRITE) {
+						PendingWrite& w = pending[accesses[j].m_buffer];
+						w.m_bits = allBits;
+						w.m_passIndex = pass->m_passIndex;
+					}
+				}
+			}
+		}
+		if (report) {
+			uint32 numEdges = 0;
+			uint32 numBarriers = 0;
+			std::vector<std::string> lines;
+			for (uint32 i = 0; i < passes.size(); i++) {
+				const ShaderToyRenderPass* pass = passes[i];
+				lines.push_back(varString("  pass %u (%s)", pass->m_passIndex, pass->GetFileName()));
+				if (pass->m_memoryBarrierBits) {
+					lines.push_back(varString("    barrier %s, for%s", GetMemoryBarrierBitsStr(pass->m_memoryBarrierBits).c_str(), barrierSources[i].c_str()));
+					numBarriers++;
+				}
+				std::vector<PassAccess> accesses;
+				pass->GetAccesses(accesses);
+				for (uint32 j = 0; j < accesses.size(); j++) {
+					const PassAccess& access = accesses[j];
+					if (access.IsWrite())
+						lines.push_back(varString("    writes %s (%s)", access.m_buffer->m_desc.m_name.c_str(), access.GetTypeStr()));
+					else {
+						// producer is the closest earlier writer, wrapping around to the previous frame
+						std::string producer = "none";
+						for (uint32 k = 1; k <= passes.size() && producer == "none"; k++) {
+							const uint32 pi = (i + passes.size() - k)%passes.size();
+							std::vector<PassAccess> producerAccesses;
+							passes[pi]->GetAccesses(producerAccesses);
+							for (uint32 m = 0; m < producerAccesses.size(); m++) {
+								if (producerAccesses[m].m_buffer == access.m_buffer && producerAccesses[m].IsWrite()) {
+									producer = varString("pass %u%s", passes[pi]->m_passIndex, pi >= i ? " (previous frame)" : "");
+									numEdges++;
+									break;
+								}
+							}
+						}
+						lines.push_back(varString("    reads  %s (%s) <- %s", access.m_buffer->m_desc.m_name.c_str(), access.GetTypeStr(), producer.c_str()));
+					}
+				}
+			}
+			printf("dependency graph: %u passes, %u edges, %u memory barriers per frame\n", (uint32)passes.size(), numEdges, numBarriers);
+			for (uint32 i = 0; i < lines.size(); i++)
+				printf("%s\n", lines[i].c_str());
+		}
+	}
+
+	// render targets with mips and no automips=TRUE/FALSE get their mips generated, unless some pass writes a lower
+	// mip itself ($OUTPUT or $IMAGE with mip=N) - then regenerating them after each mip 0 write would overwrite it
+	static void ResolveAutoMips()
+	{
+		std::set<const ShaderToyBuffer*> mipWriters;
+		const std::vector<ShaderToyRenderPass*>& passes = GetPasses();
+		for (uint32 i = 0; i < passes.size(); i++) {
+			const ShaderToyRenderPass* pass = passes[i];
+			for (uint32 j = 0; j < pass->m_outputs.size(); j++)
+				if (pass->m_outputs[j].m_buffer && pass->m_outputs[j].m_mipIndex > 0)
+					mipWriters.insert(pass->m_outputs[j].m_buffer);
+		#if SUPPORT_IMAGES
+			for (uint32 j = 0; j < pass->m_images.size(); j++)
+				if (pass->m_images[j].m_buffer && pass->m_images[j].m_mipIndex > 0 && pass->m_images[j].m_access != GL_READ_ONLY)
+					mipWriters.insert(pass->m_images[j].m_buffer);
+		#endif // SUPPORT_IMAGES
+		}
+		std::map<std::string,ShaderToyBuffer*>& m = ShaderToyBuffer::GetMap();
+		for (auto it = m.begin(); it != m.end(); ++it) {
+			ShaderToyBuffer::Desc& desc = it->second->m_desc;
+			if (desc.m_autoMipsDefault)
+				desc.m_autoMips = mipWriters.find(it->second) == mipWriters.end();
+		}
+	}
+
+	static uint32 GetResolution(float res, uint32 resViewport)
+	{
+		if (res > 0.0f) // explicit resolution
+			return (uint32)Ceiling(res);
+		else if (res < 0.0f) // proportional to viewport
+			return (uint32)Ceiling(-res*(float)resViewport);
+		else // viewport
+			return resViewport;
+	}
+	
+	void Render()
+	{
+		if (m_programID != 0) {
+			bool profile = g_Profile;
+		#if SUPPORT_TRACE
+			profile |= Trace::IsEnabled(); // for the GPU row
+		#endif // SUPPORT_TRACE
+			if (profile) { // results come back a few frames late, so this never waits on the GPU
+				PollProfile();
+				GLenum statisticTarget = GL_NONE;
+				if (g_PipelineStatistics)
+					statisticTarget = m_isCompute ? GL_COMPUTE_SHADER_INVOCATIONS_ARB : GL_FRAGMENT_SHADER_INVOCATIONS_ARB;
+				m_profileTimer.Begin(0, statisticTarget);
+			}
+			if (m_memoryBarrierBits)
+				glMemoryBarrier(m_memoryBarrierBits);
+			glUseProgram(m_programID);
+			if (g_Frame == 0) { // restarted, like iFrame
+				m_numSamples = 0;
+				m_sampleFrame = m_prevSampleFrame = -1;
+				m_sampleInProgress = false;
+				m_nextTile = 0;
+			}
+			if (IsTiled())
+				RenderTiles();
+			else {
+				const uint32 numIterations = GetNumIterations();
+				const bool timed = m_iterationBudgetMs > 0.0f;
+				if (timed)
+					m_iterationTimer.Begin(numIterations);
+				for (uint32 iteration = 0; iteration < numIterations; iteration++) {
+					if (iteration > 0 && m_iterationBarrierBits) // later iterations see the earlier ones' image writes
+						glMemoryBarrier(m_iterationBarrierBits);
+					RenderIteration(iteration, numIterations, iteration == 0);
+					FinishOutputs();
+				}
+				if (timed)
+					m_iterationTimer.End();
+			}
+			if (profile)
+				m_profileTimer.End();
+		}
+	}
+
+	void PollProfile() // adds the measurements which have come back since the last call
+	{
+		if (m_profileTimer.Poll()) {
+			m_profileMs.Add(m_profileTimer.GetLastMs());
+			m_profileInvocations.Add((double)m_profileTimer.GetLastCount());
+			m_profileSamples++;
+			if (!g_Benchmark.m_runPath.empty())
+				m_benchmarkMs.push_back(m_profileTimer.GetLastMs());
+		#if SUPPORT_TRACE
+			Trace::AddGPUEvent(GetFileName(), m_profileTimer.GetLastBeginNs(), m_profileTimer.GetLastEndNs());
+		#endif // SUPPORT_TRACE
+		}
+	}
+
+	// ctrl+P toggles it, see DisplayFunc
+	static void DrawProfileOverlay(uint32 viewportWidth, uint32 viewportHeight)
+	{
+		const std::vector<ShaderToyRenderPass*>& passes = GetPasses();
+		std::vector<std::string> lines;
+		lines.push_back(varString("%-3s %-32s %8s %8s %8s %10s", "#", "pass", "avg ms", "min ms", "max ms", g_PipelineStatistics ? "invocs" : ""));
+		double totalMs = 0.0;
+		for (uint32 i = 0; i < passes.size(); i++) {
+			const ShaderToyRenderPass* pass = passes[i];
+			std::string line = varString("%-3u %-32.32s %8.3f %8.3f %8.3f", pass->m_passIndex, pass->GetFileName(), pass->m_profileMs.GetAverage(), pass->m_profileMs.GetMin(), pass->m_profileMs.GetMax());
+			if (g_PipelineStatistics)
+				line += varString(" %9.3fM", pass->m_profileInvocations.GetAverage()/1000000.0);
+			lines.push_back(line);
+			totalMs += pass->m_profileMs.GetAverage();
+		}
+		lines.push_back(varString("%-3s %-32s %8.3f", "", "total", totalMs));
+		if (g_DynamicResolution.IsEnabled())
+			lines.push_back(varString("render scale %.2f (%ux%u), frame %.2f ms, budget %.2f ms", g_RenderScale, GetRenderWidth(), GetRenderHeight(), g_DynamicResolution.GetMs(), g_DynamicResolution.GetBudgetMs()));
+		uint32 numColumns = 0;
+		for (uint32 i = 0; i < lines.size(); i++) {
+			TextOverlay::Print(1, i + 1, lines[i].c_str());
+			numColumns = Max((uint32)lines[i].size() + 2, numColumns);
+		}
+		TextOverlay::Render(viewportWidth, viewportHeight, numColumns, (uint32)lines.size() + 2);
+	}
+
+	// ctrl+shift+P, and at the end of -offline. .json writes an array of objects, anything else is csv
+	static bool DumpProfile(const char* path)
+	{
+		FILE* file = fopen(path, "w");
+		if (file == nullptr) {
+			fprintf(stderr, "failed to write profile to %s\n", path);
+			return false;
+		}
+		const std::vector<ShaderToyRenderPass*>& passes = GetPasses();
+		const char* ext = strrchr(path, '.');
+		const bool json = ext && stricmp(ext, ".json") == 0;
+		if (json)
+			fprintf(file, "[\n");
+		else
+			fprintf(file, "pass,file,samples,avg_ms,min_ms,max_ms,avg_invocations,min_invocations,max_invocations\n");
+		for (uint32 i = 0; i < passes.size(); i++) {
+			const ShaderToyRenderPass* pass = passes[i];
+			const RollingStats& ms = pass->m_profileMs;
+			const RollingStats& invocations = pass->m_profileInvocations;
+			if (json) {
+				fprintf(file, "\t{\"pass\": %u, \"file\": \"%s\", \"samples\": %u, ", pass->m_passIndex, pass->GetFileName(), ms.GetNumSamples());
+				fprintf(file, "\"avg_ms\": %f, \"min_ms\": %f, \"max_ms\": %f", ms.GetAverage(), ms.GetMin(), ms.GetMax());
+				if (g_PipelineStatistics)
+					fprintf(file, ", \"avg_invocations\": %.0f, \"min_invocations\": %.0f, \"max_invocations\": %.0f", invocations.GetAverage(), invocations.GetMin(), invocations.GetMax());
+				fprintf(file, "}%s\n", i + 1 < passes.size() ? "," : "");
+			} else {
+				fprintf(file, "%u,%s,%u,%f,%f,%f", pass->m_passIndex, pass->GetFileName(), ms.GetNumSamples(), ms.GetAverage(), ms.GetMin(), ms.GetMax());
+				if (g_PipelineStatistics)
+					fprintf(file, ",%.0f,%.0f,%.0f\n", invocations.GetAverage(), invocations.GetMin(), invocations.GetMax());
+				else
+					fprintf(file, ",,,\n");
+			}
+		}
+		if (json)
+			fprintf(file, "]\n");
+		fclose(file);
+		printf("wrote profile for %u passes to %s\n", (uint32)passes.size(), path);
+		return true;
+	}
+
+	// $TILES / $TIME_SLICE: renders the next tiles of the outputs' back textures, scissored, and only swaps once the
+	// last one is done - so readers keep seeing the previous complete image, and no single frame has to wait for all of it.
+	// iFrame keeps counting frames, so a pass that accumulates has to count its images instead: iSample is the image
+	// index and iPrevSampleFrame the frame the previous image started on, the same for every tile of the image
+	void RenderTiles()
+	{
+		const PassOutput& output = m_outputs[0];
+		const uint32 w = Max(1U, output.m_buffer->m_res[0] >> output.m_mipIndex);
+		const uint32 h = Max(1U, output.m_buffer->m_res[1] >> output.m_mipIndex);
+		if (m_tileRes[0] != w || m_tileRes[1] != h) { // resized, start the image over
+			m_tileRes[0] = w;
+			m_tileRes[1] = h;
+			m_nextTile = 0;
+			m_sampleInProgress = false; // the new image starts this frame
+			for (uint32 i = 0; i < m_outputs.size(); i++) { // readers see the reallocated front texture until the first image is done, don't let it be garbage
+				const TextureFormatInfo info(m_outputs[i].m_buffer->m_desc.m_format);
+				glClearTexImage(m_outputs[i].m_buffer->GetTextureID(), m_outputs[i].m_mipIndex, info.m_format, info.m_type, nullptr);
+			}
+		}
+		const uint32 numTiles = m_tiles[0]*m_tiles[1];
+		uint32 count = 1;
+		if (m_timeSliceMs > 0.0f) {
+			if (m_tileTimer.Poll() && m_tileTimer.GetLastTag() > 0) {
+				const float ms = Max(0.001f, m_tileTimer.GetLastMs()/(float)m_tileTimer.GetLastTag());
+				m_msPerTile = m_msPerTile > 0.0f ? m_msPerTile*0.75f + ms*0.25f : ms; // smoothed, tiles don't all cost the same
+			}
+			if (m_msPerTile > 0.0f)
+				count = Max(1U, (uint32)(m_timeSliceMs/m_msPerTile));
+		}
+		count = Min(count, numTiles - m_nextTile);
+		if (m_timeSliceMs > 0.0f)
+			m_tileTimer.Begin(count);
+		glEnable(GL_SCISSOR_TEST);
+		for (uint32 i = 0; i < count; i++, m_nextTile++) {
+			const uint32 tx = m_nextTile%m_tiles[0];
+			const uint32 ty = m_nextTile/m_tiles[0];
+			const uint32 x0 = tx*w/m_tiles[0];
+			const uint32 y0 = ty*h/m_tiles[1];
+			glScissor(x0, y0, (tx + 1)*w/m_tiles[0] - x0, (ty + 1)*h/m_tiles[1] - y0);
+			RenderIteration(0, 1, i == 0);
+		}
+		glDisable(GL_SCISSOR_TEST); // restore
+		if (m_timeSliceMs > 0.0f)
+			m_tileTimer.End();
+		if (m_nextTile == numTiles) {
+			m_nextTile = 0;
+			FinishOutputs();
+		}
+	}
+
+	void FinishOutputs() // after the outputs (and images) are completely written
+	{
+		m_numSamples++;
+		m_sampleInProgress = false;
+	#if SUPPORT_IMAGES
+		bool imageBarrier = false;
+		for (uint32 i = 0; i < m_images.size(); i++) {
+			const PassImage& image = m_images[i];
+			if (image.m_buffer && image.m_buffer->m_desc.m_autoMips && image.m_mipIndex == 0 && image.m_access != GL_READ_ONLY) {
+				if (!imageBarrier) { // glGenerateMipmap reads mip 0 through the texture path
+					glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT);
+					imageBarrier = true;
+				}
+				image.m_buffer->GenerateMips(image.m_buffer->GetTextureID());
+			}
+		}
+	#endif // SUPPORT_IMAGES
+		for (uint32 i = 0; i < m_outputs.size(); i++) {
+			const PassOutput& output = m_outputs[i];
+			if (output.m_buffer && output.m_buffer->m_desc.m_autoMips && output.m_mipIndex == 0)
+				output.m_buffer->GenerateMips(output.m_pingPong ? output.m_buffer->GetBackTextureID() : output.m_buffer->GetTextureID());
+			if (output.m_pingPong)
+				output.m_buffer->Swap(); // later passes (and this pass next frame) read what was just written
+		}
+	}
+
+	void RenderIteration(uint32 iteration, uint32 numIterations, bool firstDraw) // firstDraw is the first draw of the frame
+	{
+		uint32 dispatchSize[3] = {0, 0, 0};
+		if (m_isCompute)
+			GetDispatchSize(dispatchSize); // no framebuffer
+		else if (m_outputs.size() > 0) {
+			// ping-pong outputs render to their back texture, so there is one framebuffer per side
+			uint32 side = 0;
+			for (uint32 i = 0; i < m_outputs.size(); i++) {
+				if (m_outputs[i].m_pingPong) {
+					side = m_outputs[i].m_buffer->m_front^1;
+					break;
+				}
+			}
+			GLuint& framebufferID = m_outputFramebufferIDs[side];
+			if (framebufferID == 0) {
+				glGenFramebuffers(1, &framebufferID);
+				glBindFramebuffer(GL_FRAMEBUFFER, framebufferID);
+				std::vector<GLenum> attachments(m_outputs.size());
+				for (uint32 i = 0; i < m_outputs.size(); i++) {
+					const PassOutput& output = m_outputs[i];
+					attachments[i] = GL_COLOR_ATTACHMENT0 + i;
+					if (output.m_buffer) {
+						const GLuint textureID = output.m_pingPong ? output.m_buffer->m_textureIDs[side] : output.m_buffer->GetTextureID();
+						if (output.m_buffer->m_target == GL_TEXTURE_2D_ARRAY ||
+							output.m_buffer->m_target == GL_TEXTURE_2D_MULTISAMPLE_ARRAY ||
+							output.m_buffer->m_target == GL_TEXTURE_CUBE_MAP ||
+							output.m_buffer->m_target == GL_TEXTURE_CUBE_MAP_ARRAY ||
+							output.m_buffer->m_target == GL_TEXTURE_3D)
+							glFramebufferTextureLayer(GL_FRAMEBUFFER, attachments[i], textureID, output.m_mipIndex, output.m_layerOrSliceIndex);
+						else
+							glFramebufferTexture(GL_FRAMEBUFFER, attachments[i], textureID, output.m_mipIndex);
+					} else
+						glFramebufferTexture(GL_FRAMEBUFFER, attachments[i], 0, 0);
+				}
+				glDrawBuffers((GLsizei)m_outputs.size(), attachments.data());
+			} else
+				glBindFramebuffer(GL_FRAMEBUFFER, framebufferID);
+			glViewport(0, 0, m_outputs[0].m_buffer->m_res[0], m_outputs[0].m_buffer->m_res[1]);
+		} else {
+			glBindFramebuffer(GL_FRAMEBUFFER, GetFinalFramebufferID());
+			glViewport(0, 0, GetRenderWidth(), GetRenderHeight());
+		}
+		const float pixelAspect = 1.0f;
+		ShaderToyPassUniforms passUniforms;
+		memset(&passUniforms, 0, sizeof(passUniforms));
+		if (m_isCompute) {
+			passUniforms.iOutputResolution[0] = (float)dispatchSize[0];
+			passUniforms.iOutputResolution[1] = (float)dispatchSize[1];
+			passUniforms.iOutputResolution[2] = (float)dispatchSize[2];
+		} else if (m_outputs.size() > 0) {
+			passUniforms.iOutputResolution[0] = (float)m_outputs[0].m_buffer->m_res[0];
+			passUniforms.iOutputResolution[1] = (float)m_outputs[0].m_buffer->m_res[1];
+			passUniforms.iOutputResolution[2] = (float)m_outputs[0].m_buffer->m_res[2];
+		} else {
+			passUniforms.iOutputResolution[0] = (float)GetRenderWidth();
+			passUniforms.iOutputResolution[1] = (float)GetRenderHeight();
+			passUniforms.iOutputResolution[2] = pixelAspect;
+		}
+		for (uint32 inputIndex = 0; inputIndex < m_inputs.size(); inputIndex++) {
+			const PassInput& input = m_inputs[inputIndex];
+			const ShaderToyBuffer* buffer = input.m_buffer;
+			if (buffer) {
+				BindTextureTarget(m_uniforms.m_iChannel[inputIndex], buffer->GetTextureID(), buffer->m_target, inputIndex);
+				const uint32 numLayersOrSlices = buffer->m_desc.m_resolutionZ > 1 ? buffer->m_res[2] : buffer->m_desc.m_numLayers;
+				passUniforms.iChannelResolution[inputIndex][0] = (float)buffer->m_res[0];
+				passUniforms.iChannelResolution[inputIndex][1] = (float)buffer->m_res[1];
+				passUniforms.iChannelResolution[inputIndex][2] = numLayersOrSlices > 1 ? (float)numLayersOrSlices : pixelAspect;
+			}
+		}
+		if (firstDraw) // same for every iteration (or tile), and the slot is only written once per frame
+			ShaderToyUniformBuffer::SetPass(m_passIndex, passUniforms);
+		m_uniforms.m_iPass.Set1i((int)iteration);
+		m_uniforms.m_iPassCount.Set1i((int)numIterations);
+		if (!m_sampleInProgress) { // first draw (iteration or tile) of the next sample
+			m_prevSampleFrame = m_sampleFrame;
+			m_sampleFrame = (int)g_Frame;
+			m_sampleInProgress = true;
+		}
+		m_uniforms.m_iSample.Set1i((int)m_numSamples);
+		m_uniforms.m_iPrevSampleFrame.Set1i(m_prevSampleFrame);
+		#if SUPPORT_IMAGES
+		for (uint32 imageIndex = 0; imageIndex < m_images.size(); imageIndex++) {
+			const PassImage& image = m_images[imageIndex];
+			const ShaderToyBuffer* buffer = image.m_buffer;
+			if (buffer) {
+				glBindImageTexture(imageIndex, buffer->GetTextureID(), image.m_mipIndex, image.m_layered ? GL_TRUE : GL_FALSE, image.m_layerOrSliceIndex, image.m_access, image.m_internalFormat);
+			}
+		}
+		#endif // SUPPORT_IMAGES
+		#if USE_GUI
+		if (firstDraw)
+			GUISlider::SetUniformsForPass(m_passIndex, m_uniforms.m_sliders, m_uniforms.m_sliderChanged);
+		#endif // USE_GUI
+		if (m_isCompute)
+			glDispatchCompute((dispatchSize[0] + m_localSize[0] - 1)/m_localSize[0], (dispatchSize[1] + m_localSize[1] - 1)/m_localSize[1], (dispatchSize[2] + m_localSize[2] - 1)/m_localSize[2]);
+		else
+			glDrawArrays(GL_TRIANGLES, 0, 3); // fullscreen triangle, see shadertoy_vertex.glsl
+	}
+
+	static GLuint& GetFinalFramebufferID() // passes with no outputs render here
+	{
+		static GLuint framebufferID = 0;
+		return framebufferID;
+	}
+
+	// the final image at render scale, RenderAll upscales it to the default framebuffer
+	static GLuint GetScaledFramebufferID(uint32 w, uint32 h)
+	{
+		static GLuint framebufferID = 0;
+		static GLuint renderbufferID = 0;
+		static uint32 res[2] = {0, 0};
+		if (res[0] != w || res[1] != h) {
+			if (framebufferID == 0) {
+				glGenFramebuffers(1, &framebufferID);
+				glGenRenderbuffers(1, &renderbufferID);
+			}
+			glBindRenderbuffer(GL_RENDERBUFFER, renderbufferID);
+			glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, w, h);
+			glBindRenderbuffer(GL_RENDERBUFFER, 0);
+			glBindFramebuffer(GL_FRAMEBUFFER, framebufferID);
+			glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbufferID);
+			res[0] = w;
+			res[1] = h;
+		}
+		return framebufferID;
+	}
+
+	static void RenderAll()
+	{
+		TRACE_SCOPE("RenderAll");
+		std::vector<ShaderToyRenderPass*>& passes = GetPasses();
+		g_DynamicResolution.Update(); // before the buffers are sized for this frame
+		const uint32 renderWidth = GetRenderWidth();
+		const uint32 renderHeight = GetRenderHeight();
+		const bool scaled = renderWidth != g_ViewportWidth || renderHeight != g_ViewportHeight;
+		GetFinalFramebufferID() = scaled ? GetScaledFramebufferID(renderWidth, renderHeight) : g_DefaultFramebufferID;
+		ShaderToyBuffer::UpdateAll();
+		uint32 numPassSlots = 0;
+		for (uint32 i = 0; i < passes.size(); i++)
+			numPassSlots = Max(passes[i]->m_passIndex + 1, numPassSlots);
+		ShaderToyUniformBuffer::BeginFrame(numPassSlots);
+		static GLuint emptyVertexArrayID = 0; // core profile requires a bound VAO even though the vertex shader has no inputs
+		if (emptyVertexArrayID == 0)
+			glGenVertexArrays(1, &emptyVertexArrayID);
+		glBindVertexArray(emptyVertexArrayID);
+		g_DynamicResolution.BeginFrame();
+		for (uint32 i = 0; i < passes.size(); i++) {
+			TRACE_SCOPE_DETAIL("Render", passes[i]->GetFileName());
+			passes[i]->Render();
+		}
+		g_DynamicResolution.EndFrame();
+		if (scaled) { // upscale to the window
+			glBindFramebuffer(GL_READ_FRAMEBUFFER, GetFinalFramebufferID());
+			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, g_DefaultFramebufferID);
+			glBlitFramebuffer(0, 0, renderWidth, renderHeight, 0, 0, g_ViewportWidth, g_ViewportHeight, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+		}
+		ShaderToyUniformBuffer::EndFrame();
+		GetCaptureQueue().Poll();
+		glBindVertexArray(0); // restore
+		glBindFramebuffer(GL_FRAMEBUFFER, g_DefaultFramebufferID); // restore
+		glUseProgram(0); // restore
+	#if USE_GUI
+		g_GUISliderChanged = false;
+	#endif // USE_GUI
+		if (g_ReportUniformCalls) { // only reports when the numbers change, e.g. while dragging a slider
+			static UniformCallCounter prev;
+			if (g_UniformCallsThisFrame != prev) {
+				const uint32 r = g_UniformCallsThisFrame.m_requested;
+				printf("frame %u: %u glUniform calls (uncached estimate: %u glUniform + %u glGetUniformLocation)\n", g_Frame, g_UniformCallsThisFrame.m_issued, r, r);
+				prev = g_UniformCallsThisFrame;
+			}
+		}
+		g_UniformCallsThisFrame = UniformCallCounter();
+	}
+
+	static std::vector<ShaderToyRenderPass*>& GetPasses()
+	{
+		static std::vector<ShaderToyRenderPass*> passes;
+		return passes;
+	}
+
+	uint32 m_passIndex;
+	std::string m_path;
+	GLuint m_programID;
+	std::vector<std::string> m_samplerHeader; // generated from the metadata, see LoadPass
+	std::vector<std::string> m_sourceFooter;
+	std::vector<std::string> m_sourceFiles; // files the program was built from (not including the common header)
+	std::vector<PassInput> m_inputs;
+	std::vector<PassOutput> m_outputs; // multiple outputs for MRT
+#if SUPPORT_IMAGES
+	std::vector<PassImage> m_images;
+#endif // SUPPORT_IMAGES
+	GLuint m_outputFramebufferIDs[2]; // indexed by the back side of the ping-pong outputs (only [0] is used if there are none)
+	PassUniforms m_uniforms;
+	GLbitfield m_memoryBarrierBits; // issued before this pass, see BuildDependencyGraph
+	bool m_isCompute; // $COMPUTE pass, see SetCompute
+	uint32 m_localSize[3];
+	uint32 m_dispatchSize[3]; // in threads, if there's no dispatch buffer
+	std::string m_dispatchBufferName;
+	const ShaderToyBuffer* m_dispatchBuffer; // dispatch covers this buffer's resolution (and layers or slices)
+	uint32 m_iterations; // per frame, see SetIterations
+	uint32 m_minIterations;
+	uint32 m_maxIterations;
+	float m_iterationBudgetMs; // if >0, m_iterations adapts to fit this GPU time
+	float m_msPerIteration;
+	GPUTimer m_iterationTimer;
+	GLbitfield m_iterationBarrierBits; // issued between iterations if the pass writes images
+	uint32 m_numSamples; // times the outputs were completely written since iFrame 0, see iSample
+	int m_sampleFrame; // iFrame when the sample in progress (or the last one) started
+	int m_prevSampleFrame; // iFrame when the one before that started, see iPrevSampleFrame
+	bool m_sampleInProgress;
+	uint32 m_tiles[2]; // $TILES grid, 1x1 if the pass isn't tiled
+	float m_timeSliceMs; // $TIME_SLICE, if >0 as many tiles as fit in this GPU time are rendered per frame (otherwise one)
+	uint32 m_nextTile; // tiles of the image in progress rendered so far
+	uint32 m_tileRes[2]; // output resolution the image in progress was started at
+	float m_msPerTile;
+	GPUTimer m_tileTimer;
+	GPUTimer m_profileTimer; // -profile
+	RollingStats m_profileMs;
+	RollingStats m_profileInvocations; // fragment (or compute) shader invocations
+	uint32 m_profileSamples; // total, not just the ones in the rolling window
+	std::vector<float> m_benchmarkMs; // every sample, see RunBenchmark
+};
+
+// -capture, called after RenderAll. captures layer 0 mip 0 of each named buffer (or the final image) every K'th frame
+static uint32 CaptureFrame()
+{
+	OfflineRenderSettings& settings = g_Offline;
+	if (!settings.m_capture || g_Frame < settings.m_startFrame || (g_Frame - settings.m_startFrame)%settings.m_captureEvery != 0)
+		return 0;
+	static bool once = true;
+	if (once) {
+		once = false;
+		if (!CreateDirectoryIfMissing(settings.m_captureDir.c_str()))
+			fprintf(stderr, "failed to create capture directory \"%s\"\n", settings.m_captureDir.c_str());
+	}
+	uint32 numCaptured = 0;
+	for (uint32 i = 0; i < settings.m_captureNames.size(); i++) {
+		const char* name = settings.m_captureNames[i].c_str();
+		const std::string path = varString("%s/%s_%05u.%s", settings.m_captureDir.c_str(), name, g_Frame, settings.m_captureExt.c_str());
+		if (strcmp(name, "final") == 0) {
+			glBindFramebuffer(GL_READ_FRAMEBUFFER, g_DefaultFramebufferID);
+			glReadBuffer(g_DefaultFramebufferID ? GL_COLOR_ATTACHMENT0 : GL_BACK);
+			QueueCapture(path, g_ViewportWidth, g_ViewportHeight, DDS_DXGI_FORMAT_R8G8B8A8_UNORM);
+			numCaptured++;
+		} else {
+			const ShaderToyBuffer* buffer = ShaderToyBuffer::Find(name);
+			if (buffer && buffer->Capture(0, 0, path.c_str()))
+				numCaptured++;
+			else {
+				if (buffer == nullptr)
+					fprintf(stderr, "can't capture buffer \"%s\", no such buffer\n", name);
+				settings.m_captureNames.erase(settings.m_captureNames.begin() + i--);
+			}
+		}
+	}
+	return numCaptured;
+}
+
+static void DisplayFunc()
+{
+	TRACE_SCOPE("DisplayFunc");
+	g_Keyboard.Update();
+#if USE_GUI
+	if (g_GUIFrame)
+		GUI::Idle(&g_Keyboard);
+#endif // USE_GUI
+
+	static bool once = true;
+	if (once) {
+		once = false;
+		ShaderToyRenderPass::LoadShaders(g_ShadersDir.c_str());
+	} else
+		ShaderToyRenderPass::ReloadChangedPasses();
+	UpdateFrameTime();
+	glViewport(0, 0, g_ViewportWidth, g_ViewportHeight);
+	glDisable(GL_BLEND);
+	ShaderToyRenderPass::RenderAll();
+	CaptureFrame();
+
+#if USE_GUI
+	if (g_GUIFrame) {
+		TRACE_SCOPE("GUI::RenderWindow");
+		GUI::RenderBegin(0, 0, g_ViewportWidth, g_ViewportHeight);
+		GUI::RenderWindow();
+	}
+#endif // USE_GUI
+	if (g_Profile) {
+		if (g_Keyboard.IsKeyPressed('P', Keyboard::MODIFIER_CONTROL))
+			g_ProfileOverlay = !g_ProfileOverlay;
+		if (g_Keyboard.IsKeyPressed('P', Keyboard::MODIFIER_CONTROL | Keyboard::MODIFIER_SHIFT))
+			ShaderToyRenderPass::DumpProfile(g_ProfileDumpPath.c_str());
+		if (g_ProfileOverlay)
+			ShaderToyRenderPass::DrawProfileOverlay(g_ViewportWidth, g_ViewportHeight);
+	}
+
+	g_Frame++;
+	{
+		TRACE_SCOPE("glutSwapBuffers");
+		glutSwapBuffers();
+	}
+#if SUPPORT_TRACE
+	if (g_Frame == g_TraceEndFrame && Trace::IsEnabled())
+		Trace::Write(g_TracePath.c_str());
+#endif // SUPPORT_TRACE
+	glutPostRedisplay();
+}
+
+static void MouseFunc(int button, int state, int x, int y)
+{
+	if (g_GUIFrame && GUI::MouseButton(button, state, x, y, g_Keyboard.GetModifiers()))
+		return;
+
+	g_MouseWheelState = 0;
+	int buttonID = -1;
+	switch (button) {
+	case GLUT_LEFT_BUTTON: buttonID = 0; break;
+	case GLUT_RIGHT_BUTTON: buttonID = 1; break;
+	case GLUT_MIDDLE_BUTTON: buttonID = 2; break;
+	}
+	if (state == GLUT_DOWN) {
+		if (button == 3)
+			g_MouseWheelState = +1;
+		else if (button == 4)
+			g_MouseWheelState = -1;
+		else if (buttonID != -1)
+			g_MouseButtonState[buttonID] = true;
+	} else if (state == GLUT_UP) {
+		if (buttonID != -1)
+			g_MouseButtonState[buttonID] = false;
+	}
+
+	x = Clamp(x, 0, g_ViewportWidth - 1);
+	y = Clamp(g_ViewportHeight - 1 - y, 0, g_ViewportHeight - 1);
+	if (g_MouseButtonState[0]) {
+		if (button == GLUT_LEFT_BUTTON && state == GLUT_DOWN) {
+			g_MouseDragStart[0] = x;
+			g_MouseDragStart[1] = y;
+		}
+		g_MouseDragCurr[0] = x;
+		g_MouseDragCurr[1] = y;
+	} else {
+		g_MouseDragStart[0] = 0;
+		g_MouseDragStart[1] = 0;
+	}
+}
+
+static void MotionFunc(int x, int y)
+{
+	if (g_GUIFrame && GUI::MouseMotion(x, y))
+		return;
+
+	if (g_MouseButtonState[0]) {
+		g_MouseDragCurr[0] = x;
+		g_MouseDragCurr[1] = g_ViewportHeight - 1 - y;
+	}
+}
+
+static void VisibilityFunc(int vis)
+{
+}
+
+static void CloseFunc() // the window is closing and glutMainLoop will exit - the context is still current here
+{
+	GetCaptureQueue().Flush(); // otherwise captures still in flight are lost
+#if SUPPORT_TRACE
+	if (Trace::IsEnabled())
+		Trace::Write(g_TracePath.c_str()); // quit before -trace_frames
+#endif // SUPPORT_TRACE
+}
+
+static void SaveStandardTextures()
+{
+	// noise
+	{
+		uint32 w = 256;
+		uint32 h = 256;
+		Vec4V* image = new Vec4V[w*h];
+		for (uint32 i = 0; i < w*h; i++) {
+			image[i].xf_ref() = GetRandomValue();
+			image[i].yf_ref() = GetRandomValue();
+			image[i].zf_ref() = GetRandomValue();
+			image[i].wf_ref() = GetRandomValue();
+		}
+		SaveImage("textures/RGBA_NOISE_MEDIUM.tga", image, w, h);
+		delete[] image;
+	}
+
+	// permutation
+	{
+		typedef uint16 PixelType;
+		const uint32 n = 2048;
+		PixelType* image = new PixelType[n*n];
+		memset(image, 0, n*n*sizeof(PixelType));
+		for (uint32 j = 0; j < n; j++) {
+			std::vector<PixelType> x(j + 1);
+			for (uint32 i = 0; i <= j; i++)
+				x[i] = (PixelType)i;
+			std::random_shuffle (x.begin(), x.end());
+			memcpy(image + j*n, x.data(), (j + 1)*sizeof(PixelType));
+		}
+		SaveImage("textures/PERMUTATION.dds", image, n, n, false, true); // save native R16_UNORM
+		delete[] image;
+	}
+}
+
+// replaces the default framebuffer (see g_DefaultFramebufferID) with an offscreen RGBA8 renderbuffer, for -headless
+// and -offline - the output resolution then doesn't depend on the window
+static void CreateOffscreenFramebuffer(uint32 w, uint32 h)
+{
+	GLuint renderbufferID = 0;
+	glGenRenderbuffers(1, &renderbufferID);
+	glBindRenderbuffer(GL_RENDERBUFFER, renderbufferID);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, w, h);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+	glGenFramebuffers(1, &g_DefaultFramebufferID);
+	glBindFramebuffer(GL_FRAMEBUFFER, g_DefaultFramebufferID);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbufferID);
+	const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	if (status != GL_FRAMEBUFFER_COMPLETE)
+		fprintf(stderr, "offscreen framebuffer is not complete (status 0x%04x)\n", status);
+}
+
+// renders frames [0,end) without an event loop, capturing every K'th frame in [start,end) - used by -headless and
+// -offline. with a window, each frame is also blitted to it as a preview
+// -bake: loads the passes, which decodes their image textures and rebakes them all (see LoadImageJob), and exits
+// without rendering anything
+static int BakeTextures()
+{
+	if (!g_TextureBakeCache) {
+		fprintf(stderr, "-bake needs the texture bake cache, remove -no_texture_cache\n");
+		return -1;
+	}
+	const uint64 startTime = ProgressDisplay::GetCurrentPerformanceTime();
+	ShaderToyRenderPass::LoadShaders(g_ShadersDir.c_str());
+	ShaderToyBuffer::WaitForPendingLoads();
+	printf("baked %u textures in %.3f secs\n", (uint32)g_NumTexturesBaked, ProgressDisplay::GetTimeInSeconds(startTime));
+	return 0;
+}
+
+static int RunOffline()
+{
+	const OfflineRenderSettings& settings = g_Offline;
+	CreateOffscreenFramebuffer(g_ViewportWidth, g_ViewportHeight);
+	ShaderToyRenderPass::LoadShaders(g_ShadersDir.c_str());
+	ShaderToyBuffer::WaitForPendingLoads();
+	uint32 numCaptured = 0;
+	glFinish();
+	printf("rendering frames %u..%u at %ux%u", settings.m_startFrame, settings.m_endFrame, g_ViewportWidth, g_ViewportHeight);
+	if (g_FixedTimeDelta > 0.0f)
+		printf(", dt=%f", g_FixedTimeDelta);
+	printf(" ..\n");
+	const uint64 startTime = ProgressDisplay::GetCurrentPerformanceTime();
+	while (g_Frame < settings.m_endFrame) {
+		TRACE_SCOPE("frame");
+		UpdateFrameTime();
+		glViewport(0, 0, g_ViewportWidth, g_ViewportHeight);
+		glDisable(GL_BLEND);
+		ShaderToyRenderPass::RenderAll();
+		numCaptured += CaptureFrame();
+		if (!g_Headless) {
+			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+			glBlitFramebuffer(0, 0, g_ViewportWidth, g_ViewportHeight, 0, 0, g_ViewportWidth, g_ViewportHeight, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, g_DefaultFramebufferID); // restore
+			glutSwapBuffers();
+		}
+		g_Frame++;
+	}
+	GetCaptureQueue().Flush();
+	glFinish();
+	const float secs = ProgressDisplay::GetTimeInSeconds(startTime);
+	const uint32 numFrames = settings.m_endFrame;
+	printf("rendered %u frames in %.3f secs (%.3f ms/frame)", numFrames, secs, numFrames > 0 ? 1000.0f*secs/(float)numFrames : 0.0f);
+	if (settings.m_capture)
+		printf(", captured %u to %s", numCaptured, settings.m_captureDir.c_str());
+	printf("\n");
+	if (g_Profile)
+		ShaderToyRenderPass::DumpProfile(g_ProfileDumpPath.c_str());
+#if SUPPORT_TRACE
+	if (Trace::IsEnabled())
+		Trace::Write(g_TracePath.c_str());
+#endif // SUPPORT_TRACE
+	return 0;
+}
+
+// -capture_bench: frame time impact of capturing the -capture buffers (default the final image) every frame. the
+// render thread time is what capture must not hurt - the disk writes happen on workers and are reported separately
+static int CaptureBenchmark(uint32 numFrames)
+{
+	OfflineRenderSettings& settings = g_Offline;
+	CreateOffscreenFramebuffer(g_ViewportWidth, g_ViewportHeight);
+	ShaderToyRenderPass::LoadShaders(g_ShadersDir.c_str());
+	ShaderToyBuffer::WaitForPendingLoads();
+	settings.m_startFrame = 0;
+	settings.m_captureEvery = 1;
+	for (uint32 i = 0; i < 10; i++) { // warm up
+		UpdateFrameTime();
+		ShaderToyRenderPass::RenderAll();
+		g_Frame++;
+	}
+	glFinish();
+	float avgMs[2] = {0.0f, 0.0f};
+	for (uint32 run = 0; run < 2; run++) {
+		settings.m_capture = (run == 1);
+		float maxMs = 0.0f;
+		uint32 numCaptured = 0;
+		const uint64 runTime = ProgressDisplay::GetCurrentPerformanceTime();
+		for (uint32 i = 0; i < numFrames; i++) {
+			const uint64 frameTime = ProgressDisplay::GetCurrentPerformanceTime();
+			UpdateFrameTime();
+			glViewport(0, 0, g_ViewportWidth, g_ViewportHeight);
+			glDisable(GL_BLEND);
+			ShaderToyRenderPass::RenderAll();
+			numCaptured += CaptureFrame();
+			maxMs = Max(1000.0f*ProgressDisplay::GetTimeInSeconds(frameTime), maxMs);
+			g_Frame++;
+		}
+		glFinish();
+		avgMs[run] = 1000.0f*ProgressDisplay::GetTimeInSeconds(runTime)/(float)numFrames;
+		printf("%-12s %u frames, %.3f ms/frame avg (including GPU), %.3f ms max on render thread", run == 0 ? "no capture:" : "capture:", numFrames, avgMs[run], maxMs);
+		if (run == 1) {
+			const uint64 flushTime = ProgressDisplay::GetCurrentPerformanceTime();
+			GetCaptureQueue().Flush();
+			printf(", %u captures, %.3f secs to drain writes", numCaptured, ProgressDisplay::GetTimeInSeconds(flushTime));
+		}
+		printf("\n");
+	}
+	printf("capture costs %+.3f ms/frame (%+.1f%%)\n", avgMs[1] - avgMs[0], avgMs[0] > 0.0f ? 100.0f*(avgMs[1] - avgMs[0])/avgMs[0] : 0.0f);
+	return 0;
+}
+
+static float Percentile(std::vector<float> samples, float percent) // nearest rank
+{
+	if (samples.empty())
+		return 0.0f;
+	std::sort(samples.begin(), samples.end());
+	const uint32 rank = (uint32)ceilf(percent/100.0f*(float)samples.size());
+	return samples[Clamp(rank, 1U, (uint32)samples.size()) - 1];
+}
+
+// benchmark results are written one object per line, so the baseline can be read back without a json parser - the
+// shader, resolution and pass (everything before "samples") identify the result
+static std::string GetBenchmarkResult(const char* shader, uint32 w, uint32 h, const char* pass, const std::vector<float>& samples)
+{
+	double sum = 0.0;
+	for (uint32 i = 0; i < samples.size(); i++)
+		sum += samples[i];
+	const float mean = samples.empty() ? 0.0f : (float)(sum/(double)samples.size());
+	return varString("{\"shader\": \"%s\", \"resolution\": \"%ux%u\", \"pass\": \"%s\", \"samples\": %u, \"mean_ms\": %.4f, \"p50_ms\": %.4f, \"p95_ms\": %.4f, \"p99_ms\": %.4f}",
+		shader, w, h, pass, (uint32)samples.size(), mean, Percentile(samples, 50.0f), Percentile(samples, 95.0f), Percentile(samples, 99.0f));
+}
+
+static std::string GetBenchmarkResultKey(const std::string& result)
+{
+	return result.substr(0, result.find(", \"samples\""));
+}
+
+static float GetBenchmarkResultValue(const std::string& result, const char* name)
+{
+	const std::string key = varString("\"%s\": ", name);
+	const size_t pos = result.find(key);
+	return pos != std::string::npos ? (float)atof(result.c_str() + pos + key.size()) : 0.0f;
+}
+
+static std::string GetBenchmarkResultString(const std::string& result, const char* name)
+{
+	const std::string key = varString("\"%s\": \"", name);
+	const size_t pos = result.find(key);
+	if (pos == std::string::npos)
+		return "";
+	const size_t end = result.find('"', pos + key.size());
+	return result.substr(pos + key.size(), end - (pos + key.size()));
+}
+
+static void LoadBenchmarkResults(std::vector<std::string>& results, const char* path)
+{
+	std::vector<std::string> lines;
+	LoadFileIntoStrings(lines, path);
+	for (uint32 i = 0; i < lines.size(); i++) {
+		std::string line = lines[i];
+		if (strstr(line.c_str(), "{\"shader\"") != line.c_str())
+			continue;
+		if (!line.empty() && line.back() == ',')
+			line.pop_back();
+		results.push_back(line);
+	}
+}
+
+// -bench_run (spawned by -benchmark): renders one shader directory at -res with the fixed iTime sequence, timing
+// every frame with a glFinish, and writes the frame and per-pass GPU results to the given path
+static int RunBenchmark()
+{
+	const BenchmarkSettings& settings = g_Benchmark;
+	CreateOffscreenFramebuffer(g_ViewportWidth, g_ViewportHeight);
+	ShaderToyRenderPass::LoadShaders(g_ShadersDir.c_str());
+	ShaderToyBuffer::WaitForPendingLoads();
+	const std::vector<ShaderToyRenderPass*>& passes = ShaderToyRenderPass::GetPasses();
+	if (passes.empty()) {
+		fprintf(stderr, "benchmark: no passes loaded from %s\n", g_ShadersDir.c_str());
+		return 2;
+	}
+	glFinish();
+	std::vector<float> frameMs;
+	for (uint32 i = 0; i < settings.m_warmupFrames + settings.m_frames; i++) {
+		if (i == settings.m_warmupFrames)
+			for (uint32 j = 0; j < passes.size(); j++)
+				passes[j]->m_benchmarkMs.clear();
+		const uint64 frameTime = ProgressDisplay::GetCurrentPerformanceTime();
+		UpdateFrameTime();
+		glViewport(0, 0, g_ViewportWidth, g_ViewportHeight);
+		glDisable(GL_BLEND);
+		ShaderToyRenderPass::RenderAll();
+		glFinish();
+		if (i >= settings.m_warmupFrames)
+			frameMs.push_back(1000.0f*ProgressDisplay::GetTimeInSeconds(frameTime));
+		for (uint32 j = 0; j < passes.size(); j++)
+			passes[j]->PollProfile(); // already finished, so every frame gets its sample
+		g_Frame++;
+	}
+	std::string shader = g_ShadersDir;
+	while (!shader.empty() && (shader.back() == '\\' || shader.back() == '/'))
+		shader.pop_back();
+	const size_t slash = shader.find_last_of("\\/");
+	if (slash != std::string::npos)
+		shader = shader.substr(slash + 1);
+	FILE* file = fopen(settings.m_runPath.c_str(), "w");
+	if (file == nullptr) {
+		fprintf(stderr, "benchmark: failed to write %s\n", settings.m_runPath.c_str());
+		return 2;
+	}
+	fprintf(file, "%s\n", GetBenchmarkResult(shader.c_str(), g_ViewportWidth, g_ViewportHeight, "frame", frameMs).c_str());
+	for (uint32 j = 0; j < passes.size(); j++)
+		fprintf(file, "%s\n", GetBenchmarkResult(shader.c_str(), g_ViewportWidth, g_ViewportHeight, varString("%u:%s", passes[j]->m_passIndex, passes[j]->GetFileName()).c_str(), passes[j]->m_benchmarkMs).c_str());
+	fclose(file);
+	return 0;
+}
+
+// -benchmark: runs every shader directory (those given on the command line, or each one under shaders) at every
+// -bench_res in its own process, so each run starts from clean GL state. results go to -bench_out, and if there's a
+// -bench_baseline the exit code is 1 when any p50 got slower by more than -bench_threshold percent (2 if a run failed)
+static int RunBenchmarkSuite(const char* exePath, std::vector<std::string> dirs)
+{
+	BenchmarkSettings& settings = g_Benchmark;
+	if (dirs.empty())
+		GetDirectoryEntries(nullptr, &dirs, "shaders");
+	if (settings.m_resolutions.empty())
+		settings.m_resolutions.push_back(std::make_pair(g_ViewportWidth, g_ViewportHeight));
+	const std::string runPath = PathExt(settings.m_outputPath.c_str(), "_run.txt");
+	std::vector<std::string> results;
+	bool failed = false;
+	for (uint32 d = 0; d < dirs.size(); d++) {
+		for (uint32 r = 0; r < settings.m_resolutions.size(); r++) {
+			const uint32 w = settings.m_resolutions[r].first;
+			const uint32 h = settings.m_resolutions[r].second;
+			std::string command = varString("\"%s\" \"%s\" -res=%ux%u -bench_run=\"%s\" -bench_frames=%u -bench_warmup=%u", exePath, dirs[d].c_str(), w, h, runPath.c_str(), settings.m_frames, settings.m_warmupFrames);
+			bool headless = g_Headless;
+		#if defined(__linux__)
+			headless |= getenv("DISPLAY") == nullptr && getenv("WAYLAND_DISPLAY") == nullptr; // e.g. CI on llvmpipe, there's no window to open
+		#endif
+			if (headless)
+				command += " -headless";
+			if (g_CoreProfile)
+				command += " -core";
+		#if !defined(__linux__)
+			command = "\"" + command + "\""; // cmd strips the outer quotes
+		#endif
+			printf("benchmarking %s at %ux%u, %u frames ..\n", dirs[d].c_str(), w, h, settings.m_frames);
+			fflush(stdout);
+			remove(runPath.c_str());
+			const int status = system(command.c_str());
+			const size_t numResults = results.size();
+			if (status == 0)
+				LoadBenchmarkResults(results, runPath.c_str());
+			if (results.size() == numResults) {
+				fprintf(stderr, "benchmark run failed for %s at %ux%u (status %d)\n", dirs[d].c_str(), w, h, status);
+				failed = true;
+			}
+		}
+	}
+	remove(runPath.c_str());
+
+	FILE* file = fopen(settings.m_outputPath.c_str(), "w");
+	if (file) {
+		fprintf(file, "{\"frames\": %u, \"warmup_frames\": %u, \"results\": [\n", settings.m_frames, settings.m_warmupFrames);
+		for (uint32 i = 0; i < results.size(); i++)
+			fprintf(file, "%s%s\n", results[i].c_str(), i + 1 < results.size() ? "," : "");
+		fprintf(file, "]}\n");
+		fclose(file);
+		printf("wrote %u results to %s\n", (uint32)results.size(), settings.m_outputPath.c_str());
+	} else
+		fprintf(stderr, "failed to write %s\n", settings.m_outputPath.c_str());
+
+	std::map<std::string,std::string> baseline;
+	if (!settings.m_baselinePath.empty()) {
+		std::vector<std::string> baselineResults;
+		LoadBenchmarkResults(baselineResults, settings.m_baselinePath.c_str());
+		if (baselineResults.empty())
+			fprintf(stderr, "no results in baseline %s\n", settings.m_baselinePath.c_str());
+		for (uint32 i = 0; i < baselineResults.size(); i++)
+			baseline[GetBenchmarkResultKey(baselineResults[i])] = baselineResults[i];
+	}
+	const float minGatedMs = 0.05f; // faster than this is too noisy to gate on
+	uint32 numRegressions = 0;
+	printf("%-32s %-10s %-32s %9s %9s %9s %9s %8s\n", "shader", "res", "pass", "p50 ms", "p95 ms", "p99 ms", "base p50", "change");
+	for (uint32 i = 0; i < results.size(); i++) {
+		const std::string& result = results[i];
+		const float p50 = GetBenchmarkResultValue(result, "p50_ms");
+		printf("%-32.32s %-10s %-32.32s %9.3f %9.3f %9.3f",
+			GetBenchmarkResultString(result, "shader").c_str(),
+			GetBenchmarkResultString(result, "resolution").c_str(),
+			GetBenchmarkResultString(result, "pass").c_str(),
+			p50, GetBenchmarkResultValue(result, "p95_ms"), GetBenchmarkResultValue(result, "p99_ms"));
+		const auto f = baseline.find(GetBenchmarkResultKey(result));
+		if (f != baseline.end()) {
+			const float baseP50 = GetBenchmarkResultValue(f->second, "p50_ms");
+			const float change = baseP50 > 0.0f ? 100.0f*(p50 - baseP50)/baseP50 : 0.0f;
+			printf(" %9.3f %+7.1f%%", baseP50, change);
+			if (baseP50 >= minGatedMs && change > settings.m_thresholdPercent) {
+				printf(" REGRESSION");
+				numRegressions++;
+			}
+		}
+		printf("\n");
+	}
+	if (!baseline.empty())
+		printf("%u regressions over %.1f%% against %s\n", numRegressions, settings.m_thresholdPercent, settings.m_baselinePath.c_str());
+	return failed ? 2 : numRegressions > 0 ? 1 : 0;
+}
+
+#if SUPPORT_HEADLESS
+// GL context with no visible window, for render farm nodes and CI machines. on windows glut still creates the window
+// (the context needs one) but it's hidden and never gets an event loop. on linux there's no window at all, which works
+// without a display and with mesa's llvmpipe - glew must then be built with GLEW_EGL (or GLEW_OSMESA) for glewInit to
+// find the entry points. either way rendering goes to an offscreen framebuffer (see CreateOffscreenFramebuffer)
+class HeadlessContext
+{
+public:
+	static bool Create(int argc, const char* argv[], uint32 w, uint32 h, bool coreProfile)
+	{
+	#if !defined(__linux__)
+		glutInit(&argc, (char**)argv);
+		glutInitDisplayMode(GLUT_RGBA);
+		if (coreProfile) {
+			glutInitContextVersion(4, 4);
+			glutInitContextProfile(GLUT_CORE_PROFILE);
+		}
+		glutInitWindowSize(w, h);
+		glutCreateWindow(argv[0]);
+		glutHideWindow(); // takes effect before the window is first shown, since there's no glutMainLoop
+	#elif defined(HEADLESS_OSMESA)
+		const int attribs[] = {
+			OSMESA_FORMAT, OSMESA_RGBA,
+			OSMESA_DEPTH_BITS, 0,
+			OSMESA_PROFILE, coreProfile ? OSMESA_CORE_PROFILE : OSMESA_COMPAT_PROFILE,
+			OSMESA_CONTEXT_MAJOR_VERSION, 4,
+			OSMESA_CONTEXT_MINOR_VERSION, 4,
+			0,
+		};
+		static OSMesaContext context = nullptr;
+		static std::vector<uint8> buffer; // osmesa needs a colour buffer to make the context current, even though we never render to it
+		context = OSMesaCreateContextAttribs(attribs, nullptr);
+		if (context == nullptr) {
+			fprintf(stderr, "OSMesaCreateContextAttribs failed\n");
+			return false;
+		}
+		buffer.resize(w*h*4);
+		if (!OSMesaMakeCurrent(context, buffer.data(), GL_UNSIGNED_BYTE, w, h)) {
+			fprintf(stderr, "OSMesaMakeCurrent failed\n");
+			return false;
+		}
+	#else
+		EGLDisplay display = EGL_NO_DISPLAY;
+		PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+		if (getPlatformDisplay)
+			display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+		if (display == EGL_NO_DISPLAY)
+			display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+		EGLint major = 0, minor = 0;
+		if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) {
+			fprintf(stderr, "eglInitialize failed (error 0x%04x)\n", eglGetError());
+			return false;
+		}
+		printf("EGL version %d.%d (%s)\n", major, minor, eglQueryString(display, EGL_VENDOR));
+		if (!eglBindAPI(EGL_OPENGL_API)) {
+			fprintf(stderr, "eglBindAPI(EGL_OPENGL_API) failed (error 0x%04x)\n", eglGetError());
+			return false;
+		}
+		const EGLint configAttribs[] = {
+			EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+			EGL_NONE,
+		};
+		EGLConfig config = nullptr;
+		EGLint numConfigs = 0;
+		if (!eglChooseConfig(display, configAttribs, &config, 1, &numConfigs) || numConfigs == 0)
+			config = nullptr; // EGL_NO_CONFIG_KHR, fine since we never create a surface
+		const EGLint contextAttribs[] = {
+			EGL_CONTEXT_MAJOR_VERSION, 4,
+			EGL_CONTEXT_MINOR_VERSION, 4,
+			EGL_CONTEXT_OPENGL_PROFILE_MASK, coreProfile ? EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT : EGL_CONTEXT_OPENGL_COMPATIBILITY_PROFILE_BIT,
+			EGL_NONE,
+		};
+		const EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+		if (context == EGL_NO_CONTEXT) {
+			fprintf(stderr, "eglCreateContext failed (error 0x%04x)\n", eglGetError());
+			return false;
+		}
+		if (!eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) { // requires EGL_KHR_surfaceless_context
+			fprintf(stderr, "eglMakeCurrent failed (error 0x%04x)\n", eglGetError());
+			return false;
+		}
+	#endif
+		return true;
+	}
+};
+
+#endif // SUPPORT_HEADLESS
+
+int main(int argc, const char* argv[])
+{
+	//SaveStandardTextures();
+
+	StartupMain(argc, argv);
+	std::vector<std::string> shaderDirs;
+	uint32 preprocessBenchIterations = 0;
+	uint32 mipBenchIterations = 0;
+	std::vector<std::string> mipBenchSources;
+	uint32 captureBenchFrames = 0;
+	bool benchmarkSuite = false;
+	float dynresMinScale = 0.5f;
+	for (int i = 1; i < argc; i++) {
+		const char* arg = argv[i];
+		if (arg[0] != '-') {
+			g_ShadersDir = arg;
+			shaderDirs.push_back(arg);
+		} else if (stricmp(arg, "-preprocess_bench") == 0)
+			preprocessBenchIterations = 10;
+		else if (strstr(arg, "-preprocess_bench=") == arg)
+			preprocessBenchIterations = Max(1, atoi(arg + strlen("-preprocess_bench=")));
+		else if (stricmp(arg, "-mip_bench") == 0)
+			mipBenchIterations = 5;
+		else if (strstr(arg, "-mip_bench=") == arg)
+			mipBenchIterations = Max(1, atoi(arg + strlen("-mip_bench=")));
+		else if (strstr(arg, "-mip_bench_dir=") == arg) // searched recursively, can be given more than once
+			mipBenchSources.push_back(arg + strlen("-mip_bench_dir="));
+		else if (strstr(arg, "-mip_bench_images=") == arg) { // comma separated
+			std::string images = arg + strlen("-mip_bench_images=");
+			for (size_t start = 0, end; start < images.size(); start = end + 1) {
+				end = images.find(',', start);
+				if (end == std::string::npos)
+					end = images.size();
+				if (end > start)
+					mipBenchSources.push_back(images.substr(start, end - start));
+			}
+		}
+		else if (stricmp(arg, "-report_uniforms") == 0)
+			g_ReportUniformCalls = true;
+		else if (stricmp(arg, "-profile") == 0)
+			g_Profile = true;
+		else if (strstr(arg, "-profile_dump=") == arg) {
+			g_Profile = true;
+			g_ProfileDumpPath = arg + strlen("-profile_dump=");
+		}
+		else if (strstr(arg, "-dynres=") == arg) // gpu frame time budget in ms
+			g_DynamicResolution.SetBudget((float)atof(arg + strlen("-dynres=")), dynresMinScale);
+		else if (strstr(arg, "-dynres_min=") == arg) {
+			dynresMinScale = (float)atof(arg + strlen("-dynres_min="));
+			if (g_DynamicResolution.IsEnabled())
+				g_DynamicResolution.SetBudget(g_DynamicResolution.GetBudgetMs(), dynresMinScale);
+		}
+		else if (stricmp(arg, "-benchmark") == 0)
+			benchmarkSuite = true;
+		else if (strstr(arg, "-bench_frames=") == arg)
+			g_Benchmark.m_frames = Max(1, atoi(arg + strlen("-bench_frames=")));
+		else if (strstr(arg, "-bench_warmup=") == arg)
+			g_Benchmark.m_warmupFrames = (uint32)Max(0, atoi(arg + strlen("-bench_warmup=")));
+		else if (strstr(arg, "-bench_res=") == arg) { // e.g. -bench_res=1920x1080,640x360
+			for (const char* s = arg + strlen("-bench_res="); s; s = strchr(s, ',') ? strchr(s, ',') + 1 : nullptr) {
+				uint32 w = 0, h = 0;
+				if (sscanf(s, "%ux%u", &w, &h) == 2 && w > 0 && h > 0)
+					g_Benchmark.m_resolutions.push_back(std::make_pair(w, h));
+				else
+					printf("warning: bad resolution in \"%s\", expected -bench_res=WIDTHxHEIGHT[,WIDTHxHEIGHT..]\n", arg);
+			}
+		}
+		else if (strstr(arg, "-bench_out=") == arg)
+			g_Benchmark.m_outputPath = arg + strlen("-bench_out=");
+		else if (strstr(arg, "-bench_baseline=") == arg)
+			g_Benchmark.m_baselinePath = arg + strlen("-bench_baseline=");
+		else if (strstr(arg, "-bench_threshold=") == arg)
+			g_Benchmark.m_thresholdPercent = (float)atof(arg + strlen("-bench_threshold="));
+		else if (strstr(arg, "-bench_run=") == arg) {
+			g_Benchmark.m_runPath = arg + strlen("-bench_run=");
+			g_Profile = true; // per-pass timers
+		}
+	#if SUPPORT_TRACE
+		else if (strstr(arg, "-trace=") == arg)
+			g_TracePath = arg + strlen("-trace=");
+		else if (strstr(arg, "-trace_frames=") == arg)
+			g_TraceEndFrame = Max(1, atoi(arg + strlen("-trace_frames=")));
+	#endif // SUPPORT_TRACE
+		else if (stricmp(arg, "-core") == 0)
+			g_CoreProfile = true;
+		else if (stricmp(arg, "-no_program_cache") == 0)
+			g_ProgramBinaryCache = false;
+		else if (stricmp(arg, "-serial_compile") == 0)
+			g_SerialShaderCompile = true;
+		else if (stricmp(arg, "-no_texture_cache") == 0)
+			g_TextureBakeCache = false;
+		else if (stricmp(arg, "-bake") == 0) // rebuild the baked textures and exit, see BakeTextures
+			g_TextureBakeRebuild = true;
+		else if (stricmp(arg, "-headless") == 0)
+			g_Headless = true;
+		else if (strstr(arg, "-headless=") == arg) {
+			g_Headless = true;
+			g_Offline.m_endFrame = Max(1, atoi(arg + strlen("-headless=")));
+		} else if (strstr(arg, "-offline=") == arg) { // -offline=END or -offline=START:END
+			g_Offline.m_enabled = true;
+			uint32 start = 0, end = 0;
+			if (sscanf(arg + strlen("-offline="), "%u:%u", &start, &end) == 2) {
+				g_Offline.m_startFrame = start;
+				g_Offline.m_endFrame = Max(start + 1, end);
+			} else
+				g_Offline.m_endFrame = Max(1, atoi(arg + strlen("-offline=")));
+		} else if (strstr(arg, "-dt=") == arg)
+			g_FixedTimeDelta = (float)atof(arg + strlen("-dt="));
+		else if (stricmp(arg, "-capture") == 0)
+			g_Offline.m_capture = true;
+		else if (strstr(arg, "-capture=") == arg) { // -capture=name,name,..
+			g_Offline.m_capture = true;
+			const char* str = arg + strlen("-capture=");
+			while (*str) {
+				const char* comma = strchr(str, ',');
+				const std::string name = comma ? std::string(str, comma - str) : std::string(str);
+				if (!name.empty()) {
+					g_Offline.m_captureNames.push_back(name);
+					if (name != "final")
+						g_CapturedBuffers[name] = true;
+				}
+				str = comma ? comma + 1 : str + strlen(str);
+			}
+		} else if (stricmp(arg, "-capture_bench") == 0)
+			captureBenchFrames = 200;
+		else if (strstr(arg, "-capture_bench=") == arg)
+			captureBenchFrames = Max(1, atoi(arg + strlen("-capture_bench=")));
+		else if (strstr(arg, "-capture_every=") == arg)
+			g_Offline.m_captureEvery = Max(1, atoi(arg + strlen("-capture_every=")));
+		else if (strstr(arg, "-capture_dir=") == arg)
+			g_Offline.m_captureDir = arg + strlen("-capture_dir=");
+		else if (strstr(arg, "-capture_ext=") == arg)
+			g_Offline.m_captureExt = arg + strlen("-capture_ext=");
+		else if (strstr(arg, "-res=") == arg) {
+			uint32 w = 0, h = 0;
+			if (sscanf(arg + strlen("-res="), "%ux%u", &w, &h) == 2 && w > 0 && h > 0) {
+				g_ViewportWidth = w;
+				g_ViewportHeight = h;
+			} else
+				printf("warning: bad resolution \"%s\", expected -res=WIDTHxHEIGHT\n", arg);
+		}
+		else
+			printf("warning: unknown option \"%s\"\n", arg);
+	}
+
+	if ((g_Offline.m_enabled || !g_Benchmark.m_runPath.empty()) && g_FixedTimeDelta <= 0.0f)
+		g_FixedTimeDelta = 1.0f/60.0f; // offline output should be reproducible, and benchmarks should render the same frames
+	if ((g_Offline.m_capture || captureBenchFrames > 0) && g_Offline.m_captureNames.empty())
+		g_Offline.m_captureNames.push_back("final");
+
+	if (preprocessBenchIterations > 0) { // no window or GL context needed
+		if (shaderDirs.empty())
+			GetDirectoryEntries(nullptr, &shaderDirs, g_ShadersDir.c_str()); // each subdirectory is a shader
+		ShaderToyRenderPass::PreprocessBenchmark(shaderDirs, preprocessBenchIterations);
+		return 0;
+	}
+	if (mipBenchIterations > 0 || !mipBenchSources.empty()) {
+		MipBenchmark(mipBenchIterations > 0 ? mipBenchIterations : 5, mipBenchSources);
+		return 0;
+	}
+	if (benchmarkSuite) // each run is a separate process, this one needs no GL context
+		return RunBenchmarkSuite(argv[0], shaderDirs);
+
+	if (g_Headless) {
+	#if SUPPORT_HEADLESS
+	#if USE_GUI
+		g_GUIEnabled = false;
+	#endif // USE_GUI
+		if (!HeadlessContext::Create(argc, argv, g_ViewportWidth, g_ViewportHeight, g_CoreProfile))
+			return -1;
+	#else
+		fprintf(stderr, "-headless is not supported on this platform\n");
+		return -1;
+	#endif // SUPPORT_HEADLESS
+	} else {
+		glutInit(&argc, (char**)argv);
+		glutInitDisplayMode(GLUT_DOUBLE | GLUT_ALPHA);
+		if (g_CoreProfile) {
+			glutInitContextVersion(4, 4);
+			glutInitContextProfile(GLUT_CORE_PROFILE);
+		#if USE_GUI
+			g_GUIEnabled = false; // GUI renders through the compatibility profile
+		#endif // USE_GUI
+		}
+		glutInitWindowSize(g_ViewportWidth, g_ViewportHeight);
+		glutCreateWindow(argv[0]);
+		glutReshapeFunc(ReshapeFunc);
+		glutDisplayFunc(DisplayFunc);
+		glutMouseFunc(MouseFunc);
+		glutMotionFunc(MotionFunc);
+		glutPassiveMotionFunc(MotionFunc);
+		glutVisibilityFunc(VisibilityFunc);
+		glutCloseFunc(CloseFunc);
+	}
+
+	const GLubyte* versionStr = glGetString(GL_VERSION);
+	fprintf(stdout, "OpenGL version: %s\n", versionStr);
+#if FREEGLUT_INCLUDE_GLEW_2_1_0
+	glewExperimental = GL_TRUE; // otherwise glew skips entry points it looks up via glGetString(GL_EXTENSIONS), which is gone in core profile
+	const GLenum err = glewInit();
+	if (err == GLEW_OK) {
+		fprintf(stdout, "glewInit: Status OK - using GLEW_VERSION %s\n", glewGetString(GLEW_VERSION));
+		if (GLEW_VERSION_4_4) {
+			// ok
+		} else {
+			fprintf(stderr, "OpenGL version 4.4 required, but not present ..\n");
+			if (!g_Headless)
+				system("pause");
+			exit(-1);
+		}
+	} else {
+		if (err == GLEW_ERROR_NO_GLX_DISPLAY && g_Headless) // glew looks up entry points through GLX unless it was built for EGL
+			fprintf(stderr, "glewInit error: no GLX display - -headless needs a GLEW built with GLEW_EGL (or GLEW_OSMESA for HEADLESS_OSMESA)\n");
+		else
+			fprintf(stderr, "glewInit error: %s\n", glewGetErrorString(err));
+		if (!g_Headless)
+			system("pause");
+		exit(-1);
+	}
+#endif // FREEGLUT_INCLUDE_GLEW_2_1_0
+
+	if (glewIsSupported("GL_NV_gpu_shader5") &&
+		glewIsSupported("GL_NV_bindless_texture")) {
+		printf("GPU Shader 5 support enabled\n");
+		g_GPUShader5 = true;
+	} else {
+		printf("GPU Shader 5 support not enabled\n");
+		// ===================================================================================
+		// TODO -- this code is ineffective - the ReshapeFunc callback gets invoked as soon as
+		// glutMainLoop is entered, and the width and height get reset according to the
+		// call to glutInitWindowSize above. not sure how to fix this cleanly without hacking
+		// the ReshapeFunc callback, so that's what i did.
+		// ===================================================================================
+		//g_ViewportWidth /= 2;
+		//g_ViewportHeight /= 2;
+		//glutInitWindowSize(g_ViewportWidth, g_ViewportHeight);
+		//glutReshapeWindow(g_ViewportWidth, g_ViewportHeight);
+	}
+
+	if (g_Profile) {
+		g_PipelineStatistics = glewIsSupported("GL_ARB_pipeline_statistics_query") != 0;
+		printf("profiling enabled%s\n", g_PipelineStatistics ? " (with pipeline statistics)" : "");
+	}
+#if SUPPORT_TRACE
+	if (!g_TracePath.empty()) {
+		Trace::SetThreadName("main");
+		Trace::Start();
+		printf("tracing to %s\n", g_TracePath.c_str());
+	}
+#endif // SUPPORT_TRACE
+
+	// GLEW 2.1.0 predates the KHR version of this extension, but drivers that expose KHR also expose the ARB one
+	if (GLEW_ARB_parallel_shader_compile && glMaxShaderCompilerThreadsARB && !g_SerialShaderCompile) {
+		const uint32 numThreads = Max(1U, (uint32)std::thread::hardware_concurrency());
+		glMaxShaderCompilerThreadsARB(numThreads);
+		printf("parallel shader compile enabled (%u threads)\n", numThreads);
+		g_ParallelShaderCompile = true;
+	} else
+		printf("parallel shader compile not enabled\n");
+
+#if 1
+	// https://www.khronos.org/opengl/wiki/OpenGL_Error
+	class OpenGLDebugMessageCallback { public: static void GLAPIENTRY func(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message, const void* userParam) {
+		if (severity != GL_DEBUG_SEVERITY_NOTIFICATION &&
+			severity != GL_DEBUG_SEVERITY_LOW) {
+			const char* sourceStr = "?";
+			switch (source) {
+			case GL_DEBUG_SOURCE_API:             sourceStr = "API";             break;
+			case GL_DEBUG_SOURCE_WINDOW_SYSTEM:   sourceStr = "WINDOW_SYSTEM";   break;
+			case GL_DEBUG_SOURCE_SHADER_COMPILER: sourceStr = "SHADER_COMPILER"; break;
+			case GL_DEBUG_SOURCE_THIRD_PARTY:     sourceStr = "THIRD_PARTY";     break;
+			case GL_DEBUG_SOURCE_APPLICATION:     sourceStr = "APPLICATION";     break;
+			case GL_DEBUG_SOURCE_OTHER:           sourceStr = "OTHER";           break;
+			}
+			const char* typeStr = "?";
+			switch (type) {
+			case GL_DEBUG_TYPE_ERROR:               typeStr = "ERROR";               break; // An error, typically from the API
+			case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: typeStr = "DEPRECATED_BEHAVIOR"; break; // Some behavior marked deprecated has been used
+			case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:  typeStr = "UNDEFINED_BEHAVIOR";  break; // Something has invoked undefined behavior
+			case GL_DEBUG_TYPE_PORTABILITY:         typeStr = "PORTABILITY";         break; // Some functionality the user relies upon is not portable
+			case GL_DEBUG_TYPE_PERFORMANCE:         typeStr = "PERFORMANCE";         break; // Code has triggered possible performance issues
+			case GL_DEBUG_TYPE_MARKER:              typeStr = "MARKER";              break; // Command stream annotation
+			case GL_DEBUG_TYPE_PUSH_GROUP:          typeStr = "PUSH_GROUP";          break; // Group pushing
+			case GL_DEBUG_TYPE_POP_GROUP:           typeStr = "POP_GROUP";           break; // Group popping
+			case GL_DEBUG_TYPE_OTHER:               typeStr = "OTHER";               break; // Some type that isn't one of these
+			}
+			const char* severityStr = "?";
+			switch (severity) {
+			case GL_DEBUG_SEVERITY_HIGH:         severityStr = "HIGH";         break; // All OpenGL Errors, shader compilation/linking errors, or highly-dangerous undefined behavior
+			case GL_DEBUG_SEVERITY_MEDIUM:       severityStr = "MEDIUM";       break; // Major performance warnings, shader compilation/linking warnings, or the use of deprecated functionality
+			case GL_DEBUG_SEVERITY_LOW:          severityStr = "LOW";          break; // Redundant state change performance warning, or unimportant undefined behavior
+			case GL_DEBUG_SEVERITY_NOTIFICATION: severityStr = "NOTIFICATION"; break; // Anything that isn't an error or performance issue.
+			}
+			if (g_CurrentShaderBeingCompiled)
+				fprintf(stderr, "error compiling shader \"%s\"!\n", g_CurrentShaderBeingCompiled);
+			fprintf(stderr, "GL CALLBACK:%s (source=%s, type=%s, severity=%s): %s\n",
+				type == GL_DEBUG_TYPE_ERROR ? " ** GL ERROR **" : "",
+				sourceStr,
+				typeStr,
+				severityStr,
+				message);
+			if (severity == GL_DEBUG_SEVERITY_HIGH) {
+				static bool stop = true;
+				if (stop) {
+					stop = false;
+					__debugbreak();
+				}
+			}
+		}
+	}};
+	glEnable(GL_DEBUG_OUTPUT);
+	glDebugMessageCallback(OpenGLDebugMessageCallback::func, nullptr);
+#endif
+
+	if (g_TextureBakeRebuild)
+		return BakeTextures();
+	if (!g_Benchmark.m_runPath.empty())
+		return RunBenchmark();
+	if (captureBenchFrames > 0)
+		return CaptureBenchmark(captureBenchFrames);
+	if (g_Headless || g_Offline.m_enabled)
+		return RunOffline();
+	glutMainLoop();
+	return 0;
 }
\ No newline at end of file